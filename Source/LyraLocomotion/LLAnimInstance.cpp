@@ -6,53 +6,526 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Animation/AnimNodeReference.h"
-#include "AnimCharacterMovementLibrary.h"
-#include "AnimDistanceMatchingLibrary.h"
-#include "SequenceEvaluatorLibrary.h"
-#include "SequencePlayerLibrary.h"
-#include "AnimationStateMachineLibrary.h"
-#include "AnimExecutionContextLibrary.h"
+#include "Animation/AnimNode_SequencePlayer.h"
+#include "AnimNodes/AnimNode_SequenceEvaluator.h"
+#include "Animation/AnimExecutionContext.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 #include "KismetAnimationLibrary.h"
+#include "LLAnimInstanceProxy.h"
+#include "LLLocomotionSubsystem.h"
+#include "LLLocomotionProfiler.h"
+#include "LLLocomotionSettings.h"
+#include "TimerManager.h"
+#include "LLDistanceMatching.h"
+#include "LLLocomotionMath.h"
+
+namespace
+{
+	const FName TurnYawWeightCurveName(TEXT("TurnYawWeight"));
+	const FName RemainingTurnYawCurveName(TEXT("RemainingTurnYaw"));
+
+	// Sequences not set in the streamed anim set, or not loaded, keep what the instance has.
+	void ApplyStreamedSequence(const TSoftObjectPtr<UAnimSequence>& Streamed, TObjectPtr<UAnimSequence>& Sequence)
+	{
+		if (UAnimSequence* Loaded = Streamed.Get())
+		{
+			Sequence = Loaded;
+		}
+	}
+
+	void ApplyStreamedSequences(const FLLSoftCardinalDirections& Streamed, FCardinalDirections& Cardinals)
+	{
+		ApplyStreamedSequence(Streamed.Forward, Cardinals.Forward);
+		ApplyStreamedSequence(Streamed.Backward, Cardinals.Backward);
+		ApplyStreamedSequence(Streamed.Left, Cardinals.Left);
+		ApplyStreamedSequence(Streamed.Right, Cardinals.Right);
+		ApplyStreamedSequence(Streamed.ForwardRight, Cardinals.ForwardRight);
+		ApplyStreamedSequence(Streamed.BackwardRight, Cardinals.BackwardRight);
+		ApplyStreamedSequence(Streamed.BackwardLeft, Cardinals.BackwardLeft);
+		ApplyStreamedSequence(Streamed.ForwardLeft, Cardinals.ForwardLeft);
+	}
+}
+
+void ULLAnimInstance::NativeInitializeAnimation()
+{
+	Super::NativeInitializeAnimation();
+
+	AnimNodeCache.Reset();
+
+	if (const ACharacter* Owner = Cast<ACharacter>(GetOwningActor()))
+	{
+		LocomotionMovement = Cast<ULLCharacterMovementComponent>(Owner->GetCharacterMovement());
+	}
+
+	const ULLLocomotionSettings* Settings = GetDefault<ULLLocomotionSettings>();
+	bDormancyEnabled = Settings->bEnableDormancy;
+	DormancyDelay = Settings->DormancyDelay;
+	bSampleTurnYawFromSequence = Settings->bSampleTurnYawFromSequence;
+	PoseSharingTimeStep = Settings->PoseSharingTimeStep;
+	PoseSharingMaxRootYawOffset = Settings->PoseSharingMaxRootYawOffset;
+
+	// A gameplay only server never plays the locomotion sequences, it has no use for streaming them or their tables.
+	const UWorld* World = GetWorld();
+	if (Settings->bGameplayOnlyOnDedicatedServer && World && World->GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	RequestAnimSetGroup(ELLAnimSetGroup::Core);
+
+	BuildDistanceMatchingTables();
+}
+
+void ULLAnimInstance::BuildDistanceMatchingTables() const
+{
+	for (const FCardinalDirections* Cardinals : { &JogStartCardinals, &JogStopCardinals, &JogPivotCardinals })
+	{
+		for (const UAnimSequence* Sequence : Cardinals->GetAll())
+		{
+			FLLDistanceMatching::FindOrBuildTable(Sequence, LocomotionDistanceCurveName);
+		}
+	}
+
+	for (const UAnimSequence* Sequence : JogCardinals.GetAll())
+	{
+		FLLDistanceMatching::FindOrBuildRootMotionSpeed(Sequence);
+	}
+
+	FLLDistanceMatching::FindOrBuildTable(JumpFallLand, JumpDistanceCurveName);
+}
+
+void ULLAnimInstance::NativeBeginPlay()
+{
+	Super::NativeBeginPlay();
+
+	if (ULLLocomotionSubsystem* LocomotionSubsystem = UWorld::GetSubsystem<ULLLocomotionSubsystem>(GetWorld()))
+	{
+		LocomotionSubsystem->RegisterAnimInstance(this);
+	}
+}
+
+void ULLAnimInstance::NativeUninitializeAnimation()
+{
+	// A mesh on its way out keeps its tick off, one getting another anim instance gets it back
+	const USkeletalMeshComponent* SkelMeshComponent = GetSkelMeshComponent();
+	if (!SkelMeshComponent || SkelMeshComponent->IsBeingDestroyed() || !SkelMeshComponent->IsRegistered())
+	{
+		bDisabledMeshTick = false;
+	}
+	WakeUp();
+	CancelAnimSetStreaming();
+
+	if (ULLLocomotionSubsystem* LocomotionSubsystem = UWorld::GetSubsystem<ULLLocomotionSubsystem>(GetWorld()))
+	{
+		LocomotionSubsystem->UnregisterAnimInstance(this);
+	}
+
+	AnimNodeCache.Reset();
+
+	Super::NativeUninitializeAnimation();
+}
 
 void ULLAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 {
+	LL_SCOPED_PROFILER_TIMER(NativeUpdateAnimation);
+
+	const uint64 StartCycles = bMeasureUpdateCost ? FPlatformTime::Cycles64() : 0;
+
 	Super::NativeUpdateAnimation(DeltaSeconds);
 
-	if (const TObjectPtr<ACharacter> Owner = Cast<ACharacter>(GetOwningActor()))
-	{
-		CurrAcceleration = Owner->GetCharacterMovement()->GetCurrentAcceleration();
-		PrevWorldLocation = WorldLocation;
-		WorldLocation = Owner->GetActorLocation();
-		PrevWorldRotation = WorldRotation;
-		WorldRotation = Owner->GetActorRotation();
-		WorldVelocity = Owner->GetVelocity();
-		LastUpdateVelocity = Owner->GetCharacterMovement()->GetLastUpdateVelocity();
-		bUseSeparateBrakingFriction = Owner->GetCharacterMovement()->bUseSeparateBrakingFriction;
-		BrakingFrictionFactor = Owner->GetCharacterMovement()->BrakingFrictionFactor;
-		GroundFriction = Owner->GetCharacterMovement()->GroundFriction;
-		BrakingFriction = Owner->GetCharacterMovement()->BrakingFriction;
-		BrakingDecelerationWalking = Owner->GetCharacterMovement()->BrakingDecelerationWalking;
-		bIsOnGround = Owner->GetCharacterMovement()->IsMovingOnGround();
-		bIsJumping = Owner->GetCharacterMovement()->MovementMode == MOVE_Falling && WorldVelocity.Z > 0;
-		bIsFalling = Owner->GetCharacterMovement()->MovementMode == MOVE_Falling && WorldVelocity.Z <= 0;
-		TimeToJumpApex = bIsJumping ? -WorldVelocity.Z / Owner->GetCharacterMovement()->GetGravityZ() : 0;
-		TimeFalling = bIsFalling ? TimeFalling + DeltaSeconds : bIsJumping ? 0 : TimeFalling;
-		bIsAnyMontagePlaying = IsAnyMontagePlaying();
-		GroundDistance = GetGroundDistance(Owner);
+	// Only a root motion montage ticks the pose of a gameplay only mesh, its locomotion already ran in UpdateGameplayOnly.
+	if (bGameplayOnly)
+	{
+		return;
+	}
+
+	GatherLocomotionInputs(DeltaSeconds);
+
+	// Idle breaks and jumps are streamed in only once the character gets to use them.
+	if (StreamedAnimSet && HotState.bHasSnapshot)
+	{
+		if (bIsOnGround && !bHasVelocity)
+		{
+			RequestAnimSetGroup(ELLAnimSetGroup::IdleBreaks);
+		}
+		else if (!bIsOnGround)
+		{
+			RequestAnimSetGroup(ELLAnimSetGroup::Jump);
+		}
+	}
+
+	if (bMeasureUpdateCost)
+	{
+		MeasuredUpdateCycles += FPlatformTime::Cycles64() - StartCycles;
 	}
 }
 
 void ULLAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
 {
+	LL_SCOPED_PROFILER_TIMER(NativeThreadSafeUpdateAnimation);
+
+	const uint64 StartCycles = bMeasureUpdateCost ? FPlatformTime::Cycles64() : 0;
+
 	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
 
-	UpdateLocationData(DeltaSeconds);
-	UpdateRotationData();
-	UpdateVelocityData();
-	UpdateAccelerationData();
-	UpdateRootYawOffset(DeltaSeconds);
+	if (bGameplayOnly)
+	{
+		return;
+	}
+
+	NumPlayedLocomotionNodes = 0;
+	PlayedSharableSequence = nullptr;
+
+	UpdateLocomotionState(DeltaSeconds);
+
+	// A follower whose own state no longer matches the shared pose runs its graph again from this update on.
+	if (PoseSharingRole == ELLPoseSharingRole::Follower && SharedPose)
+	{
+		const FLLPoseSharingKey& Key = SharedPose->GetKey();
+		bPoseSharingDiverged = !CanSharePose(Key.Role, Key.Sequence.ResolveObjectPtr());
+	}
+
+	if (bDormancyEnabled)
+	{
+		FullyIdleTime = IsFullyIdle() ? FullyIdleTime + DeltaSeconds : 0;
+		bPendingDormancy = FullyIdleTime >= DormancyDelay;
+	}
+
+	if (bMeasureUpdateCost)
+	{
+		MeasuredUpdateCycles += FPlatformTime::Cycles64() - StartCycles;
+	}
+}
+
+void ULLAnimInstance::UpdateGameplayOnly(float DeltaSeconds)
+{
+	GatherLocomotionInputs(DeltaSeconds);
+	UpdateLocomotionState(DeltaSeconds);
+	UpdateGameplayState();
+}
+
+void ULLAnimInstance::GatherLocomotionInputs(float DeltaSeconds)
+{
+	const TObjectPtr<ACharacter> Owner = Cast<ACharacter>(GetOwningActor());
+	if (!Owner)
+	{
+		return;
+	}
+
+	// The worker update reads this copy, never the snapshot of ULLCharacterMovementComponent, which the movement may publish meanwhile.
+	HotState.Snapshot = LocomotionMovement ? LocomotionMovement->GetLocomotionSnapshot() : FLLLocomotionSnapshot::Capture(Owner);
+	HotState.bHasSnapshot = true;
+	GroundDistance = GetGroundDistance(Owner);
+
+	if (FLLLocomotionRecorder* Recorder = LocomotionSubsystem ? LocomotionSubsystem->GetInputRecorder() : nullptr)
+	{
+		Recorder->Record(this, HotState.Snapshot, GroundDistance, DeltaSeconds, GetTuning().GetKinematicsTuning());
+	}
+}
+
+void ULLAnimInstance::UpdateLocomotionState(float DeltaSeconds)
+{
+	HotState.UpdateDeltaSeconds = DeltaSeconds;
+
+	if (HotState.bHasSnapshot)
+	{
+		UpdateCharacterStateData(DeltaSeconds);
+	}
+
+	// Batched instances already got their kinematics from ULLLocomotionSubsystem before this update.
+	if (!IsKinematicsBatched())
+	{
+		UpdateLocationData(DeltaSeconds);
+		UpdateRotationData(DeltaSeconds);
+		UpdateVelocityData();
+		UpdateAccelerationData();
+		UpdateRootYawOffset(DeltaSeconds);
+	}
+
+	HotState.bIsFirstUpdate = false;
+}
+
+void ULLAnimInstance::NativePostEvaluateAnimation()
+{
+	Super::NativePostEvaluateAnimation();
+
+	// The worker update and evaluation are done, nothing writes the values gameplay reads until the next update.
+	UpdateGameplayState();
+
+	// The mesh tick can only be turned off on the game thread, after the pose to keep has been evaluated.
+	if (bPendingDormancy && !bIsDormant)
+	{
+		EnterDormancy();
+	}
+}
+
+FAnimInstanceProxy* ULLAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FLLAnimInstanceProxy(this);
+}
+
+bool ULLAnimInstance::IsFullyIdle() const
+{
+	// A pending idle break doesn't keep the instance awake, EnterDormancy sets a timer to wake up for it.
+	return HotState.bHasSnapshot && bIsOnGround && !bHasVelocity && !bHasAcceleration && !HotState.Snapshot.bIsAnyMontagePlaying &&
+		FMath::IsNearlyZero(HotState.YawDeltaSinceLastUpdate) && FMath::IsNearlyZero(RootYawOffset) &&
+		(!CanPlayIdleBreak() || TimeUntilNextIdleBreak > 0);
+}
+
+void ULLAnimInstance::EnterDormancy()
+{
+	USkeletalMeshComponent* SkelMeshComponent = GetSkelMeshComponent();
+	UWorld* World = GetWorld();
+	if (!SkelMeshComponent || !World)
+	{
+		return;
+	}
+
+	bPendingDormancy = false;
+	bIsDormant = true;
+	DormantSinceTime = World->GetTimeSeconds();
+
+	// Only the tick dormancy turned off is turned back on, whoever else turned it off keeps it off
+	bDisabledMeshTick = SkelMeshComponent->IsComponentTickEnabled();
+	if (bDisabledMeshTick)
+	{
+		SkelMeshComponent->SetComponentTickEnabled(false);
+	}
+
+	if (CanPlayIdleBreak())
+	{
+		World->GetTimerManager().SetTimer(IdleBreakWakeTimer, this, &ULLAnimInstance::WakeUp, FMath::Max(TimeUntilNextIdleBreak, UE_KINDA_SMALL_NUMBER));
+	}
+}
+
+void ULLAnimInstance::WakeUp()
+{
+	if (!bIsDormant)
+	{
+		return;
+	}
+
+	bIsDormant = false;
+	FullyIdleTime = 0;
+
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(IdleBreakWakeTimer);
+
+		// The idle break countdown goes on while asleep.
+		TimeUntilNextIdleBreak -= static_cast<float>(World->GetTimeSeconds() - DormantSinceTime);
+	}
+
+	// Whatever moved while asleep would arrive as a single step, start over from the current state instead.
+	HotState.bIsFirstUpdate = true;
+
+	USkeletalMeshComponent* SkelMeshComponent = GetSkelMeshComponent();
+	if (bDisabledMeshTick && SkelMeshComponent)
+	{
+		SkelMeshComponent->SetComponentTickEnabled(true);
+	}
+	bDisabledMeshTick = false;
+}
+
+bool ULLAnimInstance::GetPoseSharingKey(FLLPoseSharingKey& OutKey) const
+{
+	const USkeletalMeshComponent* SkelMeshComponent = GetSkelMeshComponent();
+	if (NumPlayedLocomotionNodes != 1 || !PlayedSharableSequence || bIsDormant || !SkelMeshComponent ||
+		!CanSharePose(PlayedSharableRole, PlayedSharableSequence))
+	{
+		return false;
+	}
+
+	OutKey.Mesh = SkelMeshComponent->GetSkeletalMeshAsset();
+	OutKey.LODLevel = SkelMeshComponent->GetPredictedLODLevel();
+	OutKey.Sequence = PlayedSharableSequence;
+	OutKey.Role = PlayedSharableRole;
+	OutKey.TimeBucket = FMath::FloorToInt(PlayedSharableTime / PoseSharingTimeStep);
+	return true;
+}
+
+bool ULLAnimInstance::CanSharePose(ELLSequencePlayerRole Role, const UAnimSequenceBase* Sequence) const
+{
+	if (!HotState.bHasSnapshot || HotState.Snapshot.bIsAnyMontagePlaying || !bIsOnGround ||
+		FMath::Abs(RootYawOffset) > PoseSharingMaxRootYawOffset)
+	{
+		return false;
+	}
+
+	switch (Role)
+	{
+	case ELLSequencePlayerRole::Idle:
+		return !bHasVelocity && !bHasAcceleration && Sequence == IdleAnimSequence &&
+			(!CanPlayIdleBreak() || TimeUntilNextIdleBreak > 0);
+	case ELLSequencePlayerRole::Cycle:
+		// Decelerating toward a stop or accelerating against the velocity heads into a stop or pivot.
+		return bHasVelocity && bHasAcceleration && (LocalVelocity2D | LocalAcceleration2D) >= 0 &&
+			Sequence == SelectDirectionalAnimation(JogCardinals, HotState.LocalVelocityDirectionNoOffset, HotState.LocalVelocityOctantNoOffset);
+	default:
+		return false;
+	}
+}
+
+bool ULLAnimInstance::IsInStepWithSharedPose() const
+{
+	FLLPoseSharingKey Key;
+	if (!SharedPose || !SharedPose->IsReadable() || !GetPoseSharingKey(Key) || !Key.IsSameState(SharedPose->GetKey()))
+	{
+		return false;
+	}
+
+	return LLLocomotionMath::LoopingTimeDistance(PlayedSharableTime, SharedPose->GetPublishedTime(), PlayedSharableSequence->GetPlayLength()) <= PoseSharingTimeStep;
+}
+
+void ULLAnimInstance::SetStreamedAnimSet(ULLLocomotionAnimSet* InAnimSet)
+{
+	if (StreamedAnimSet == InAnimSet)
+	{
+		return;
+	}
+
+	CancelAnimSetStreaming();
+	RestoreResidentAnimSet();
+
+	StreamedAnimSet = InAnimSet;
+	RequestAnimSetGroup(ELLAnimSetGroup::Core);
+}
+
+void ULLAnimInstance::RequestAnimSetGroup(ELLAnimSetGroup Group)
+{
+	const uint8 GroupBit = 1 << static_cast<uint8>(Group);
+	if (!StreamedAnimSet || (RequestedAnimSetGroups & GroupBit))
+	{
+		return;
+	}
+	RequestedAnimSetGroups |= GroupBit;
+
+	TArray<FSoftObjectPath> Paths;
+	StreamedAnimSet->GetSequencesToStream(Group, Paths);
+	if (Paths.IsEmpty())
+	{
+		OnAnimSetGroupStreamed(Group);
+		return;
+	}
+
+	// Streaming callbacks run on the game thread outside of the anim update, so they can swap sequences the worker reads.
+	const TAsyncLoadPriority Priority = Group == ELLAnimSetGroup::Core ? FStreamableManager::AsyncLoadHighPriority : FStreamableManager::DefaultAsyncLoadPriority;
+	AnimSetStreamingHandles[static_cast<int32>(Group)] = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		MoveTemp(Paths), FStreamableDelegate::CreateUObject(this, &ULLAnimInstance::OnAnimSetGroupStreamed, Group), Priority);
+}
+
+void ULLAnimInstance::OnAnimSetGroupStreamed(ELLAnimSetGroup Group)
+{
+	if (!StreamedAnimSet)
+	{
+		return;
+	}
+
+	switch (Group)
+	{
+	case ELLAnimSetGroup::Core:
+		ApplyStreamedSequence(StreamedAnimSet->IdleAnimSequence, IdleAnimSequence);
+		ApplyStreamedSequences(StreamedAnimSet->JogCardinals, JogCardinals);
+		break;
+	case ELLAnimSetGroup::Transitions:
+		ApplyStreamedSequences(StreamedAnimSet->JogStartCardinals, JogStartCardinals);
+		ApplyStreamedSequences(StreamedAnimSet->JogStopCardinals, JogStopCardinals);
+		ApplyStreamedSequences(StreamedAnimSet->JogPivotCardinals, JogPivotCardinals);
+		ApplyStreamedSequence(StreamedAnimSet->TurnInPlaceLeftAnimSequence, TurnInPlaceLeftAnimSequence);
+		ApplyStreamedSequence(StreamedAnimSet->TurnInPlaceRightAnimSequence, TurnInPlaceRightAnimSequence);
+		break;
+	case ELLAnimSetGroup::IdleBreaks:
+	{
+		TArray<TObjectPtr<UAnimSequence>> LoadedIdleBreaks;
+		for (const TSoftObjectPtr<UAnimSequence>& Streamed : StreamedAnimSet->IdleBreakAnimSequences)
+		{
+			if (UAnimSequence* Loaded = Streamed.Get())
+			{
+				LoadedIdleBreaks.Add(Loaded);
+			}
+		}
+		if (!LoadedIdleBreaks.IsEmpty())
+		{
+			IdleBreakAnimSequences = MoveTemp(LoadedIdleBreaks);
+		}
+		break;
+	}
+	case ELLAnimSetGroup::Jump:
+		ApplyStreamedSequence(StreamedAnimSet->JumpStart, JumpStart);
+		ApplyStreamedSequence(StreamedAnimSet->JumpStartLoop, JumpStartLoop);
+		ApplyStreamedSequence(StreamedAnimSet->JumpApex, JumpApex);
+		ApplyStreamedSequence(StreamedAnimSet->JumpFallLand, JumpFallLand);
+		ApplyStreamedSequence(StreamedAnimSet->JumpFallLoop, JumpFallLoop);
+		ApplyStreamedSequence(StreamedAnimSet->JumpRecoveryAdditive, JumpRecoveryAdditive);
+		break;
+	default:
+		break;
+	}
+
+	// Tables baked on cook go in first, so only sequences without baked data are built from their curves.
+	StreamedAnimSet->RegisterBakedData();
+	BuildDistanceMatchingTables();
+
+	// Starts and stops are the next most likely to play, they wait for the idle and cycles to arrive.
+	if (Group == ELLAnimSetGroup::Core)
+	{
+		RequestAnimSetGroup(ELLAnimSetGroup::Transitions);
+	}
+}
+
+void ULLAnimInstance::CancelAnimSetStreaming()
+{
+	for (TSharedPtr<FStreamableHandle>& Handle : AnimSetStreamingHandles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->CancelHandle();
+			Handle.Reset();
+		}
+	}
+	RequestedAnimSetGroups = 0;
+}
+
+void ULLAnimInstance::RestoreResidentAnimSet()
+{
+	const ULLAnimInstance* Defaults = GetClass()->GetDefaultObject<ULLAnimInstance>();
+	IdleAnimSequence = Defaults->IdleAnimSequence;
+	IdleBreakAnimSequences = Defaults->IdleBreakAnimSequences;
+	TurnInPlaceLeftAnimSequence = Defaults->TurnInPlaceLeftAnimSequence;
+	TurnInPlaceRightAnimSequence = Defaults->TurnInPlaceRightAnimSequence;
+	JogStartCardinals = Defaults->JogStartCardinals;
+	JogCardinals = Defaults->JogCardinals;
+	JogStopCardinals = Defaults->JogStopCardinals;
+	JogPivotCardinals = Defaults->JogPivotCardinals;
+	JumpStart = Defaults->JumpStart;
+	JumpStartLoop = Defaults->JumpStartLoop;
+	JumpApex = Defaults->JumpApex;
+	JumpFallLand = Defaults->JumpFallLand;
+	JumpFallLoop = Defaults->JumpFallLoop;
+	JumpRecoveryAdditive = Defaults->JumpRecoveryAdditive;
+}
+
+void ULLAnimInstance::SetLocomotionFidelity(ELLLocomotionFidelity InLocomotionFidelity)
+{
+	if (LocomotionFidelity == InLocomotionFidelity)
+	{
+		return;
+	}
 
-	bIsFirstUpdate = false;
+	// Stride warping alphas aren't updated on the cycle only tier, turn stride warping off instead of freezing it.
+	if (InLocomotionFidelity == ELLLocomotionFidelity::CycleOnly)
+	{
+		StrideWarpingStartAlpha = 0;
+		StrideWarpingCycleAlpha = 0;
+		StrideWarpingPivotAlpha = 0;
+	}
+	LocomotionFidelity = InLocomotionFidelity;
+}
+
+bool ULLAnimInstance::ShouldPlayTransitionStates() const
+{
+	return LocomotionFidelity != ELLLocomotionFidelity::CycleOnly;
 }
 
 bool ULLAnimInstance::ShouldDistanceMatchStop() const
@@ -60,31 +533,48 @@ bool ULLAnimInstance::ShouldDistanceMatchStop() const
 	return bHasVelocity && !bHasAcceleration;
 }
 
+void ULLAnimInstance::UpdateGameplayState()
+{
+	GameplayState.GroundDistance = GroundDistance;
+	GameplayState.TimeToJumpApex = TimeToJumpApex;
+	// Predicted here rather than through the memoized prediction, which belongs to the anim worker
+	GameplayState.PredictedStopDistance = LLLocomotionMath::PredictGroundMovementStopDistance(
+		HotState.Snapshot.LastUpdateVelocity.X,
+		HotState.Snapshot.LastUpdateVelocity.Y,
+		HotState.Snapshot.bUseSeparateBrakingFriction,
+		HotState.Snapshot.BrakingFriction,
+		HotState.Snapshot.GroundFriction,
+		HotState.Snapshot.BrakingFrictionFactor,
+		HotState.Snapshot.BrakingDecelerationWalking);
+	GameplayState.LocalVelocityDirection = LocalVelocityDirection;
+	GameplayState.bIsRunningIntoWall = bIsRunningIntoWall;
+}
+
 double ULLAnimInstance::GetPredictedStopDistance() const
 {
-	return UAnimCharacterMovementLibrary::PredictGroundMovementStopLocation(
-		LastUpdateVelocity,
-		bUseSeparateBrakingFriction,
-		BrakingFriction,
-		GroundFriction,
-		BrakingFrictionFactor,
-		BrakingDecelerationWalking).Size2D();
+	return GroundMovementPrediction.StopDistance(
+		HotState.Snapshot.LastUpdateVelocity.X,
+		HotState.Snapshot.LastUpdateVelocity.Y,
+		HotState.Snapshot.bUseSeparateBrakingFriction,
+		HotState.Snapshot.BrakingFriction,
+		HotState.Snapshot.GroundFriction,
+		HotState.Snapshot.BrakingFrictionFactor,
+		HotState.Snapshot.BrakingDecelerationWalking);
 }
 
 void ULLAnimInstance::UpdateIdleTurnYawState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	FAnimationStateResultReference AnimationState;
-	EAnimNodeReferenceConversionResult ConversionResult;
-	UAnimationStateMachineLibrary::ConvertToAnimationStateResult(Node, AnimationState, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	LL_SCOPED_STAT(UpdateIdleTurnYawState);
+
+	if (AnimNodeCache.IsStateBlendingOut(ELLAnimNodeSlot::UpdateIdleTurnYawState, Context, Node))
 	{
-		if (UAnimationStateMachineLibrary::IsStateBlendingOut(Context, AnimationState))
-		{
-			TurnYawCurveValue = 0;
-		}
-		else
+		HotState.TurnYawCurveValue = 0;
+	}
+	else
+	{
+		HotState.RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
+		if (LocomotionFidelity != ELLLocomotionFidelity::CycleOnly)
 		{
-			RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
 			ProcessTurnYawCurve();
 		}
 	}
@@ -92,335 +582,527 @@ void ULLAnimInstance::UpdateIdleTurnYawState(const FAnimUpdateContext& Context,
 
 void ULLAnimInstance::LandRecoveryStart(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	LandRecoveryAlpha = FMath::GetMappedRangeValueClamped(FVector2f(0, 0.4), FVector2f(0.1, 1.0), TimeFalling); 
+	LL_SCOPED_STAT(LandRecoveryStart);
+
+	LandRecoveryAlpha = FMath::GetMappedRangeValueClamped(FVector2f(0, 0.4), FVector2f(0.1, 1.0), HotState.TimeFalling); 
 }
 
 void ULLAnimInstance::SetupIdleState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	IdleBreakDelayTime = FMath::TruncToInt(FMath::Abs(WorldLocation.X + WorldLocation.Y)) % 10 + 6;
+	LL_SCOPED_STAT(SetupIdleState);
+
+	IdleBreakDelayTime = LLLocomotionMath::IdleBreakDelayTime(WorldLocation.X, WorldLocation.Y);
 	TimeUntilNextIdleBreak = IdleBreakDelayTime;
 }
 
 void ULLAnimInstance::UpdateIdleState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	FAnimationStateResultReference AnimationState;
-	EAnimNodeReferenceConversionResult ConversionResult;
-	UAnimationStateMachineLibrary::ConvertToAnimationStateResult(Node, AnimationState, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	LL_SCOPED_STAT(UpdateIdleState);
+
+	if (!AnimNodeCache.IsStateBlendingOut(ELLAnimNodeSlot::UpdateIdleState, Context, Node))
 	{
-		if (!UAnimationStateMachineLibrary::IsStateBlendingOut(Context, AnimationState))
+		if (CanPlayIdleBreak())
 		{
-			if (CanPlayIdleBreak())
-			{
-				TimeUntilNextIdleBreak -= UAnimExecutionContextLibrary::GetDeltaTime(Context);
-			}
-			else
-			{
-				TimeUntilNextIdleBreak = IdleBreakDelayTime;
-			}
+			TimeUntilNextIdleBreak -= HotState.UpdateDeltaSeconds;
+		}
+		else
+		{
+			TimeUntilNextIdleBreak = IdleBreakDelayTime;
 		}
 	}
 }
 
 void ULLAnimInstance::SetUpTurnInPlaceRotationState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
+	LL_SCOPED_STAT(SetUpTurnInPlaceRotationState);
+
 	TurnInPlaceRotationDirection = FMath::Sign(RootYawOffset) * -1.f;
 }
 
 void ULLAnimInstance::SetUpTurnInPlaceRecoveryState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
+	LL_SCOPED_STAT(SetUpTurnInPlaceRecoveryState);
+
 	TurnInPlaceRecoveryDirection = TurnInPlaceRotationDirection;
 }
 
 void ULLAnimInstance::SetUpStartState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
+	LL_SCOPED_STAT(SetUpStartState);
+
 	StartDirection = LocalVelocityDirection;
 }
 
 void ULLAnimInstance::UpdateStartState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	FAnimationStateResultReference AnimationState;
-	EAnimNodeReferenceConversionResult ConversionResult;
-	UAnimationStateMachineLibrary::ConvertToAnimationStateResult(Node, AnimationState, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	LL_SCOPED_STAT(UpdateStartState);
+
+	if (!AnimNodeCache.IsStateBlendingOut(ELLAnimNodeSlot::UpdateStartState, Context, Node))
 	{
-		if (!UAnimationStateMachineLibrary::IsStateBlendingOut(Context, AnimationState))
-		{
-			RootYawOffsetMode = ERootYawOffsetMode::Hold;
-		}
+		HotState.RootYawOffsetMode = ERootYawOffsetMode::Hold;
 	}
 }
 
 void ULLAnimInstance::UpdateStopState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	FAnimationStateResultReference AnimationState;
-	EAnimNodeReferenceConversionResult ConversionResult;
-	UAnimationStateMachineLibrary::ConvertToAnimationStateResult(Node, AnimationState, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	LL_SCOPED_STAT(UpdateStopState);
+
+	if (!AnimNodeCache.IsStateBlendingOut(ELLAnimNodeSlot::UpdateStopState, Context, Node))
 	{
-		if (!UAnimationStateMachineLibrary::IsStateBlendingOut(Context, AnimationState))
-		{
-			RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
-		}
+		HotState.RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
 	}
 }
 
 void ULLAnimInstance::SetUpPivotState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
+	LL_SCOPED_STAT(SetUpPivotState);
+
 	PivotInitialDirection = LocalVelocityDirection;
 }
 
 void ULLAnimInstance::UpdatePivotState(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
+	LL_SCOPED_STAT(UpdatePivotState);
+
 	if (LastPivotTime > 0)
 	{
-		LastPivotTime -= UAnimExecutionContextLibrary::GetDeltaTime(Context);
+		LastPivotTime -= HotState.UpdateDeltaSeconds;
 	}
 }
 
 void ULLAnimInstance::UpdateIdleAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequencePlayerReference SequencePlayer = USequencePlayerLibrary::ConvertToSequencePlayer(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequencePlayer* SequencePlayer = AnimNodeCache.GetSequencePlayer(ELLAnimNodeSlot::UpdateIdleAnim, Node);
+	if (AnimationUpdateContext && SequencePlayer)
 	{
-		USequencePlayerLibrary::SetSequenceWithInertialBlending(Context, SequencePlayer, IdleAnimSequence);
+		UpdateSequencePlayer(ELLSequencePlayerRole::Idle, *AnimationUpdateContext, *SequencePlayer);
 	}
 }
 
 void ULLAnimInstance::SetUpIdleBreakAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequencePlayerReference SequencePlayer = USequencePlayerLibrary::ConvertToSequencePlayer(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	if (FAnimNode_SequencePlayer* SequencePlayer = AnimNodeCache.GetSequencePlayer(ELLAnimNodeSlot::SetUpIdleBreakAnim, Node))
 	{
-		USequencePlayerLibrary::SetSequence(SequencePlayer, IdleBreakAnimSequences[CurrentIdleBreakIndex]);
-		CurrentIdleBreakIndex = (CurrentIdleBreakIndex + 1) % IdleBreakAnimSequences.Num();  
+		SetUpSequencePlayer(ELLSequencePlayerRole::IdleBreak, *SequencePlayer);
 	}
 }
 
 void ULLAnimInstance::SetUpStartAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	if (FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::SetUpStartAnim, Node))
 	{
-		USequenceEvaluatorLibrary::SetSequence(
-			SequenceEvaluator, SelectDirectionalAnimation(JogStartCardinals, LocalVelocityDirection));
-		USequenceEvaluatorLibrary::SetExplicitTime(SequenceEvaluator, 0);
-		StrideWarpingStartAlpha = 0;
-		
+		SetUpSequenceEvaluator(ELLSequenceEvaluatorRole::Start, *SequenceEvaluator);
 	}
 }
 
 void ULLAnimInstance::UpdateStartAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::UpdateStartAnim, Node);
+	if (AnimationUpdateContext && SequenceEvaluator)
 	{
-		const float ExplicitTime = USequenceEvaluatorLibrary::GetAccumulatedTime(SequenceEvaluator);
-		StrideWarpingStartAlpha = FMath::GetMappedRangeValueClamped(
-			FVector2D(0, StrideWarpingBlendInDurationScaled), FVector2D(0, 1), ExplicitTime - StrideWarpingBlendInStartOffset);
-
-		const FVector2D PlayRateClamp(
-			UKismetMathLibrary::Lerp(StrideWarpingBlendInDurationScaled, PlayRateClampStartsPivots.X, StrideWarpingStartAlpha),
-			PlayRateClampStartsPivots.Y);
-		UAnimDistanceMatchingLibrary::AdvanceTimeByDistanceMatching(Context, SequenceEvaluator, DisplacementSinceLastUpdate, LocomotionDistanceCurveName, PlayRateClamp);
+		UpdateSequenceEvaluator(ELLSequenceEvaluatorRole::Start, *AnimationUpdateContext, *SequenceEvaluator);
 	}
 }
 
 void ULLAnimInstance::UpdateCycleAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequencePlayerReference SequencePlayer = USequencePlayerLibrary::ConvertToSequencePlayer(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequencePlayer* SequencePlayer = AnimNodeCache.GetSequencePlayer(ELLAnimNodeSlot::UpdateCycleAnim, Node);
+	if (AnimationUpdateContext && SequencePlayer)
 	{
-		USequencePlayerLibrary::SetSequenceWithInertialBlending(
-			Context, SequencePlayer, SelectDirectionalAnimation(JogCardinals, LocalVelocityDirectionNoOffset));
-		
-		UAnimDistanceMatchingLibrary::SetPlayrateToMatchSpeed(SequencePlayer, DisplacementSpeed, PlayRateClampCycle);
-		
-		StrideWarpingCycleAlpha = FMath::FInterpTo(
-			StrideWarpingCycleAlpha, bIsRunningIntoWall ? 0.5f : 1.0f, UAnimExecutionContextLibrary::GetDeltaTime(Context), 10);
+		UpdateSequencePlayer(ELLSequencePlayerRole::Cycle, *AnimationUpdateContext, *SequencePlayer);
 	}
 }
 
 void ULLAnimInstance::SetUpStopAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	if (FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::SetUpStopAnim, Node))
 	{
-		USequenceEvaluatorLibrary::SetSequence(SequenceEvaluator, SelectDirectionalAnimation(JogStopCardinals, LocalVelocityDirection));
+		SetUpSequenceEvaluator(ELLSequenceEvaluatorRole::Stop, *SequenceEvaluator);
 	}
-	
-	if (!ShouldDistanceMatchStop())
+}
+
+void ULLAnimInstance::UpdateStopAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+{
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::UpdateStopAnim, Node);
+	if (AnimationUpdateContext && SequenceEvaluator)
 	{
-		UAnimDistanceMatchingLibrary::DistanceMatchToTarget(SequenceEvaluator, 0, LocomotionDistanceCurveName);
+		UpdateSequenceEvaluator(ELLSequenceEvaluatorRole::Stop, *AnimationUpdateContext, *SequenceEvaluator);
 	}
 }
 
-void ULLAnimInstance::UpdateStopAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::SetUpPivotAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	if (ShouldDistanceMatchStop())
+	if (FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::SetUpPivotAnim, Node))
 	{
-		const double DistanceToMatch = GetPredictedStopDistance();
-		if (DistanceToMatch > 0)
-		{
-			EAnimNodeReferenceConversionResult ConversionResult;
-			const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-			if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
-			{
-				UAnimDistanceMatchingLibrary::DistanceMatchToTarget(SequenceEvaluator, DistanceToMatch, LocomotionDistanceCurveName);
-			}
-			return;
-		}
+		SetUpSequenceEvaluator(ELLSequenceEvaluatorRole::Pivot, *SequenceEvaluator);
 	}
+}
 
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+void ULLAnimInstance::UpdatePivotAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+{
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::UpdatePivotAnim, Node);
+	if (AnimationUpdateContext && SequenceEvaluator)
 	{
-		USequenceEvaluatorLibrary::AdvanceTime(Context, SequenceEvaluator);
+		UpdateSequenceEvaluator(ELLSequenceEvaluatorRole::Pivot, *AnimationUpdateContext, *SequenceEvaluator);
 	}
 }
 
-void ULLAnimInstance::SetUpPivotAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::SetUpFallLandAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+{
+	if (FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::SetUpFallLandAnim, Node))
+	{
+		SetUpSequenceEvaluator(ELLSequenceEvaluatorRole::FallLand, *SequenceEvaluator);
+	}
+}
+
+void ULLAnimInstance::UpdateFallLandAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	PivotStartingAcceleration = LocalAcceleration2D;
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::UpdateFallLandAnim, Node);
+	if (AnimationUpdateContext && SequenceEvaluator)
+	{
+		UpdateSequenceEvaluator(ELLSequenceEvaluatorRole::FallLand, *AnimationUpdateContext, *SequenceEvaluator);
+	}
+}
 
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+void ULLAnimInstance::SetupTurnInPlaceAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+{
+	if (FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::SetupTurnInPlaceAnim, Node))
 	{
-		USequenceEvaluatorLibrary::SetSequence(SequenceEvaluator, SelectDirectionalAnimation(JogPivotCardinals, CardinalDirectionFromAcceleration));
-		USequenceEvaluatorLibrary::SetExplicitTime(SequenceEvaluator, 0);
-		StrideWarpingPivotAlpha = 0;
-		TimeAtPivotStop = 0;
-		LastPivotTime = 0.2;
+		SetUpSequenceEvaluator(ELLSequenceEvaluatorRole::TurnInPlace, *SequenceEvaluator);
 	}
 }
 
-void ULLAnimInstance::UpdatePivotAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::UpdateTurnInPlaceAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+{
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequenceEvaluator* SequenceEvaluator = AnimNodeCache.GetSequenceEvaluator(ELLAnimNodeSlot::UpdateTurnInPlaceAnim, Node);
+	if (AnimationUpdateContext && SequenceEvaluator)
+	{
+		UpdateSequenceEvaluator(ELLSequenceEvaluatorRole::TurnInPlace, *AnimationUpdateContext, *SequenceEvaluator);
+	}
+}
+
+void ULLAnimInstance::UpdateTurnInPlaceRecoveryAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+	FAnimNode_SequencePlayer* SequencePlayer = AnimNodeCache.GetSequencePlayer(ELLAnimNodeSlot::UpdateTurnInPlaceRecoveryAnim, Node);
+	if (AnimationUpdateContext && SequencePlayer)
 	{
-		const float ExplicitTime = USequenceEvaluatorLibrary::GetAccumulatedTime(SequenceEvaluator);
+		UpdateSequencePlayer(ELLSequencePlayerRole::TurnInPlaceRecovery, *AnimationUpdateContext, *SequencePlayer);
+	}
+}
 
-		if (LastPivotTime > 0)
+void ULLAnimInstance::SetUpSequencePlayer(ELLSequencePlayerRole Role, FAnimNode_SequencePlayer& SequencePlayer)
+{
+	switch (Role)
+	{
+	case ELLSequencePlayerRole::IdleBreak:
+		if (!IdleBreakAnimSequences.IsEmpty())
 		{
-			const TObjectPtr<UAnimSequence> NewDesiredSequence = SelectDirectionalAnimation(JogPivotCardinals, CardinalDirectionFromAcceleration);
-			if (NewDesiredSequence != USequenceEvaluatorLibrary::GetSequence(SequenceEvaluator))
-			{
-				USequenceEvaluatorLibrary::SetSequenceWithInertialBlending(Context, SequenceEvaluator, NewDesiredSequence);
-				PivotStartingAcceleration = LocalAcceleration2D;
-			}
+			LL_SCOPED_STAT(SetUpIdleBreakAnim);
+			CurrentIdleBreakIndex %= IdleBreakAnimSequences.Num();
+			ensure(SequencePlayer.SetSequence(IdleBreakAnimSequences[CurrentIdleBreakIndex]));
+			CurrentIdleBreakIndex = (CurrentIdleBreakIndex + 1) % IdleBreakAnimSequences.Num();
 		}
+		break;
+	default:
+		break;
+	}
+}
+
+void ULLAnimInstance::UpdateSequencePlayer(ELLSequencePlayerRole Role, const FAnimationUpdateContext& Context, FAnimNode_SequencePlayer& SequencePlayer)
+{
+	++NumPlayedLocomotionNodes;
 
-		if (FVector::DotProduct(LocalVelocity2D, LocalAcceleration2D) < 0)
+	switch (Role)
+	{
+	case ELLSequencePlayerRole::Idle:
 		{
-			const float DistanceToTarget = UAnimCharacterMovementLibrary::PredictGroundMovementPivotLocation(
-				CurrAcceleration, LastUpdateVelocity, GroundFriction).Size2D();
-			UAnimDistanceMatchingLibrary::DistanceMatchToTarget(SequenceEvaluator, DistanceToTarget, LocomotionDistanceCurveName);
-			TimeAtPivotStop = ExplicitTime;
+			LL_SCOPED_STAT(UpdateIdleAnim);
+			LL_INC_COUNTER(IdleInstances);
+			FLLAnimNodeCache::SetSequenceWithInertialBlending(Context, SequencePlayer, IdleAnimSequence);
+			PlayedSharableRole = Role;
+			PlayedSharableSequence = SequencePlayer.GetSequence();
+			PlayedSharableTime = SequencePlayer.GetAccumulatedTime();
 		}
-		else
+		break;
+	case ELLSequencePlayerRole::Cycle:
 		{
-			StrideWarpingPivotAlpha = FMath::GetMappedRangeValueClamped(
-				FVector2f(0, StrideWarpingBlendInDurationScaled), FVector2f(0, 1),
-				ExplicitTime - TimeAtPivotStop - StrideWarpingBlendInStartOffset);
-			const FVector2D PlayRateClamp(FMath::Lerp(0.2, PlayRateClampStartsPivots.X, StrideWarpingPivotAlpha), PlayRateClampStartsPivots.Y);
+			LL_SCOPED_STAT(UpdateCycleAnim);
+			LL_INC_COUNTER(CycleInstances);
+			FLLAnimNodeCache::SetSequenceWithInertialBlending(
+				Context, SequencePlayer, SelectDirectionalAnimation(JogCardinals, HotState.LocalVelocityDirectionNoOffset, HotState.LocalVelocityOctantNoOffset));
+
+			FLLDistanceMatching::SetPlayrateToMatchSpeed(SequencePlayer, DisplacementSpeed, GetTuning().PlayRateClampCycle);
 
-			UAnimDistanceMatchingLibrary::AdvanceTimeByDistanceMatching(
-				Context, SequenceEvaluator, DisplacementSinceLastUpdate, LocomotionDistanceCurveName, PlayRateClamp);
+			if (LocomotionFidelity != ELLLocomotionFidelity::CycleOnly)
+			{
+				StrideWarpingCycleAlpha = FMath::FInterpTo(
+					StrideWarpingCycleAlpha, bIsRunningIntoWall ? 0.5f : 1.0f, HotState.UpdateDeltaSeconds, 10);
+			}
+			PlayedSharableRole = Role;
+			PlayedSharableSequence = SequencePlayer.GetSequence();
+			PlayedSharableTime = SequencePlayer.GetAccumulatedTime();
+		}
+		break;
+	case ELLSequencePlayerRole::TurnInPlaceRecovery:
+		{
+			LL_SCOPED_STAT(UpdateTurnInPlaceRecoveryAnim);
+			LL_INC_COUNTER(TurnInPlaceInstances);
+			FLLAnimNodeCache::SetSequenceWithInertialBlending(
+				Context, SequencePlayer, SelectTurnInPlaceAnimation(TurnInPlaceRecoveryDirection));
 		}
+		break;
+	default:
+		break;
 	}
 }
 
-void ULLAnimInstance::SetUpFallLandAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::SetUpSequenceEvaluator(ELLSequenceEvaluatorRole Role, FAnimNode_SequenceEvaluator& SequenceEvaluator)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	switch (Role)
 	{
-		USequenceEvaluatorLibrary::SetExplicitTime(SequenceEvaluator, 0);
+	case ELLSequenceEvaluatorRole::Start:
+		{
+			LL_SCOPED_STAT(SetUpStartAnim);
+			ensure(SequenceEvaluator.SetSequence(SelectDirectionalAnimation(JogStartCardinals, LocalVelocityDirection, HotState.LocalVelocityOctant)));
+			ensure(SequenceEvaluator.SetExplicitTime(0));
+			StrideWarpingStartAlpha = 0;
+		}
+		break;
+	case ELLSequenceEvaluatorRole::Stop:
+		{
+			LL_SCOPED_STAT(SetUpStopAnim);
+			ensure(SequenceEvaluator.SetSequence(SelectDirectionalAnimation(JogStopCardinals, LocalVelocityDirection, HotState.LocalVelocityOctant)));
+			if (!ShouldDistanceMatchStop() && LocomotionFidelity != ELLLocomotionFidelity::CycleOnly)
+			{
+				FLLDistanceMatching::DistanceMatchToTarget(SequenceEvaluator, 0, LocomotionDistanceCurveName);
+			}
+		}
+		break;
+	case ELLSequenceEvaluatorRole::Pivot:
+		{
+			LL_SCOPED_STAT(SetUpPivotAnim);
+			PivotStartingAcceleration = LocalAcceleration2D;
+			ensure(SequenceEvaluator.SetSequence(SelectDirectionalAnimation(JogPivotCardinals, HotState.CardinalDirectionFromAcceleration, HotState.OctantFromAcceleration)));
+			ensure(SequenceEvaluator.SetExplicitTime(0));
+			StrideWarpingPivotAlpha = 0;
+			TimeAtPivotStop = 0;
+			LastPivotTime = 0.2;
+		}
+		break;
+	case ELLSequenceEvaluatorRole::FallLand:
+		{
+			LL_SCOPED_STAT(SetUpFallLandAnim);
+			ensure(SequenceEvaluator.SetExplicitTime(0));
+		}
+		break;
+	case ELLSequenceEvaluatorRole::TurnInPlace:
+		{
+			LL_SCOPED_STAT(SetupTurnInPlaceAnim);
+			TurnInPlaceAnimTime = 0;
+			ensure(SequenceEvaluator.SetExplicitTime(0));
+		}
+		break;
+	default:
+		break;
 	}
 }
 
-void ULLAnimInstance::UpdateFallLandAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::UpdateSequenceEvaluator(ELLSequenceEvaluatorRole Role, const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	++NumPlayedLocomotionNodes;
+
+	switch (Role)
 	{
-		UAnimDistanceMatchingLibrary::DistanceMatchToTarget(SequenceEvaluator, GroundDistance, JumpDistanceCurveName);
+	case ELLSequenceEvaluatorRole::Start:
+		UpdateStartSequence(Context, SequenceEvaluator);
+		break;
+	case ELLSequenceEvaluatorRole::Stop:
+		UpdateStopSequence(Context, SequenceEvaluator);
+		break;
+	case ELLSequenceEvaluatorRole::Pivot:
+		UpdatePivotSequence(Context, SequenceEvaluator);
+		break;
+	case ELLSequenceEvaluatorRole::FallLand:
+		{
+			LL_SCOPED_STAT(UpdateFallLandAnim);
+			LL_INC_COUNTER(FallLandInstances);
+			if (LocomotionFidelity == ELLLocomotionFidelity::CycleOnly)
+			{
+				FLLAnimNodeCache::AdvanceTime(Context, SequenceEvaluator);
+			}
+			else
+			{
+				FLLDistanceMatching::DistanceMatchToTarget(SequenceEvaluator, GroundDistance, JumpDistanceCurveName);
+			}
+		}
+		break;
+	case ELLSequenceEvaluatorRole::TurnInPlace:
+		{
+			LL_SCOPED_STAT(UpdateTurnInPlaceAnim);
+			LL_INC_COUNTER(TurnInPlaceInstances);
+			const TObjectPtr<UAnimSequence> Sequence = SelectTurnInPlaceAnimation(TurnInPlaceRotationDirection);
+			FLLAnimNodeCache::SetSequenceWithInertialBlending(Context, SequenceEvaluator, Sequence);
+
+			TurnInPlaceAnimTime += HotState.UpdateDeltaSeconds;
+			ensure(SequenceEvaluator.SetExplicitTime(TurnInPlaceAnimTime));
+			PlayedTurnInPlaceSequence = Sequence;
+		}
+		break;
+	default:
+		break;
 	}
 }
 
-void ULLAnimInstance::SetupTurnInPlaceAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::UpdateStartSequence(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator)
 {
-	TurnInPlaceAnimTime = 0;
-	
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	LL_SCOPED_STAT(UpdateStartAnim);
+	LL_INC_COUNTER(StartInstances);
+
+	// A start still playing when the character dropped to the cycle only tier just plays out
+	if (LocomotionFidelity == ELLLocomotionFidelity::CycleOnly)
 	{
-		USequenceEvaluatorLibrary::SetExplicitTime(SequenceEvaluator, 0);
+		FLLAnimNodeCache::AdvanceTime(Context, SequenceEvaluator);
+		return;
 	}
+
+	const ULLLocomotionTuning& LocomotionTuning = GetTuning();
+	const float ExplicitTime = SequenceEvaluator.GetAccumulatedTime();
+	StrideWarpingStartAlpha = FMath::GetMappedRangeValueClamped(
+		FVector2D(0, LocomotionTuning.StrideWarpingBlendInDurationScaled), FVector2D(0, 1), ExplicitTime - LocomotionTuning.StrideWarpingBlendInStartOffset);
+
+	const FVector2D PlayRateClamp(
+		UKismetMathLibrary::Lerp(LocomotionTuning.StrideWarpingBlendInDurationScaled, LocomotionTuning.PlayRateClampStartsPivots.X, StrideWarpingStartAlpha),
+		LocomotionTuning.PlayRateClampStartsPivots.Y);
+	FLLDistanceMatching::AdvanceTimeByDistanceMatching(Context, SequenceEvaluator, HotState.DisplacementSinceLastUpdate, LocomotionDistanceCurveName, PlayRateClamp);
 }
 
-void ULLAnimInstance::UpdateTurnInPlaceAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::UpdateStopSequence(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequenceEvaluatorReference SequenceEvaluator = USequenceEvaluatorLibrary::ConvertToSequenceEvaluator(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	LL_SCOPED_STAT(UpdateStopAnim);
+	LL_INC_COUNTER(StopInstances);
+
+	if (LocomotionFidelity == ELLLocomotionFidelity::CycleOnly)
+	{
+		FLLAnimNodeCache::AdvanceTime(Context, SequenceEvaluator);
+		return;
+	}
+
+	if (ShouldDistanceMatchStop())
 	{
-		USequenceEvaluatorLibrary::SetSequenceWithInertialBlending(
-			Context, SequenceEvaluator, SelectTurnInPlaceAnimation(TurnInPlaceRotationDirection));
-		
-		TurnInPlaceAnimTime += UAnimExecutionContextLibrary::GetDeltaTime(Context);
-		USequenceEvaluatorLibrary::SetExplicitTime(SequenceEvaluator, TurnInPlaceAnimTime);
+		const double DistanceToMatch = GetPredictedStopDistance();
+		if (DistanceToMatch > 0)
+		{
+			FLLDistanceMatching::DistanceMatchToTarget(SequenceEvaluator, DistanceToMatch, LocomotionDistanceCurveName);
+			return;
+		}
 	}
+
+	FLLAnimNodeCache::AdvanceTime(Context, SequenceEvaluator);
 }
 
-void ULLAnimInstance::UpdateTurnInPlaceRecoveryAnim(const FAnimUpdateContext& Context, const FAnimNodeReference& Node)
+void ULLAnimInstance::UpdatePivotSequence(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator)
 {
-	EAnimNodeReferenceConversionResult ConversionResult;
-	const FSequencePlayerReference SequencePlayer = USequencePlayerLibrary::ConvertToSequencePlayer(Node, ConversionResult);
-	if (ConversionResult == EAnimNodeReferenceConversionResult::Succeeded)
+	LL_SCOPED_STAT(UpdatePivotAnim);
+	LL_INC_COUNTER(PivotInstances);
+
+	if (LocomotionFidelity == ELLLocomotionFidelity::CycleOnly)
+	{
+		FLLAnimNodeCache::AdvanceTime(Context, SequenceEvaluator);
+		return;
+	}
+
+	const float ExplicitTime = SequenceEvaluator.GetAccumulatedTime();
+
+	if (LastPivotTime > 0)
 	{
-		USequencePlayerLibrary::SetSequenceWithInertialBlending(
-			Context, SequencePlayer, SelectTurnInPlaceAnimation(TurnInPlaceRecoveryDirection));
+		const TObjectPtr<UAnimSequence> NewDesiredSequence = SelectDirectionalAnimation(
+			JogPivotCardinals, HotState.CardinalDirectionFromAcceleration, HotState.OctantFromAcceleration);
+		if (NewDesiredSequence != SequenceEvaluator.GetSequence())
+		{
+			FLLAnimNodeCache::SetSequenceWithInertialBlending(Context, SequenceEvaluator, NewDesiredSequence);
+			PivotStartingAcceleration = LocalAcceleration2D;
+		}
+	}
+
+	if (FVector::DotProduct(LocalVelocity2D, LocalAcceleration2D) < 0)
+	{
+		// Without the pivot prediction the approach to the pivot plays at its authored speed
+		if (LocomotionFidelity != ELLLocomotionFidelity::Full)
+		{
+			FLLAnimNodeCache::AdvanceTime(Context, SequenceEvaluator);
+			TimeAtPivotStop = ExplicitTime;
+			return;
+		}
+
+		const float DistanceToTarget = GroundMovementPrediction.PivotDistance(
+			HotState.Snapshot.Acceleration.X, HotState.Snapshot.Acceleration.Y, HotState.Snapshot.LastUpdateVelocity.X, HotState.Snapshot.LastUpdateVelocity.Y, HotState.Snapshot.GroundFriction);
+		FLLDistanceMatching::DistanceMatchToTarget(SequenceEvaluator, DistanceToTarget, LocomotionDistanceCurveName);
+		TimeAtPivotStop = ExplicitTime;
+	}
+	else
+	{
+		const ULLLocomotionTuning& LocomotionTuning = GetTuning();
+		StrideWarpingPivotAlpha = FMath::GetMappedRangeValueClamped(
+			FVector2f(0, LocomotionTuning.StrideWarpingBlendInDurationScaled), FVector2f(0, 1),
+			ExplicitTime - TimeAtPivotStop - LocomotionTuning.StrideWarpingBlendInStartOffset);
+		const FVector2D PlayRateClamp(FMath::Lerp(0.2, LocomotionTuning.PlayRateClampStartsPivots.X, StrideWarpingPivotAlpha), LocomotionTuning.PlayRateClampStartsPivots.Y);
+
+		FLLDistanceMatching::AdvanceTimeByDistanceMatching(
+			Context, SequenceEvaluator, HotState.DisplacementSinceLastUpdate, LocomotionDistanceCurveName, PlayRateClamp);
 	}
 }
 
 void ULLAnimInstance::ProcessTurnYawCurve()
 {
-	const float PreviousTurnYawCurveValue = TurnYawCurveValue;
-	const float TurnYawWeight = GetCurveValue(TEXT("TurnYawWeight"));
+	const float PreviousTurnYawCurveValue = HotState.TurnYawCurveValue;
+	float TurnYawWeight = 0;
+	float RemainingTurnYaw = 0;
+	SampleTurnYawCurves(TurnYawWeight, RemainingTurnYaw);
 	if (FMath::IsNearlyZero(TurnYawWeight))
 	{
-		TurnYawCurveValue = 0;
+		HotState.TurnYawCurveValue = 0;
 	}
 	else
 	{
-		TurnYawCurveValue = GetCurveValue(TEXT("RemainingTurnYaw")) / TurnYawWeight;
+		HotState.TurnYawCurveValue = RemainingTurnYaw / TurnYawWeight;
 		if (PreviousTurnYawCurveValue != 0)
 		{
-			SetRootYawOffset(RootYawOffset - (TurnYawCurveValue - PreviousTurnYawCurveValue));
+			SetRootYawOffset(RootYawOffset - (HotState.TurnYawCurveValue - PreviousTurnYawCurveValue));
 		}
 	}
 }
 
+void ULLAnimInstance::SampleTurnYawCurves(float& OutTurnYawWeight, float& OutRemainingTurnYaw)
+{
+	if (!bSampleTurnYawFromSequence)
+	{
+		OutTurnYawWeight = GetCurveValue(TurnYawWeightCurveName);
+		OutRemainingTurnYaw = GetCurveValue(RemainingTurnYawCurveName);
+		return;
+	}
+
+	// Only the rotation state plays the turn in place sequence at TurnInPlaceAnimTime. Without an update of it since the last call,
+	// the character isn't turning, which the pose would also have shown with a zero weight.
+	if (const UAnimSequence* Sequence = PlayedTurnInPlaceSequence)
+	{
+		OutTurnYawWeight = Sequence->EvaluateCurveData(TurnYawWeightCurveName, TurnInPlaceAnimTime);
+		OutRemainingTurnYaw = Sequence->EvaluateCurveData(RemainingTurnYawCurveName, TurnInPlaceAnimTime);
+	}
+	PlayedTurnInPlaceSequence = nullptr;
+}
+
 void ULLAnimInstance::SetRootYawOffset(float InRootYawOffset)
 {
-	const float NormalizedRootYawOffset = FRotator::NormalizeAxis(InRootYawOffset);
-	RootYawOffset = RootYawOffsetAngleClamp.X == RootYawOffsetAngleClamp.Y ?
-		NormalizedRootYawOffset :
-		FMath::ClampAngle(NormalizedRootYawOffset, RootYawOffsetAngleClamp.X, RootYawOffsetAngleClamp.Y);
+	const FVector2D& AngleClamp = GetTuning().RootYawOffsetAngleClamp;
+	RootYawOffset = LLLocomotionMath::ClampRootYawOffset(InRootYawOffset, AngleClamp.X, AngleClamp.Y);
 }
 
 TObjectPtr<UAnimSequence> ULLAnimInstance::SelectTurnInPlaceAnimation(float Direction) const
@@ -430,7 +1112,7 @@ TObjectPtr<UAnimSequence> ULLAnimInstance::SelectTurnInPlaceAnimation(float Dire
 
 float ULLAnimInstance::GetGroundDistance(TObjectPtr<ACharacter> Owner)
 {
-	static constexpr float GroundTraceDistance = 100000.0f;
+	LL_SCOPED_PROFILER_TIMER(GetGroundDistance);
 
 	const TObjectPtr<UCharacterMovementComponent> MoveComponent = Owner->GetCharacterMovement();
 	
@@ -439,59 +1121,88 @@ float ULLAnimInstance::GetGroundDistance(TObjectPtr<ACharacter> Owner)
 		return LastGroundDistance;
 	}
 
+	const double ActorZ = Owner->GetActorLocation().Z;
+
 	if (MoveComponent->MovementMode == MOVE_Walking)
 	{
 		LastGroundDistance = 0.0f;
 	}
+	else if (LocomotionFidelity != ELLLocomotionFidelity::Full)
+	{
+		// No trace below full fidelity, assume flat ground below the character since the last measurement
+		LastGroundDistance = FMath::Max(LastGroundDistance + static_cast<float>(ActorZ - LastGroundDistanceZ), 0.0f);
+	}
+	else if (LocomotionSubsystem && LocomotionSubsystem->GetAsyncGroundDistance(LocomotionSlot, ActorZ, LastGroundDistance))
+	{
+		// Extrapolated from the batched async trace
+	}
 	else
 	{
-		const UCapsuleComponent* CapsuleComp = Owner->GetCapsuleComponent();
-		check(CapsuleComp);
+		// With async traces on, only a character without any ground distance yet traces here
+		ensureMsgf(!LocomotionSubsystem || !LocomotionSubsystem->HasAsyncGroundDistance(LocomotionSlot),
+			TEXT("%s traced the ground synchronously while async ground traces are on"), *GetNameSafe(Owner));
 
-		const float CapsuleHalfHeight = CapsuleComp->GetUnscaledCapsuleHalfHeight();
-		const ECollisionChannel CollisionChannel = (MoveComponent->UpdatedComponent ? MoveComponent->UpdatedComponent->GetCollisionObjectType() : ECC_Pawn);
-		const FVector TraceStart(Owner->GetActorLocation());
-		const FVector TraceEnd(TraceStart.X, TraceStart.Y, (TraceStart.Z - GroundTraceDistance - CapsuleHalfHeight));
-
-		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LyraCharacterMovementComponent_GetGroundInfo), false, Owner);
-		FCollisionResponseParams ResponseParam;
-		MoveComponent->InitCollisionParams(QueryParams, ResponseParam);
+		const FLLGroundTrace Trace(Owner);
 
+		LL_INC_COUNTER(GroundTraces);
+		LL_INC_COUNTER(SyncGroundTraces);
 		FHitResult HitResult;
-		GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, CollisionChannel, QueryParams, ResponseParam);
-
-		LastGroundDistance = GroundTraceDistance;
+		GetWorld()->LineTraceSingleByChannel(HitResult, Trace.Start, Trace.End, Trace.CollisionChannel, Trace.QueryParams, Trace.ResponseParams);
 
 		if (MoveComponent->MovementMode == MOVE_NavWalking)
 		{
 			LastGroundDistance = 0.0f;
 		}
-		else if (HitResult.bBlockingHit)
+		else
 		{
-			LastGroundDistance = FMath::Max((HitResult.Distance - CapsuleHalfHeight), 0.0f);
+			LastGroundDistance = FLLGroundTrace::GetGroundDistance(HitResult, Trace.CapsuleHalfHeight);
+		}
+
+		if (LocomotionSubsystem)
+		{
+			LocomotionSubsystem->SetGroundDistance(LocomotionSlot, Trace.Start.Z, LastGroundDistance);
 		}
 	}
 
+	LastGroundDistanceZ = ActorZ;
 	LastUpdateFrame = GFrameCounter;
 
 	return LastGroundDistance;
 }
 
+void ULLAnimInstance::UpdateCharacterStateData(float DeltaTime)
+{
+	if (!IsKinematicsBatched())
+	{
+		HotState.PrevWorldLocation = WorldLocation;
+		WorldLocation = HotState.Snapshot.Location;
+		HotState.PrevWorldRotation = WorldRotation;
+		WorldRotation = HotState.Snapshot.Rotation;
+		WorldVelocity = HotState.Snapshot.Velocity;
+	}
+
+	bIsOnGround = HotState.Snapshot.bIsMovingOnGround;
+	bIsJumping = HotState.Snapshot.MovementMode == MOVE_Falling && WorldVelocity.Z > 0;
+	bIsFalling = HotState.Snapshot.MovementMode == MOVE_Falling && WorldVelocity.Z <= 0;
+	TimeToJumpApex = bIsJumping ? -WorldVelocity.Z / HotState.Snapshot.GravityZ : 0;
+	HotState.TimeFalling = bIsFalling ? HotState.TimeFalling + DeltaTime : bIsJumping ? 0 : HotState.TimeFalling;
+}
+
 void ULLAnimInstance::UpdateLocationData(float DeltaTime)
 {
-	DisplacementSinceLastUpdate = (PrevWorldLocation - WorldLocation).Size2D();
-	DisplacementSpeed = UKismetMathLibrary::SafeDivide(DisplacementSinceLastUpdate, DeltaTime);
+	HotState.DisplacementSinceLastUpdate = LLLocomotionMath::Displacement2D(HotState.PrevWorldLocation.X, HotState.PrevWorldLocation.Y, WorldLocation.X, WorldLocation.Y);
+	DisplacementSpeed = LLLocomotionMath::SafeDivide(HotState.DisplacementSinceLastUpdate, DeltaTime);
 
-	if (bIsFirstUpdate)
+	if (HotState.bIsFirstUpdate)
 	{
-		DisplacementSinceLastUpdate = 0;
+		HotState.DisplacementSinceLastUpdate = 0;
 		DisplacementSpeed = 0;
 	}
 }
 
 bool ULLAnimInstance::CanPlayIdleBreak() const
 {
-	return !IdleBreakAnimSequences.IsEmpty() && !(bIsAnyMontagePlaying || bHasVelocity);
+	return !IdleBreakAnimSequences.IsEmpty() && !(HotState.Snapshot.bIsAnyMontagePlaying || bHasVelocity);
 }
 
 bool ULLAnimInstance::IsMovingPerpendicularToInitialPivot() const
@@ -505,33 +1216,36 @@ bool ULLAnimInstance::IsMovingPerpendicularToInitialPivot() const
 
 void ULLAnimInstance::UpdateAccelerationData()
 {
-	const FVector WorldAcceleration2D(CurrAcceleration.X, CurrAcceleration.Y, 0);
+	const FVector WorldAcceleration2D(HotState.Snapshot.Acceleration.X, HotState.Snapshot.Acceleration.Y, 0);
 	LocalAcceleration2D = WorldRotation.UnrotateVector(WorldAcceleration2D);
 	bHasAcceleration = !FMath::IsNearlyZero(LocalAcceleration2D.SizeSquared2D());
 
-	PivotDirection2D = FMath::Lerp(PivotDirection2D, WorldAcceleration2D.GetSafeNormal(), 0.5f).GetSafeNormal();
+	HotState.PivotDirection2D = FMath::Lerp(HotState.PivotDirection2D, WorldAcceleration2D.GetSafeNormal(), 0.5f).GetSafeNormal();
+
+	const float Angle = UKismetAnimationLibrary::CalculateDirection(HotState.PivotDirection2D, WorldRotation);
+	const float DeadZone = GetTuning().CardinalDirectionDeadZone;
+	const ECardinalDirection CurrentDirection = SelectCardinalDirectionFromAngle(Angle, DeadZone, ECardinalDirection::Forward, false);
+	HotState.CardinalDirectionFromAcceleration = GetOppositeCardinalDirection(CurrentDirection);
+	HotState.OctantFromAcceleration = LLLocomotionMath::GetOppositeDirection<8>(LLLocomotionMath::SelectDirectionFromAngle<8>(Angle, DeadZone, 0, false));
 
-	const float Angle = UKismetAnimationLibrary::CalculateDirection(PivotDirection2D, WorldRotation);
-	const ECardinalDirection CurrentDirection = SelectCardinalDirectionFromAngle(Angle, CardinalDirectionDeadZone, ECardinalDirection::Forward, false);
-	CardinalDirectionFromAcceleration = GetOppositeCardinalDirection(CurrentDirection);
+	bIsRunningIntoWall = LLLocomotionMath::IsRunningIntoWall(LocalVelocity2D.X, LocalVelocity2D.Y, LocalAcceleration2D.X, LocalAcceleration2D.Y);
 }
 
-void ULLAnimInstance::UpdateRotationData()
+void ULLAnimInstance::UpdateRotationData(float DeltaTime)
 {
-	YawDeltaSinceLastUpdate = WorldRotation.Yaw - PrevWorldRotation.Yaw;
-	const float YawDeltaSpeed = UKismetMathLibrary::SafeDivide(YawDeltaSinceLastUpdate, GetDeltaSeconds());
-	AdditiveLeanAngle = YawDeltaSpeed * 0.0375;
+	HotState.YawDeltaSinceLastUpdate = WorldRotation.Yaw - HotState.PrevWorldRotation.Yaw;
+	AdditiveLeanAngle = LLLocomotionMath::AdditiveLeanAngle(HotState.YawDeltaSinceLastUpdate, DeltaTime);
 
-	if (bIsFirstUpdate)
+	if (HotState.bIsFirstUpdate)
 	{
-		YawDeltaSinceLastUpdate = 0;
+		HotState.YawDeltaSinceLastUpdate = 0;
 		AdditiveLeanAngle = 0;
 	}
 }
 
 void ULLAnimInstance::UpdateVelocityData()
 {
-	bWasMovingLastUpdate = !LocalVelocity2D.IsZero();
+	HotState.bWasMovingLastUpdate = !LocalVelocity2D.IsZero();
 	
 	const FVector WorldVelocity2D(WorldVelocity.X, WorldVelocity.Y, 0);
 	LocalVelocity2D = WorldRotation.UnrotateVector(WorldVelocity2D);
@@ -539,102 +1253,48 @@ void ULLAnimInstance::UpdateVelocityData()
 	LocalVelocityDirectionAngle = UKismetAnimationLibrary::CalculateDirection(WorldVelocity2D, WorldRotation);
 	LocalVelocityDirectionAngleWithOffset = LocalVelocityDirectionAngle - RootYawOffset;
 
+	const float DeadZone = GetTuning().CardinalDirectionDeadZone;
 	LocalVelocityDirection = SelectCardinalDirectionFromAngle(
-		LocalVelocityDirectionAngleWithOffset, CardinalDirectionDeadZone, LocalVelocityDirection, bWasMovingLastUpdate);
-	LocalVelocityDirectionNoOffset = SelectCardinalDirectionFromAngle(
-		LocalVelocityDirectionAngle, CardinalDirectionDeadZone, LocalVelocityDirectionNoOffset, bWasMovingLastUpdate);
+		LocalVelocityDirectionAngleWithOffset, DeadZone, LocalVelocityDirection, HotState.bWasMovingLastUpdate);
+	HotState.LocalVelocityDirectionNoOffset = SelectCardinalDirectionFromAngle(
+		LocalVelocityDirectionAngle, DeadZone, HotState.LocalVelocityDirectionNoOffset, HotState.bWasMovingLastUpdate);
+	HotState.LocalVelocityOctant = LLLocomotionMath::SelectDirectionFromAngle<8>(
+		LocalVelocityDirectionAngleWithOffset, DeadZone, HotState.LocalVelocityOctant, HotState.bWasMovingLastUpdate);
+	HotState.LocalVelocityOctantNoOffset = LLLocomotionMath::SelectDirectionFromAngle<8>(
+		LocalVelocityDirectionAngle, DeadZone, HotState.LocalVelocityOctantNoOffset, HotState.bWasMovingLastUpdate);
 	
 	bHasVelocity = !FMath::IsNearlyZero(LocalVelocity2D.SizeSquared2D());
 }
 
 void ULLAnimInstance::UpdateRootYawOffset(float InDeltaTime)
 {
-	switch (RootYawOffsetMode)
+	switch (HotState.RootYawOffsetMode)
 	{
 	case ERootYawOffsetMode::Accumulate:
-		SetRootYawOffset(RootYawOffset - YawDeltaSinceLastUpdate);
+		SetRootYawOffset(RootYawOffset - HotState.YawDeltaSinceLastUpdate);
 		break;
 	case ERootYawOffsetMode::BlendOut:
-		SetRootYawOffset(UKismetMathLibrary::FloatSpringInterp(
-			RootYawOffset, 0, RootYawOffsetSpringState, 80, 1, InDeltaTime, 1, 0.5));
+		SetRootYawOffset(LLLocomotionMath::BlendOutRootYawOffset(RootYawOffset, HotState.RootYawOffsetSpringState, InDeltaTime));
 		break;
 	default:
 		break;
 	}
-	RootYawOffsetMode = ERootYawOffsetMode::BlendOut;
+	HotState.RootYawOffsetMode = ERootYawOffsetMode::BlendOut;
 }
 
 TObjectPtr<UAnimSequence> ULLAnimInstance::SelectDirectionalAnimation(const FCardinalDirections& Cardinals,
-	ECardinalDirection Direction)
+	ECardinalDirection Direction, uint8 Octant)
 {
-	switch (Direction)
-	{
-	default:
-		// falls through
-	case ECardinalDirection::Forward:
-		return Cardinals.Forward;
-	case ECardinalDirection::Backward:
-		return Cardinals.Backward;
-	case ECardinalDirection::Left:
-		return Cardinals.Left;
-	case ECardinalDirection::Right:
-		return Cardinals.Right;
-	}
+	return Cardinals.Select(Direction, Octant);
 }
 
 ECardinalDirection ULLAnimInstance::SelectCardinalDirectionFromAngle(float Angle, float DeadZone,
 	ECardinalDirection CurrentDirection, bool bUseCurrentDirection)
 {
-	const float AbsAngle = FMath::Abs(Angle);
-	float FwdDeadZone = DeadZone;
-	float BwdDeadZone = DeadZone;
-
-	if (bUseCurrentDirection)
-	{
-		switch (CurrentDirection)
-		{
-		case ECardinalDirection::Forward:
-			FwdDeadZone *= 2;
-			break;
-		case ECardinalDirection::Backward:
-			BwdDeadZone *= 2;
-			break;
-		default:
-			break;
-		}
-	}
-
-	if (AbsAngle <= FwdDeadZone + 45)
-	{
-		return ECardinalDirection::Forward;
-	}
-	else if (AbsAngle >= 135 - BwdDeadZone)
-	{
-		return ECardinalDirection::Backward;
-	}
-	else if (Angle > 0)
-	{
-		return ECardinalDirection::Right;
-	}
-	else
-	{
-		return ECardinalDirection::Left;
-	}
+	return LLLocomotionMath::SelectCardinalDirectionFromAngle(Angle, DeadZone, CurrentDirection, bUseCurrentDirection);
 }
 
 ECardinalDirection ULLAnimInstance::GetOppositeCardinalDirection(ECardinalDirection CurrentDirection)
 {
-	switch (CurrentDirection)
-	{
-	default:
-		// falls through
-	case ECardinalDirection::Forward:
-		return ECardinalDirection::Backward;
-	case ECardinalDirection::Backward:
-		return ECardinalDirection::Forward;
-	case ECardinalDirection::Left:
-		return ECardinalDirection::Right;
-	case ECardinalDirection::Right:
-		return ECardinalDirection::Left;
-	}
+	return LLLocomotionMath::GetOppositeCardinalDirection(CurrentDirection);
 }
@@ -5,19 +5,91 @@
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "LLAnimNodeCache.h"
+#include "LLCharacterMovementComponent.h"
+#include "LLLocomotionAnimSet.h"
+#include "LLLocomotionMath.h"
+#include "LLLocomotionTuning.h"
+#include "LLPoseSharing.h"
 #include "LyraLocomotionTypes.h"
 #include "LLAnimInstance.generated.h"
 
+struct FStreamableHandle;
+
+// Native state read and written on every update of ULLAnimInstance, kept in one cache line aligned block apart from
+// the settings, anim sets and streaming state an update rarely touches
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FLLLocomotionHotState
+{
+	FLLLocomotionSnapshot Snapshot;
+	FVector PrevWorldLocation { 0 };
+	FRotator PrevWorldRotation { 0 };
+	FVector PivotDirection2D { 0 };
+	LLLocomotionMath::FLLSpringState RootYawOffsetSpringState;
+
+	// Time covered by the current update, more than one frame when updates are skipped
+	float UpdateDeltaSeconds = 0;
+	float DisplacementSinceLastUpdate = 0;
+	float YawDeltaSinceLastUpdate = 0;
+	float TurnYawCurveValue = 0;
+	float TimeFalling = 0;
+
+	ERootYawOffsetMode RootYawOffsetMode = ERootYawOffsetMode::BlendOut;
+	ECardinalDirection LocalVelocityDirectionNoOffset = ECardinalDirection::Forward;
+	ECardinalDirection CardinalDirectionFromAcceleration = ECardinalDirection::Forward;
+	// The same directions among eight, for 8-way anim sets
+	uint8 LocalVelocityOctant = 0;
+	uint8 LocalVelocityOctantNoOffset = 0;
+	uint8 OctantFromAcceleration = 0;
+	bool bIsFirstUpdate = true;
+	bool bWasMovingLastUpdate = false;
+	bool bHasSnapshot = false;
+};
+
+// Four cache lines of 64 bytes today, a new field that spills into a fifth should be a deliberate choice
+static_assert(sizeof(FLLLocomotionHotState) <= 256, "FLLLocomotionHotState grew past four 64 byte cache lines");
+
 UCLASS()
 class LYRALOCOMOTION_API ULLAnimInstance : public UAnimInstance
 {
 	GENERATED_BODY()
 
 public:
+	virtual void NativeInitializeAnimation() override;
+	virtual void NativeBeginPlay() override;
+	virtual void NativeUninitializeAnimation() override;
 	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
 	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativePostEvaluateAnimation() override;
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+
+	ELLLocomotionFidelity GetLocomotionFidelity() const { return LocomotionFidelity; }
+	void SetLocomotionFidelity(ELLLocomotionFidelity InLocomotionFidelity);
+
+	// A dormant instance has the tick of its mesh turned off and keeps the last pose
+	bool IsDormant() const { return bIsDormant; }
+
+	// Resumes the updates of a dormant instance, ALLCharacter calls it when the character moves, turns or plays a montage
+	void WakeUp();
+
+	// Streams in the sequences of InAnimSet and uses each one as soon as it arrives, the sequences set on the instance fill in until then.
+	// Null goes back to the sequences set on the instance.
+	UFUNCTION(BlueprintCallable, Category = "Anim Set")
+	void SetStreamedAnimSet(ULLLocomotionAnimSet* InAnimSet);
+
+	// Locomotion values gameplay code reads, as of the last completed update. A copy the game thread owns,
+	// so it can be read while the anim worker updates the instance.
+	UFUNCTION(BlueprintPure, Category = "Gameplay")
+	FLLLocomotionGameplayState GetGameplayState() const { return GameplayState; }
+
+	// On a dedicated server with bGameplayOnlyOnDedicatedServer the mesh skips the graph and pose evaluation,
+	// ULLLocomotionSubsystem updates the locomotion values of the instance instead
+	bool IsGameplayOnly() const { return bGameplayOnly; }
 
 protected:
+	// False on the cycle only fidelity tier, transitions into start, stop and pivot states check it
+	UFUNCTION(BlueprintPure, Category = "Fidelity", meta = (BlueprintThreadSafe))
+	bool ShouldPlayTransitionStates() const;
+
 	UFUNCTION(BlueprintPure, Category = "Distance Matching", meta = (BlueprintThreadSafe))
 	bool ShouldDistanceMatchStop() const;
 
@@ -106,21 +178,23 @@ protected:
 	void UpdateTurnInPlaceRecoveryAnim(const struct FAnimUpdateContext& Context, const struct FAnimNodeReference& Node);
 
 	void ProcessTurnYawCurve();
+	void SampleTurnYawCurves(float& OutTurnYawWeight, float& OutRemainingTurnYaw);
 	void SetRootYawOffset(float InRootYawOffset);
 	TObjectPtr<UAnimSequence> SelectTurnInPlaceAnimation(float Direction) const;
 	float GetGroundDistance(TObjectPtr<ACharacter> Owner);
+	void BuildDistanceMatchingTables() const;
 
+	void UpdateCharacterStateData(float DeltaTime);
 	void UpdateLocationData(float DeltaTime);
-	void UpdateRotationData();
+	void UpdateRotationData(float DeltaTime);
 	void UpdateVelocityData();
 	void UpdateAccelerationData();
 	void UpdateRootYawOffset(float InDeltaTime);
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Settings")
-	FName LocomotionDistanceCurveName = TEXT("Distance");
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Settings")
-	FName JumpDistanceCurveName = TEXT("GroundDistance");
+	// Per frame state the Blueprint reads, declared back to back so an update touches as few cache lines as possible.
+	// Settings and anim sets only read on set up or streaming follow the private hot state below.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Fidelity")
+	ELLLocomotionFidelity LocomotionFidelity = ELLLocomotionFidelity::Full;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Location Data")
 	FVector WorldLocation;
@@ -206,6 +280,24 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character State Data")
 	uint8 bIsFalling : 1;
 
+private:
+	FLLLocomotionHotState HotState;
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Settings")
+	FName LocomotionDistanceCurveName = TEXT("Distance");
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Settings")
+	FName JumpDistanceCurveName = TEXT("GroundDistance");
+
+	// Shared by every instance of the archetype, the class defaults of ULLLocomotionTuning when not set
+	UPROPERTY(EditDefaultsOnly, Category = "Settings")
+	TObjectPtr<ULLLocomotionTuning> Tuning;
+
+	// Streamed in over the Anim Set sequences below, which then only need to hold a small resident set shared by all anim sets
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Anim Set")
+	TObjectPtr<ULLLocomotionAnimSet> StreamedAnimSet;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Anim Set - Idle")
 	TObjectPtr<UAnimSequence> IdleAnimSequence;
 
@@ -249,65 +341,122 @@ protected:
 	TObjectPtr<UAnimSequence> JumpRecoveryAdditive;
 
 private:
-	static TObjectPtr<UAnimSequence> SelectDirectionalAnimation(const FCardinalDirections &Cardinals, ECardinalDirection Direction);
+	friend class ULLLocomotionSubsystem;
+	friend struct FLLAnimInstanceProxy;
+	friend struct FLLAnimNode_LocomotionSequencePlayer;
+	friend struct FLLAnimNode_LocomotionSequenceEvaluator;
+	friend struct FLLAnimNode_SharedLocomotionPose;
+
+	// Set up runs when the node becomes relevant, update on every update of the node. Shared by the native
+	// locomotion nodes and the Blueprint bound node functions of the same role.
+	void SetUpSequencePlayer(ELLSequencePlayerRole Role, FAnimNode_SequencePlayer& SequencePlayer);
+	void UpdateSequencePlayer(ELLSequencePlayerRole Role, const FAnimationUpdateContext& Context, FAnimNode_SequencePlayer& SequencePlayer);
+	void SetUpSequenceEvaluator(ELLSequenceEvaluatorRole Role, FAnimNode_SequenceEvaluator& SequenceEvaluator);
+	void UpdateSequenceEvaluator(ELLSequenceEvaluatorRole Role, const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator);
+
+	void UpdateStartSequence(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator);
+	void UpdateStopSequence(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator);
+	void UpdatePivotSequence(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator);
+
+	// Game thread half of the update, then the half NativeThreadSafeUpdateAnimation runs on a worker
+	void GatherLocomotionInputs(float DeltaSeconds);
+	void UpdateLocomotionState(float DeltaSeconds);
+	void UpdateGameplayOnly(float DeltaSeconds);
+	// Copies the locomotion values gameplay reads, on the game thread once the update completed
+	void UpdateGameplayState();
+
+	bool IsKinematicsBatched() const { return bKinematicsBatched; }
+	const ULLLocomotionTuning& GetTuning() const { return Tuning ? *Tuning : *GetDefault<ULLLocomotionTuning>(); }
+
+	bool IsFullyIdle() const;
+	void EnterDormancy();
+
+	// Key of the pose the last update played, false when it played anything but a single idle or cycle or can't keep sharing it
+	bool GetPoseSharingKey(FLLPoseSharingKey& OutKey) const;
+	bool CanSharePose(ELLSequencePlayerRole Role, const UAnimSequenceBase* Sequence) const;
+	bool IsPoseSharingFollower() const { return PoseSharingRole == ELLPoseSharingRole::Follower && !bPoseSharingDiverged && SharedPose->IsReadable(); }
+	// Whether a follower still plays what its leader published, within PoseSharingTimeStep of its time
+	bool IsInStepWithSharedPose() const;
+
+	void RequestAnimSetGroup(ELLAnimSetGroup Group);
+	void OnAnimSetGroupStreamed(ELLAnimSetGroup Group);
+	void CancelAnimSetStreaming();
+	void RestoreResidentAnimSet();
+
+	static TObjectPtr<UAnimSequence> SelectDirectionalAnimation(const FCardinalDirections &Cardinals, ECardinalDirection Direction, uint8 Octant);
 	static ECardinalDirection SelectCardinalDirectionFromAngle(float Angle, float DeadZone, ECardinalDirection CurrentDirection, bool bUseCurrentDirection);
 	static ECardinalDirection GetOppositeCardinalDirection(ECardinalDirection CurrentDirection);
 	
-	bool bIsFirstUpdate = true;
-	bool bWasMovingLastUpdate = false; 
-	bool bIsAnyMontagePlaying = false;
-	bool bUseSeparateBrakingFriction = false;
-	float GroundFriction = 0;
-	float BrakingFriction = 0;
-	float BrakingFrictionFactor = 0;
-	float BrakingDecelerationWalking = 0;
-	FVector CurrAcceleration { 0 };
-	FVector LastUpdateVelocity { 0 };
-
-	// Location Data
-	float DisplacementSinceLastUpdate = 0;
-	FVector PrevWorldLocation { 0 };
+	UPROPERTY(Transient)
+	TObjectPtr<ULLCharacterMovementComponent> LocomotionMovement;
 
-	// Rotation Data
-	float YawDeltaSinceLastUpdate = 0;
-	
 	// Turn In Place
-	float TurnYawCurveValue = 0;
 	float TurnInPlaceRotationDirection = 0;
 	float TurnInPlaceRecoveryDirection = 0;
-	FRotator PrevWorldRotation;
-	FVector2D RootYawOffsetAngleClamp { -120, 100 };
-	FFloatSpringState RootYawOffsetSpringState;
-	ERootYawOffsetMode RootYawOffsetMode;
+	bool bSampleTurnYawFromSequence = false;
+	// Sequence the turn in place rotation state played on its last update, consumed by ProcessTurnYawCurve
+	const UAnimSequence* PlayedTurnInPlaceSequence = nullptr;
 
 	// Idle Breaks
 	float IdleBreakDelayTime = 0;
 	uint8 CurrentIdleBreakIndex = 0;
 
-	// Settings
-	float StrideWarpingBlendInStartOffset = 0.15f;
-	float StrideWarpingBlendInDurationScaled = 0.2f;
-	float CardinalDirectionDeadZone = 10.0f;
-	FVector2D PlayRateClampCycle { 0.8f, 1.2f };
-	FVector2D PlayRateClampStartsPivots { 0.6f, 5.0f };
-
-	// Velocity Data
-	ECardinalDirection LocalVelocityDirectionNoOffset;
-
-	// Acceleration Data
-	FVector PivotDirection2D { 0 };
-
 	// Locomotion SM Data
 	ECardinalDirection PivotInitialDirection;
-	ECardinalDirection CardinalDirectionFromAcceleration;
 	
 	// Pivots
 	float TimeAtPivotStop = 0;
 
+	// Stop and pivot distances, predicted again only when the velocity, acceleration or friction changed
+	mutable LLLocomotionMath::FLLGroundMovementPrediction GroundMovementPrediction;
+
+	// Gameplay
+	FLLLocomotionGameplayState GameplayState;
+
 	// Ground Distance
 	uint64 LastUpdateFrame = 0;
 	float LastGroundDistance = 0;
-
-	// Jump
-	float TimeFalling = 0;
+	double LastGroundDistanceZ = 0;
+
+	// Locomotion Subsystem
+	UPROPERTY(Transient)
+	TObjectPtr<class ULLLocomotionSubsystem> LocomotionSubsystem;
+	int32 LocomotionSlot = INDEX_NONE;
+	bool bKinematicsBatched = false;
+	bool bGameplayOnly = false;
+	bool bRestoreUpdateRateOptimizations = false;
+
+	// Dormancy
+	bool bDormancyEnabled = false;
+	bool bPendingDormancy = false;
+	bool bIsDormant = false;
+	bool bDisabledMeshTick = false;
+	float DormancyDelay = 0;
+	float FullyIdleTime = 0;
+	double DormantSinceTime = 0;
+	FTimerHandle IdleBreakWakeTimer;
+
+	// Anim Set Streaming
+	TSharedPtr<FStreamableHandle> AnimSetStreamingHandles[static_cast<int32>(ELLAnimSetGroup::Num)];
+	uint8 RequestedAnimSetGroups = 0;
+
+	// Pose Sharing, the role and shared pose are set by ULLLocomotionSubsystem before the update
+	ELLPoseSharingRole PoseSharingRole = ELLPoseSharingRole::None;
+	bool bPoseSharingDiverged = false;
+	TSharedPtr<FLLSharedPose> SharedPose;
+	// Locomotion sequence players and evaluators updated by the last update, and the idle or cycle among them
+	uint8 NumPlayedLocomotionNodes = 0;
+	ELLSequencePlayerRole PlayedSharableRole = ELLSequencePlayerRole::Idle;
+	const UAnimSequenceBase* PlayedSharableSequence = nullptr;
+	float PlayedSharableTime = 0;
+	float PoseSharingTimeStep = 0.1f;
+	float PoseSharingMaxRootYawOffset = 45.0f;
+
+	// Cost of the updates since the animation budget of ULLLocomotionSubsystem last consumed it: both native updates,
+	// the graph update and pose evaluation timed by FLLAnimInstanceProxy and a share of the kinematics batch.
+	// Timed in every build configuration, but only while the budget is on.
+	uint64 MeasuredUpdateCycles = 0;
+	bool bMeasureUpdateCost = false;
+
+	FLLAnimNodeCache AnimNodeCache;
 };
@@ -0,0 +1,47 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLAnimInstanceProxy.h"
+#include "LLAnimInstance.h"
+#include "LLLocomotionProfiler.h"
+
+FLLAnimInstanceProxy::FLLAnimInstanceProxy(ULLAnimInstance* InAnimInstance)
+	: FAnimInstanceProxy(InAnimInstance)
+	, LocomotionAnimInstance(InAnimInstance)
+{
+}
+
+void FLLAnimInstanceProxy::UpdateAnimationNode_WithRoot(const FAnimationUpdateContext& InContext, FAnimNode_Base* InRootNode, FName InLayerName)
+{
+	LL_SCOPED_STAT(AnimGraphUpdate);
+
+	const uint64 StartCycles = IsMeasuringUpdateCost() ? FPlatformTime::Cycles64() : 0;
+	++TimedScopeDepth;
+	Super::UpdateAnimationNode_WithRoot(InContext, InRootNode, InLayerName);
+	--TimedScopeDepth;
+	AddMeasuredCycles(StartCycles);
+}
+
+void FLLAnimInstanceProxy::EvaluateAnimationNode_WithRoot(FPoseContext& Output, FAnimNode_Base* InRootNode)
+{
+	LL_SCOPED_STAT(AnimGraphEvaluate);
+
+	const uint64 StartCycles = IsMeasuringUpdateCost() ? FPlatformTime::Cycles64() : 0;
+	++TimedScopeDepth;
+	Super::EvaluateAnimationNode_WithRoot(Output, InRootNode);
+	--TimedScopeDepth;
+	AddMeasuredCycles(StartCycles);
+}
+
+bool FLLAnimInstanceProxy::IsMeasuringUpdateCost() const
+{
+	return LocomotionAnimInstance && LocomotionAnimInstance->bMeasureUpdateCost;
+}
+
+void FLLAnimInstanceProxy::AddMeasuredCycles(uint64 StartCycles)
+{
+	if (TimedScopeDepth == 0 && IsMeasuringUpdateCost())
+	{
+		LocomotionAnimInstance->MeasuredUpdateCycles += FPlatformTime::Cycles64() - StartCycles;
+	}
+}
@@ -0,0 +1,32 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "LLAnimInstanceProxy.generated.h"
+
+class ULLAnimInstance;
+
+// Proxy of ULLAnimInstance that times the graph update and the pose evaluation on the anim worker while the animation budget is on,
+// so the budget costs an instance by all of its update and not just the native part of it.
+USTRUCT()
+struct FLLAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FLLAnimInstanceProxy() = default;
+	explicit FLLAnimInstanceProxy(ULLAnimInstance* InAnimInstance);
+
+protected:
+	virtual void UpdateAnimationNode_WithRoot(const FAnimationUpdateContext& InContext, FAnimNode_Base* InRootNode, FName InLayerName) override;
+	virtual void EvaluateAnimationNode_WithRoot(FPoseContext& Output, FAnimNode_Base* InRootNode) override;
+
+private:
+	bool IsMeasuringUpdateCost() const;
+	void AddMeasuredCycles(uint64 StartCycles);
+
+	ULLAnimInstance* LocomotionAnimInstance = nullptr;
+	// Layers of the same instance update and evaluate from within the root, only the outermost call is timed
+	int32 TimedScopeDepth = 0;
+};
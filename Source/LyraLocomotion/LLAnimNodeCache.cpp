@@ -0,0 +1,117 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLAnimNodeCache.h"
+#include "AnimationRuntime.h"
+#include "Animation/AnimExecutionContext.h"
+#include "AnimNodes/AnimNode_Inertialization.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimNode_SequencePlayer.h"
+#include "Animation/AnimNode_StateMachine.h"
+#include "Animation/AnimNodeReference.h"
+#include "AnimNodes/AnimNode_SequenceEvaluator.h"
+#include "AnimNodes/AnimNode_StateResult.h"
+#include "LLLocomotionProfiler.h"
+
+namespace
+{
+	void RequestInertialization(const FAnimationUpdateContext& Context, float BlendTime)
+	{
+		// A zero blend time switches sequences instantly, as in the engine libraries
+		if (BlendTime <= 0.0f)
+		{
+			return;
+		}
+
+		if (UE::Anim::IInertializationRequester* InertializationRequester = Context.GetMessage<UE::Anim::IInertializationRequester>())
+		{
+			LL_INC_COUNTER(InertialBlendRequests);
+			InertializationRequester->RequestInertialization(BlendTime);
+		}
+	}
+}
+
+void FLLAnimNodeCache::Reset()
+{
+	for (FEntry& Entry : Entries)
+	{
+		Entry = FEntry();
+	}
+}
+
+template <typename NodeType>
+NodeType* FLLAnimNodeCache::Resolve(ELLAnimNodeSlot Slot, const FAnimNodeReference& Reference)
+{
+	FEntry& Entry = Entries[static_cast<uint8>(Slot)];
+	const FAnimNode_Base* Source = Reference.GetAnimNodePtr<FAnimNode_Base>();
+	if (Entry.Source != Source)
+	{
+		Entry = FEntry();
+		Entry.Source = Source;
+		Entry.Node = Reference.GetAnimNodePtr<NodeType>();
+	}
+	return static_cast<NodeType*>(Entry.Node);
+}
+
+FAnimNode_SequenceEvaluator* FLLAnimNodeCache::GetSequenceEvaluator(ELLAnimNodeSlot Slot, const FAnimNodeReference& Reference)
+{
+	return Resolve<FAnimNode_SequenceEvaluator>(Slot, Reference);
+}
+
+FAnimNode_SequencePlayer* FLLAnimNodeCache::GetSequencePlayer(ELLAnimNodeSlot Slot, const FAnimNodeReference& Reference)
+{
+	return Resolve<FAnimNode_SequencePlayer>(Slot, Reference);
+}
+
+bool FLLAnimNodeCache::IsStateBlendingOut(ELLAnimNodeSlot Slot, const FAnimUpdateContext& Context, const FAnimNodeReference& Reference)
+{
+	const FAnimNode_StateResult* StateResult = Resolve<FAnimNode_StateResult>(Slot, Reference);
+	if (!StateResult)
+	{
+		return false;
+	}
+
+	FEntry& Entry = Entries[static_cast<uint8>(Slot)];
+	if (!Entry.StateMachine)
+	{
+		const FAnimationUpdateContext* AnimationUpdateContext = Context.GetContext();
+		if (!AnimationUpdateContext || !AnimationUpdateContext->AnimInstanceProxy)
+		{
+			return false;
+		}
+
+		Entry.StateMachine = AnimationUpdateContext->AnimInstanceProxy->GetStateMachineInstance(StateResult->GetStateMachineIndex());
+		Entry.StateIndex = StateResult->GetStateIndex();
+		if (!Entry.StateMachine)
+		{
+			return false;
+		}
+	}
+
+	return Entry.StateMachine->GetStateWeight(Entry.StateIndex) > 0 && Entry.StateMachine->GetCurrentState() != Entry.StateIndex;
+}
+
+void FLLAnimNodeCache::SetSequenceWithInertialBlending(const FAnimationUpdateContext& Context, FAnimNode_SequencePlayer& SequencePlayer, UAnimSequenceBase* Sequence, float BlendTime)
+{
+	if (SequencePlayer.GetSequence() != Sequence)
+	{
+		ensure(SequencePlayer.SetSequence(Sequence));
+		RequestInertialization(Context, BlendTime);
+	}
+}
+
+void FLLAnimNodeCache::SetSequenceWithInertialBlending(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator, UAnimSequenceBase* Sequence, float BlendTime)
+{
+	if (SequenceEvaluator.GetSequence() != Sequence)
+	{
+		ensure(SequenceEvaluator.SetSequence(Sequence));
+		RequestInertialization(Context, BlendTime);
+	}
+}
+
+void FLLAnimNodeCache::AdvanceTime(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator, float PlayRate)
+{
+	float NewTime = SequenceEvaluator.GetExplicitTime();
+	FAnimationRuntime::AdvanceTime(SequenceEvaluator.GetShouldLoop(), Context.GetDeltaTime() * PlayRate, NewTime, SequenceEvaluator.GetCurrentAssetLength());
+	ensure(SequenceEvaluator.SetExplicitTime(NewTime));
+}
@@ -0,0 +1,74 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+
+struct FAnimNode_Base;
+struct FAnimNode_SequenceEvaluator;
+struct FAnimNode_SequencePlayer;
+struct FAnimNode_StateMachine;
+struct FAnimNodeReference;
+struct FAnimUpdateContext;
+struct FAnimationUpdateContext;
+class UAnimSequenceBase;
+
+// One entry per anim node function of ULLAnimInstance that touches its node
+enum class ELLAnimNodeSlot : uint8
+{
+	UpdateIdleTurnYawState,
+	UpdateIdleState,
+	UpdateStartState,
+	UpdateStopState,
+	UpdateIdleAnim,
+	SetUpIdleBreakAnim,
+	SetUpStartAnim,
+	UpdateStartAnim,
+	UpdateCycleAnim,
+	SetUpStopAnim,
+	UpdateStopAnim,
+	SetUpPivotAnim,
+	UpdatePivotAnim,
+	SetUpFallLandAnim,
+	UpdateFallLandAnim,
+	SetupTurnInPlaceAnim,
+	UpdateTurnInPlaceAnim,
+	UpdateTurnInPlaceRecoveryAnim,
+	Count
+};
+
+// Typed anim nodes resolved once per node function instead of converting the node reference on every call.
+// An entry is resolved again whenever the function is called with another node, and the whole cache is reset when the instance is (re)initialized.
+class FLLAnimNodeCache
+{
+public:
+	void Reset();
+
+	FAnimNode_SequenceEvaluator* GetSequenceEvaluator(ELLAnimNodeSlot Slot, const FAnimNodeReference& Reference);
+	FAnimNode_SequencePlayer* GetSequencePlayer(ELLAnimNodeSlot Slot, const FAnimNodeReference& Reference);
+
+	// Same as UAnimationStateMachineLibrary::IsStateBlendingOut, with the state machine looked up once. False when the node isn't a state result.
+	bool IsStateBlendingOut(ELLAnimNodeSlot Slot, const FAnimUpdateContext& Context, const FAnimNodeReference& Reference);
+
+	// Same as the SetSequenceWithInertialBlending of the sequence player and evaluator libraries
+	static void SetSequenceWithInertialBlending(const FAnimationUpdateContext& Context, FAnimNode_SequencePlayer& SequencePlayer, UAnimSequenceBase* Sequence, float BlendTime = 0.2f);
+	static void SetSequenceWithInertialBlending(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator, UAnimSequenceBase* Sequence, float BlendTime = 0.2f);
+
+	// Same as USequenceEvaluatorLibrary::AdvanceTime
+	static void AdvanceTime(const FAnimationUpdateContext& Context, FAnimNode_SequenceEvaluator& SequenceEvaluator, float PlayRate = 1.0f);
+
+private:
+	struct FEntry
+	{
+		const FAnimNode_Base* Source = nullptr;
+		FAnimNode_Base* Node = nullptr;
+		const FAnimNode_StateMachine* StateMachine = nullptr;
+		int32 StateIndex = INDEX_NONE;
+	};
+
+	template <typename NodeType>
+	NodeType* Resolve(ELLAnimNodeSlot Slot, const FAnimNodeReference& Reference);
+
+	TStaticArray<FEntry, static_cast<uint8>(ELLAnimNodeSlot::Count)> Entries;
+};
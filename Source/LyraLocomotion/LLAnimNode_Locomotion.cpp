@@ -0,0 +1,119 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLAnimNode_Locomotion.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "LLAnimInstance.h"
+#include "LLLocomotionProfiler.h"
+
+void FLLLocomotionNodeBinding::Initialize(const FAnimationInitializeContext& Context)
+{
+	AnimInstance = Cast<ULLAnimInstance>(Context.AnimInstanceProxy->GetAnimInstanceObject());
+	UpdateCounter.Reset();
+}
+
+bool FLLLocomotionNodeBinding::BecomeRelevant(const FAnimationUpdateContext& Context)
+{
+	const FGraphTraversalCounter& ProxyUpdateCounter = Context.AnimInstanceProxy->GetUpdateCounter();
+	const bool bBecameRelevant = !UpdateCounter.HasEverBeenUpdated() || !UpdateCounter.WasSynchronizedCounter(ProxyUpdateCounter);
+	UpdateCounter.SynchronizeWith(ProxyUpdateCounter);
+	return bBecameRelevant;
+}
+
+void FLLAnimNode_LocomotionSequencePlayer::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	Binding.Initialize(Context);
+
+	FAnimNode_SequencePlayer::Initialize_AnyThread(Context);
+}
+
+void FLLAnimNode_LocomotionSequencePlayer::UpdateAssetPlayer(const FAnimationUpdateContext& Context)
+{
+	LL_SCOPED_PROFILER_TIMER(LocomotionAnimNode);
+
+	if (ULLAnimInstance* AnimInstance = Binding.AnimInstance)
+	{
+		if (Binding.BecomeRelevant(Context))
+		{
+			AnimInstance->SetUpSequencePlayer(Role, *this);
+		}
+		AnimInstance->UpdateSequencePlayer(Role, Context, *this);
+	}
+
+	FAnimNode_SequencePlayer::UpdateAssetPlayer(Context);
+}
+
+void FLLAnimNode_LocomotionSequenceEvaluator::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	Binding.Initialize(Context);
+
+	FAnimNode_SequenceEvaluator::Initialize_AnyThread(Context);
+}
+
+void FLLAnimNode_LocomotionSequenceEvaluator::UpdateAssetPlayer(const FAnimationUpdateContext& Context)
+{
+	LL_SCOPED_PROFILER_TIMER(LocomotionAnimNode);
+
+	if (ULLAnimInstance* AnimInstance = Binding.AnimInstance)
+	{
+		if (Binding.BecomeRelevant(Context))
+		{
+			AnimInstance->SetUpSequenceEvaluator(Role, *this);
+		}
+		AnimInstance->UpdateSequenceEvaluator(Role, Context, *this);
+	}
+
+	FAnimNode_SequenceEvaluator::UpdateAssetPlayer(Context);
+}
+
+void FLLAnimNode_SharedLocomotionPose::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	FAnimNode_Base::Initialize_AnyThread(Context);
+
+	Binding.Initialize(Context);
+	bFollowing = false;
+	Source.Initialize(Context);
+}
+
+void FLLAnimNode_SharedLocomotionPose::CacheBones_AnyThread(const FAnimationCacheBonesContext& Context)
+{
+	Source.CacheBones(Context);
+}
+
+void FLLAnimNode_SharedLocomotionPose::Update_AnyThread(const FAnimationUpdateContext& Context)
+{
+	GetEvaluateGraphExposedInputs().Execute(Context);
+
+	// Followers still update Source, so their own playback time and state machine keep going and ULLLocomotionSubsystem
+	// can check them against the leader. Only the evaluation is shared.
+	const ULLAnimInstance* AnimInstance = Binding.AnimInstance;
+	bFollowing = AnimInstance && AnimInstance->IsPoseSharingFollower();
+	Source.Update(Context);
+}
+
+void FLLAnimNode_SharedLocomotionPose::Evaluate_AnyThread(FPoseContext& Output)
+{
+	const ULLAnimInstance* AnimInstance = Binding.AnimInstance;
+	if (bFollowing && AnimInstance->SharedPose->CopyTo(Output))
+	{
+		LL_INC_COUNTER(SharedPosesCopied);
+		return;
+	}
+
+	// A follower whose bones no longer match the leader's evaluates its own graph, which is up to date.
+	Source.Evaluate(Output);
+
+	if (AnimInstance && AnimInstance->PoseSharingRole == ELLPoseSharingRole::Leader && AnimInstance->SharedPose)
+	{
+		AnimInstance->SharedPose->Publish(Output, AnimInstance->PlayedSharableTime);
+	}
+}
+
+void FLLAnimNode_SharedLocomotionPose::GatherDebugData(FNodeDebugData& DebugData)
+{
+	FString DebugLine = DebugData.GetNodeName(this);
+	DebugLine += FString::Printf(TEXT("(Following: %s)"), bFollowing ? TEXT("true") : TEXT("false"));
+	DebugData.AddDebugItem(DebugLine);
+
+	Source.GatherDebugData(DebugData);
+}
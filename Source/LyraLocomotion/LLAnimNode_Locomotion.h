@@ -0,0 +1,79 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNode_SequencePlayer.h"
+#include "AnimNodes/AnimNode_SequenceEvaluator.h"
+#include "LyraLocomotionTypes.h"
+#include "LLAnimNode_Locomotion.generated.h"
+
+class ULLAnimInstance;
+
+// Anim instance a locomotion node runs its logic on, and whether the node became relevant again since its last update
+struct FLLLocomotionNodeBinding
+{
+	void Initialize(const FAnimationInitializeContext& Context);
+	bool BecomeRelevant(const FAnimationUpdateContext& Context);
+
+	ULLAnimInstance* AnimInstance = nullptr;
+
+private:
+	FGraphTraversalCounter UpdateCounter;
+};
+
+// Sequence player that selects its sequence and play rate natively in ULLAnimInstance,
+// replacing the Blueprint bound set up and update functions of the same role
+USTRUCT(BlueprintInternalUseOnly)
+struct LYRALOCOMOTION_API FLLAnimNode_LocomotionSequencePlayer : public FAnimNode_SequencePlayer
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Locomotion")
+	ELLSequencePlayerRole Role = ELLSequencePlayerRole::Idle;
+
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void UpdateAssetPlayer(const FAnimationUpdateContext& Context) override;
+
+private:
+	FLLLocomotionNodeBinding Binding;
+};
+
+// Sequence evaluator that selects its sequence and distance matches natively in ULLAnimInstance,
+// replacing the Blueprint bound set up and update functions of the same role
+USTRUCT(BlueprintInternalUseOnly)
+struct LYRALOCOMOTION_API FLLAnimNode_LocomotionSequenceEvaluator : public FAnimNode_SequenceEvaluator
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Locomotion")
+	ELLSequenceEvaluatorRole Role = ELLSequenceEvaluatorRole::Start;
+
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void UpdateAssetPlayer(const FAnimationUpdateContext& Context) override;
+
+private:
+	FLLLocomotionNodeBinding Binding;
+};
+
+// Placed above the locomotion state machine. Followers of a shared pose copy the local space pose their leader
+// evaluated last frame instead of evaluating Source, leaders publish the pose Source evaluated.
+// Nodes above this one, such as the root yaw offset and lean, still run per character.
+USTRUCT(BlueprintInternalUseOnly)
+struct LYRALOCOMOTION_API FLLAnimNode_SharedLocomotionPose : public FAnimNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Links")
+	FPoseLink Source;
+
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void CacheBones_AnyThread(const FAnimationCacheBonesContext& Context) override;
+	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
+	virtual void Evaluate_AnyThread(FPoseContext& Output) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+
+private:
+	FLLLocomotionNodeBinding Binding;
+	bool bFollowing = false;
+};
@@ -9,10 +9,14 @@
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "LLAnimInstance.h"
+#include "LLCharacterMovementComponent.h"
+#include "LLLocomotionSettings.h"
 #include "LLPlayerController.h"
 
 
-ALLCharacter::ALLCharacter()
+ALLCharacter::ALLCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<ULLCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = false;
 	bUseControllerRotationYaw = true;
@@ -49,6 +53,7 @@ ALLCharacter::ALLCharacter()
 	GetMesh()->SetSkeletalMesh(UE4Mannequin.Object);
 	GetMesh()->SetRelativeLocationAndRotation(FVector(0.f, 0.f, -94.f), FRotator(0.f, -90.f, 0.f));
 	GetMesh()->SetCollisionProfileName(TEXT("NoCollision"));
+	GetMesh()->bEnableUpdateRateOptimizations = GetDefault<ULLLocomotionSettings>()->bEnableUpdateRateOptimizations;
 
 	static ConstructorHelpers::FClassFinder<UAnimInstance> LocomotionAnimInstance(TEXT("/Game/Blueprints/ABP_LyraLocomotion.ABP_LyraLocomotion_C"));
 	ensure(LocomotionAnimInstance.Class != nullptr);
@@ -56,6 +61,17 @@ ALLCharacter::ALLCharacter()
 	
 }
 
+void ALLCharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// A pipelined mesh reads the snapshot published at the start of the frame, it doesn't have to tick after the movement.
+	if (GetDefault<ULLLocomotionSettings>()->bPipelineLocomotionUpdate && GetMesh() && GetCharacterMovement())
+	{
+		GetMesh()->PrimaryComponentTick.RemovePrerequisite(GetCharacterMovement(), GetCharacterMovement()->PrimaryComponentTick);
+	}
+}
+
 void ALLCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
@@ -77,6 +93,31 @@ void ALLCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompone
 	}
 }
 
+float ALLCharacter::PlayAnimMontage(UAnimMontage* AnimMontage, float InPlayRate, FName StartSectionName)
+{
+	WakeLocomotion();
+
+	return Super::PlayAnimMontage(AnimMontage, InPlayRate, StartSectionName);
+}
+
+void ALLCharacter::WakeLocomotion()
+{
+	if (ULLAnimInstance* AnimInstance = Cast<ULLAnimInstance>(GetMesh()->GetAnimInstance()))
+	{
+		AnimInstance->WakeUp();
+	}
+}
+
+bool ALLCharacter::GetLocomotionGameplayState(FLLLocomotionGameplayState& OutState) const
+{
+	if (const ULLAnimInstance* AnimInstance = Cast<ULLAnimInstance>(GetMesh()->GetAnimInstance()))
+	{
+		OutState = AnimInstance->GetGameplayState();
+		return true;
+	}
+	return false;
+}
+
 void ALLCharacter::Move(const FInputActionValue& Value)
 {
 	if (Controller != nullptr)
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "LyraLocomotionTypes.h"
 #include "LLCharacter.generated.h"
 
 UCLASS()
@@ -18,9 +19,19 @@ class LYRALOCOMOTION_API ALLCharacter : public ACharacter
 	TObjectPtr<class USpringArmComponent> CameraBoom;
 
 public:
-	ALLCharacter();
+	ALLCharacter(const FObjectInitializer& ObjectInitializer);
+
+	virtual void PostInitializeComponents() override;
 
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+	virtual float PlayAnimMontage(class UAnimMontage* AnimMontage, float InPlayRate = 1.f, FName StartSectionName = NAME_None) override;
+
+	// Resumes a dormant locomotion anim instance, on any movement, rotation or montage of the character
+	void WakeLocomotion();
+
+	// Locomotion values of the mesh's ULLAnimInstance, false when it has none. Also valid on gameplay only dedicated servers.
+	UFUNCTION(BlueprintCallable, Category = "Locomotion")
+	bool GetLocomotionGameplayState(FLLLocomotionGameplayState& OutState) const;
 
 protected:
 	virtual void Move(const struct FInputActionValue& Value);
@@ -0,0 +1,119 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLCharacterMovementComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "LLCharacter.h"
+#include "LLLocomotionSettings.h"
+
+FLLLocomotionSnapshot FLLLocomotionSnapshot::Capture(const ACharacter* Character)
+{
+	FLLLocomotionSnapshot Snapshot;
+	Snapshot.Location = Character->GetActorLocation();
+	Snapshot.Rotation = Character->GetActorRotation();
+	Snapshot.Velocity = Character->GetVelocity();
+
+	if (const UCharacterMovementComponent* MoveComponent = Character->GetCharacterMovement())
+	{
+		Snapshot.Acceleration = MoveComponent->GetCurrentAcceleration();
+		Snapshot.LastUpdateVelocity = MoveComponent->GetLastUpdateVelocity();
+		Snapshot.GroundFriction = MoveComponent->GroundFriction;
+		Snapshot.BrakingFriction = MoveComponent->BrakingFriction;
+		Snapshot.BrakingFrictionFactor = MoveComponent->BrakingFrictionFactor;
+		Snapshot.BrakingDecelerationWalking = MoveComponent->BrakingDecelerationWalking;
+		Snapshot.GravityZ = MoveComponent->GetGravityZ();
+		Snapshot.MovementMode = MoveComponent->MovementMode;
+		Snapshot.bUseSeparateBrakingFriction = MoveComponent->bUseSeparateBrakingFriction;
+		Snapshot.bIsMovingOnGround = MoveComponent->IsMovingOnGround();
+	}
+
+	if (const USkeletalMeshComponent* Mesh = Character->GetMesh())
+	{
+		if (const UAnimInstance* AnimInstance = Mesh->GetAnimInstance())
+		{
+			Snapshot.bIsAnyMontagePlaying = AnimInstance->IsAnyMontagePlaying();
+		}
+	}
+
+	return Snapshot;
+}
+
+bool FLLLocomotionSnapshot::HasMotionSince(const FLLLocomotionSnapshot& PrevSnapshot) const
+{
+	return !Velocity.IsNearlyZero() || !Acceleration.IsNearlyZero() || bIsAnyMontagePlaying || MovementMode != PrevSnapshot.MovementMode ||
+		!Location.Equals(PrevSnapshot.Location) || !Rotation.Equals(PrevSnapshot.Rotation);
+}
+
+void ULLCharacterMovementComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	bPipelineLocomotionUpdate = GetDefault<ULLLocomotionSettings>()->bPipelineLocomotionUpdate;
+	if (bPipelineLocomotionUpdate)
+	{
+		WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &ULLCharacterMovementComponent::OnWorldTickStart);
+	}
+}
+
+void ULLCharacterMovementComponent::UninitializeComponent()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	WorldTickStartHandle.Reset();
+
+	Super::UninitializeComponent();
+}
+
+void ULLCharacterMovementComponent::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	// Last frame's anim tasks are done and nothing of this frame ticked yet, so every mesh of the frame reads the same snapshot.
+	if (World == GetWorld())
+	{
+		LocomotionSnapshot.Publish();
+	}
+}
+
+void ULLCharacterMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Simulated proxies don't go through PerformMovement.
+	if (CharacterOwner)
+	{
+		UpdateLocomotionSnapshot();
+	}
+}
+
+void ULLCharacterMovementComponent::PerformMovement(float DeltaTime)
+{
+	Super::PerformMovement(DeltaTime);
+
+	// Server moves of remote clients run outside of TickComponent.
+	if (CharacterOwner)
+	{
+		UpdateLocomotionSnapshot();
+	}
+}
+
+void ULLCharacterMovementComponent::UpdateLocomotionSnapshot()
+{
+	FLLLocomotionSnapshot& Snapshot = LocomotionSnapshot.GetPending();
+	Snapshot = FLLLocomotionSnapshot::Capture(CharacterOwner);
+	const bool bHasMotion = Snapshot.HasMotionSince(LocomotionSnapshot.GetPublished());
+
+	if (!bPipelineLocomotionUpdate)
+	{
+		LocomotionSnapshot.Publish();
+	}
+
+	// A dormant anim instance doesn't read the snapshot, so the movement has to wake it up.
+	if (bHasMotion)
+	{
+		if (ALLCharacter* LocomotionCharacter = Cast<ALLCharacter>(CharacterOwner))
+		{
+			LocomotionCharacter->WakeLocomotion();
+		}
+	}
+}
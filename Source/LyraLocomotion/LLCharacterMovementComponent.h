@@ -0,0 +1,61 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "LLPipelinedValue.h"
+#include "LLCharacterMovementComponent.generated.h"
+
+// Everything the locomotion anim instance reads from its owner, captured in one place.
+struct FLLLocomotionSnapshot
+{
+	FVector Location { 0 };
+	FVector Velocity { 0 };
+	FVector Acceleration { 0 };
+	FVector LastUpdateVelocity { 0 };
+	FRotator Rotation { 0 };
+	float GroundFriction = 0;
+	float BrakingFriction = 0;
+	float BrakingFrictionFactor = 0;
+	float BrakingDecelerationWalking = 0;
+	float GravityZ = 0;
+	TEnumAsByte<EMovementMode> MovementMode = MOVE_None;
+	uint8 bUseSeparateBrakingFriction : 1 = false;
+	uint8 bIsMovingOnGround : 1 = false;
+	uint8 bIsAnyMontagePlaying : 1 = false;
+
+	static FLLLocomotionSnapshot Capture(const ACharacter* Character);
+
+	// Anything a fully idle character would have to animate, compared to the previous snapshot
+	bool HasMotionSince(const FLLLocomotionSnapshot& PrevSnapshot) const;
+};
+
+static_assert(std::is_trivially_copyable_v<FLLLocomotionSnapshot>, "FLLLocomotionSnapshot is copied as a block and must stay POD");
+
+UCLASS()
+class LYRALOCOMOTION_API ULLCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitializeComponent() override;
+	virtual void UninitializeComponent() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Published on the game thread at the end of each movement update, which precedes the owner's mesh tick.
+	// With bPipelineLocomotionUpdate, published at the start of the next frame instead, so the mesh doesn't have to wait
+	// and always reads the movement of the previous frame. Game thread only, anim workers read the copy of their instance.
+	const FLLLocomotionSnapshot& GetLocomotionSnapshot() const { return LocomotionSnapshot.GetPublished(); }
+
+protected:
+	virtual void PerformMovement(float DeltaTime) override;
+
+private:
+	void UpdateLocomotionSnapshot();
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	TLLPipelinedValue<FLLLocomotionSnapshot> LocomotionSnapshot;
+	FDelegateHandle WorldTickStartHandle;
+	bool bPipelineLocomotionUpdate = false;
+};
@@ -0,0 +1,295 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLDistanceMatching.h"
+#include "AnimationRuntime.h"
+#include "Animation/AnimExecutionContext.h"
+#include "Animation/AnimNode_SequencePlayer.h"
+#include "Animation/AnimSequence.h"
+#include "AnimNodes/AnimNode_SequenceEvaluator.h"
+#include "SequenceEvaluatorLibrary.h"
+#include "SequencePlayerLibrary.h"
+#include "LLLocomotionProfiler.h"
+
+FRWLock FLLDistanceMatching::Lock;
+TMap<TPair<TObjectKey<UAnimSequenceBase>, FName>, TUniquePtr<FLLDistanceCurveTable>> FLLDistanceMatching::Tables;
+TMap<TObjectKey<UAnimSequence>, float> FLLDistanceMatching::RootMotionSpeeds;
+
+FLLDistanceCurveTable::FLLDistanceCurveTable(const UAnimSequenceBase* Sequence, FName CurveName)
+{
+	const float Length = Sequence->GetPlayLength();
+	const int32 NumSamples = FMath::Clamp(FMath::CeilToInt32(Length * SampleRate) + 1, 2, MaxSamples);
+	TimeStep = Length / (NumSamples - 1);
+	InvTimeStep = TimeStep > 0 ? 1.0f / TimeStep : 0;
+
+	DistanceAtTime.SetNumUninitialized(NumSamples);
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		const float Distance = Sequence->EvaluateCurveData(CurveName, Index * TimeStep);
+		DistanceAtTime[Index] = Index > 0 ? FMath::Max(Distance, DistanceAtTime[Index - 1]) : Distance;
+	}
+	MinDistance = DistanceAtTime[0];
+	MaxDistance = DistanceAtTime.Last();
+
+	// Invert on a grid twice as fine, picking the earliest time that reaches each distance like the curve search does.
+	const int32 NumDistanceSamples = NumSamples * 2;
+	const float DistanceStep = GetDistanceRange() / (NumDistanceSamples - 1);
+	InvDistanceStep = DistanceStep > UE_KINDA_SMALL_NUMBER ? 1.0f / DistanceStep : 0;
+
+	TimeAtDistance.SetNumUninitialized(NumDistanceSamples);
+	int32 TimeIndex = 0;
+	for (int32 Index = 0; Index < NumDistanceSamples; ++Index)
+	{
+		const float Distance = MinDistance + Index * DistanceStep;
+		while (TimeIndex < NumSamples - 2 && DistanceAtTime[TimeIndex + 1] < Distance)
+		{
+			++TimeIndex;
+		}
+
+		const float DistanceA = DistanceAtTime[TimeIndex];
+		const float DistanceB = DistanceAtTime[TimeIndex + 1];
+		const float Alpha = !FMath::IsNearlyZero(DistanceB - DistanceA) ? FMath::Clamp((Distance - DistanceA) / (DistanceB - DistanceA), 0.0f, 1.0f) : 0;
+		TimeAtDistance[Index] = (TimeIndex + Alpha) * TimeStep;
+	}
+}
+
+float FLLDistanceCurveTable::GetDistance(float Time) const
+{
+	const float Position = FMath::Clamp(Time * InvTimeStep, 0.0f, static_cast<float>(DistanceAtTime.Num() - 1));
+	const int32 Index = FMath::Min(FMath::FloorToInt32(Position), DistanceAtTime.Num() - 2);
+	return FMath::Lerp(DistanceAtTime[Index], DistanceAtTime[Index + 1], Position - Index);
+}
+
+float FLLDistanceCurveTable::GetTime(float Distance) const
+{
+	const float Position = FMath::Clamp((Distance - MinDistance) * InvDistanceStep, 0.0f, static_cast<float>(TimeAtDistance.Num() - 1));
+	const int32 Index = FMath::Min(FMath::FloorToInt32(Position), TimeAtDistance.Num() - 2);
+	return FMath::Lerp(TimeAtDistance[Index], TimeAtDistance[Index + 1], Position - Index);
+}
+
+float FLLDistanceCurveTable::GetTimeAfterDistanceTraveled(float CurrentTime, float DistanceTraveled, bool bAllowLooping) const
+{
+	const float DistanceRange = GetDistanceRange();
+	if (FMath::IsNearlyZero(DistanceRange))
+	{
+		return CurrentTime;
+	}
+
+	const float TargetDistance = GetDistance(CurrentTime) + DistanceTraveled;
+	if (!bAllowLooping)
+	{
+		return GetTime(TargetDistance);
+	}
+
+	return GetTime(TargetDistance - FMath::FloorToFloat((TargetDistance - MinDistance) / DistanceRange) * DistanceRange);
+}
+
+FArchive& operator<<(FArchive& Ar, FLLDistanceCurveTable& Table)
+{
+	Ar << Table.InvTimeStep;
+	Ar << Table.TimeStep;
+	Ar << Table.MinDistance;
+	Ar << Table.MaxDistance;
+	Ar << Table.InvDistanceStep;
+	Ar << Table.DistanceAtTime;
+	Ar << Table.TimeAtDistance;
+	return Ar;
+}
+
+const FLLDistanceCurveTable* FLLDistanceMatching::FindOrBuildTable(const UAnimSequenceBase* Sequence, FName CurveName)
+{
+	if (!Sequence)
+	{
+		return nullptr;
+	}
+
+	const TPair<TObjectKey<UAnimSequenceBase>, FName> Key(Sequence, CurveName);
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const TUniquePtr<FLLDistanceCurveTable>* Table = Tables.Find(Key))
+		{
+			return Table->Get();
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	TUniquePtr<FLLDistanceCurveTable>* Table = Tables.Find(Key);
+	if (!Table)
+	{
+		// Sequences without the curve are remembered as well so they aren't looked up again.
+		Table = &Tables.Add(Key, Sequence->HasCurveData(CurveName) ? MakeUnique<FLLDistanceCurveTable>(Sequence, CurveName) : nullptr);
+	}
+	return Table->Get();
+}
+
+float FLLDistanceMatching::FindOrBuildRootMotionSpeed(const UAnimSequence* Sequence)
+{
+	if (!Sequence)
+	{
+		return 0;
+	}
+
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const float* Speed = RootMotionSpeeds.Find(Sequence))
+		{
+			return *Speed;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const float* Speed = RootMotionSpeeds.Find(Sequence))
+	{
+		return *Speed;
+	}
+
+	return RootMotionSpeeds.Add(Sequence, ComputeRootMotionSpeed(Sequence));
+}
+
+float FLLDistanceMatching::ComputeRootMotionSpeed(const UAnimSequence* Sequence)
+{
+	const float Length = Sequence->GetPlayLength();
+	const float Distance = !FMath::IsNearlyZero(Length) ? Sequence->ExtractRootMotionFromRange(0, Length).GetTranslation().Size2D() : 0;
+	return !FMath::IsNearlyZero(Distance) ? Distance / Length : 0;
+}
+
+void FLLDistanceMatching::AddBakedTable(const UAnimSequenceBase* Sequence, FName CurveName, const FLLDistanceCurveTable& Table)
+{
+	FWriteScopeLock WriteLock(Lock);
+	TUniquePtr<FLLDistanceCurveTable>& Entry = Tables.FindOrAdd(TPair<TObjectKey<UAnimSequenceBase>, FName>(Sequence, CurveName));
+	if (!Entry)
+	{
+		Entry = MakeUnique<FLLDistanceCurveTable>(Table);
+	}
+}
+
+void FLLDistanceMatching::AddBakedRootMotionSpeed(const UAnimSequence* Sequence, float Speed)
+{
+	FWriteScopeLock WriteLock(Lock);
+	RootMotionSpeeds.FindOrAdd(Sequence, Speed);
+}
+
+void FLLDistanceMatching::DistanceMatchToTarget(const FSequenceEvaluatorReference& SequenceEvaluator, float DistanceToTarget, FName CurveName)
+{
+	SequenceEvaluator.CallAnimNodeFunction<FAnimNode_SequenceEvaluator>(TEXT("DistanceMatchToTarget"),
+		[DistanceToTarget, CurveName](FAnimNode_SequenceEvaluator& InSequenceEvaluator)
+		{
+			DistanceMatchToTarget(InSequenceEvaluator, DistanceToTarget, CurveName);
+		});
+}
+
+void FLLDistanceMatching::AdvanceTimeByDistanceMatching(const FAnimUpdateContext& UpdateContext, const FSequenceEvaluatorReference& SequenceEvaluator,
+	float DistanceTraveled, FName CurveName, FVector2D PlayRateClamp)
+{
+	const FAnimationUpdateContext* AnimationUpdateContext = UpdateContext.GetContext();
+	if (!AnimationUpdateContext)
+	{
+		return;
+	}
+
+	SequenceEvaluator.CallAnimNodeFunction<FAnimNode_SequenceEvaluator>(TEXT("AdvanceTimeByDistanceMatching"),
+		[AnimationUpdateContext, DistanceTraveled, CurveName, PlayRateClamp](FAnimNode_SequenceEvaluator& InSequenceEvaluator)
+		{
+			AdvanceTimeByDistanceMatching(*AnimationUpdateContext, InSequenceEvaluator, DistanceTraveled, CurveName, PlayRateClamp);
+		});
+}
+
+void FLLDistanceMatching::SetPlayrateToMatchSpeed(const FSequencePlayerReference& SequencePlayer, float SpeedToMatch, FVector2D PlayRateClamp)
+{
+	SequencePlayer.CallAnimNodeFunction<FAnimNode_SequencePlayer>(TEXT("SetPlayrateToMatchSpeed"),
+		[SpeedToMatch, PlayRateClamp](FAnimNode_SequencePlayer& InSequencePlayer)
+		{
+			SetPlayrateToMatchSpeed(InSequencePlayer, SpeedToMatch, PlayRateClamp);
+		});
+}
+
+void FLLDistanceMatching::DistanceMatchToTarget(FAnimNode_SequenceEvaluator& SequenceEvaluator, float DistanceToTarget, FName CurveName)
+{
+	float Time = SequenceEvaluator.GetExplicitTime();
+	if (DistanceMatchToTarget(SequenceEvaluator.GetSequence(), DistanceToTarget, CurveName, Time))
+	{
+		ensure(SequenceEvaluator.SetExplicitTime(Time));
+	}
+}
+
+void FLLDistanceMatching::AdvanceTimeByDistanceMatching(const FAnimationUpdateContext& UpdateContext, FAnimNode_SequenceEvaluator& SequenceEvaluator,
+	float DistanceTraveled, FName CurveName, FVector2D PlayRateClamp)
+{
+	float Time = SequenceEvaluator.GetExplicitTime();
+	if (AdvanceTimeByDistanceMatching(SequenceEvaluator.GetSequence(), SequenceEvaluator.GetCurrentAssetLength(), SequenceEvaluator.GetShouldLoop(),
+		UpdateContext.GetDeltaTime(), DistanceTraveled, CurveName, PlayRateClamp, Time))
+	{
+		ensure(SequenceEvaluator.SetExplicitTime(Time));
+	}
+}
+
+void FLLDistanceMatching::SetPlayrateToMatchSpeed(FAnimNode_SequencePlayer& SequencePlayer, float SpeedToMatch, FVector2D PlayRateClamp)
+{
+	float PlayRate = SequencePlayer.GetPlayRate();
+	if (GetPlayRateToMatchSpeed(Cast<UAnimSequence>(SequencePlayer.GetSequence()), SpeedToMatch, PlayRateClamp, PlayRate))
+	{
+		ensure(SequencePlayer.SetPlayRate(PlayRate));
+	}
+}
+
+bool FLLDistanceMatching::DistanceMatchToTarget(const UAnimSequenceBase* Sequence, float DistanceToTarget, FName CurveName, float& InOutTime)
+{
+	LL_INC_COUNTER(DistanceMatchCalls);
+
+	if (const FLLDistanceCurveTable* Table = FindOrBuildTable(Sequence, CurveName))
+	{
+		// By convention, distance curves store the distance to the target as a negative value.
+		InOutTime = Table->GetTime(-DistanceToTarget);
+		return true;
+	}
+	return false;
+}
+
+bool FLLDistanceMatching::AdvanceTimeByDistanceMatching(const UAnimSequenceBase* Sequence, float AssetLength, bool bAllowLooping,
+	float DeltaTime, float DistanceTraveled, FName CurveName, FVector2D PlayRateClamp, float& InOutTime)
+{
+	LL_INC_COUNTER(DistanceMatchCalls);
+
+	if (DeltaTime <= 0 || DistanceTraveled <= 0)
+	{
+		return false;
+	}
+
+	const FLLDistanceCurveTable* Table = FindOrBuildTable(Sequence, CurveName);
+	if (!Table)
+	{
+		return false;
+	}
+
+	const float CurrentTime = InOutTime;
+	float TimeAfterDistanceTraveled = Table->GetTimeAfterDistanceTraveled(CurrentTime, DistanceTraveled, bAllowLooping);
+	if (TimeAfterDistanceTraveled < CurrentTime)
+	{
+		TimeAfterDistanceTraveled += AssetLength;
+	}
+
+	float EffectivePlayRate = (TimeAfterDistanceTraveled - CurrentTime) / DeltaTime;
+	if (PlayRateClamp.X >= 0 && PlayRateClamp.X < PlayRateClamp.Y)
+	{
+		EffectivePlayRate = FMath::Clamp(EffectivePlayRate, PlayRateClamp.X, PlayRateClamp.Y);
+	}
+
+	FAnimationRuntime::AdvanceTime(bAllowLooping, EffectivePlayRate * DeltaTime, InOutTime, AssetLength);
+	return true;
+}
+
+bool FLLDistanceMatching::GetPlayRateToMatchSpeed(const UAnimSequence* Sequence, float SpeedToMatch, FVector2D PlayRateClamp, float& OutPlayRate)
+{
+	const float AnimationSpeed = FindOrBuildRootMotionSpeed(Sequence);
+	if (AnimationSpeed <= 0)
+	{
+		return false;
+	}
+
+	OutPlayRate = SpeedToMatch / AnimationSpeed;
+	if (PlayRateClamp.X >= 0 && PlayRateClamp.X < PlayRateClamp.Y)
+	{
+		OutPlayRate = FMath::Clamp(OutPlayRate, PlayRateClamp.X, PlayRateClamp.Y);
+	}
+	return true;
+}
@@ -0,0 +1,81 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UAnimSequence;
+class UAnimSequenceBase;
+struct FAnimNode_SequenceEvaluator;
+struct FAnimNode_SequencePlayer;
+struct FAnimUpdateContext;
+struct FAnimationUpdateContext;
+struct FSequenceEvaluatorReference;
+struct FSequencePlayerReference;
+
+// Distance curve of one sequence resampled on uniform time and distance grids, so both directions of the lookup are O(1).
+// The curve is made monotonic while sampling, which distance matching assumes anyway.
+struct FLLDistanceCurveTable
+{
+	static constexpr float SampleRate = 60.0f;
+	static constexpr int32 MaxSamples = 4096;
+
+	FLLDistanceCurveTable() = default;
+	FLLDistanceCurveTable(const UAnimSequenceBase* Sequence, FName CurveName);
+
+	float GetDistance(float Time) const;
+	float GetTime(float Distance) const;
+	float GetDistanceRange() const { return MaxDistance - MinDistance; }
+	float GetTimeAfterDistanceTraveled(float CurrentTime, float DistanceTraveled, bool bAllowLooping) const;
+
+	friend FArchive& operator<<(FArchive& Ar, FLLDistanceCurveTable& Table);
+
+private:
+	float InvTimeStep = 0;
+	float TimeStep = 0;
+	float MinDistance = 0;
+	float MaxDistance = 0;
+	float InvDistanceStep = 0;
+	TArray<float> DistanceAtTime;
+	TArray<float> TimeAtDistance;
+};
+
+// Drop-in replacements of UAnimDistanceMatchingLibrary functions that read from tables built once per sequence and curve
+// instead of searching the curve on every update. Tables are shared by all anim instances and safe to use from worker threads.
+class LYRALOCOMOTION_API FLLDistanceMatching
+{
+public:
+	// Builds the table if needed, nullptr when the sequence has no such curve
+	static const FLLDistanceCurveTable* FindOrBuildTable(const UAnimSequenceBase* Sequence, FName CurveName);
+
+	// Root motion distance of the whole sequence over its length, 0 when it has no root motion
+	static float FindOrBuildRootMotionSpeed(const UAnimSequence* Sequence);
+	static float ComputeRootMotionSpeed(const UAnimSequence* Sequence);
+
+	// Data baked on cook by ULLLocomotionAnimSet, used instead of building it from the curves
+	static void AddBakedTable(const UAnimSequenceBase* Sequence, FName CurveName, const FLLDistanceCurveTable& Table);
+	static void AddBakedRootMotionSpeed(const UAnimSequence* Sequence, float Speed);
+
+	static void DistanceMatchToTarget(const FSequenceEvaluatorReference& SequenceEvaluator, float DistanceToTarget, FName CurveName);
+	static void AdvanceTimeByDistanceMatching(const FAnimUpdateContext& UpdateContext, const FSequenceEvaluatorReference& SequenceEvaluator,
+		float DistanceTraveled, FName CurveName, FVector2D PlayRateClamp);
+	static void SetPlayrateToMatchSpeed(const FSequencePlayerReference& SequencePlayer, float SpeedToMatch, FVector2D PlayRateClamp);
+
+	// Same as above on already resolved nodes
+	static void DistanceMatchToTarget(FAnimNode_SequenceEvaluator& SequenceEvaluator, float DistanceToTarget, FName CurveName);
+	static void AdvanceTimeByDistanceMatching(const FAnimationUpdateContext& UpdateContext, FAnimNode_SequenceEvaluator& SequenceEvaluator,
+		float DistanceTraveled, FName CurveName, FVector2D PlayRateClamp);
+	static void SetPlayrateToMatchSpeed(FAnimNode_SequencePlayer& SequencePlayer, float SpeedToMatch, FVector2D PlayRateClamp);
+
+	// Same as above on a sequence and playback time, for playback outside of an anim graph. False leaves the time or play rate as is.
+	static bool DistanceMatchToTarget(const UAnimSequenceBase* Sequence, float DistanceToTarget, FName CurveName, float& InOutTime);
+	static bool AdvanceTimeByDistanceMatching(const UAnimSequenceBase* Sequence, float AssetLength, bool bAllowLooping,
+		float DeltaTime, float DistanceTraveled, FName CurveName, FVector2D PlayRateClamp, float& InOutTime);
+	static bool GetPlayRateToMatchSpeed(const UAnimSequence* Sequence, float SpeedToMatch, FVector2D PlayRateClamp, float& OutPlayRate);
+
+private:
+	static FRWLock Lock;
+	static TMap<TPair<TObjectKey<UAnimSequenceBase>, FName>, TUniquePtr<FLLDistanceCurveTable>> Tables;
+	static TMap<TObjectKey<UAnimSequence>, float> RootMotionSpeeds;
+};
@@ -0,0 +1,174 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLLocomotionAnimSet.h"
+#include "Animation/AnimSequence.h"
+#include "Serialization/CustomVersion.h"
+#include "UObject/ObjectSaveContext.h"
+
+namespace
+{
+	// Native data ULLLocomotionAnimSet::Serialize writes after its properties
+	struct FLLLocomotionAnimSetVersion
+	{
+		enum Type
+		{
+			BeforeCustomVersionWasAdded = 0,
+			// Distance tables and root motion speeds baked on cook
+			BakedData,
+
+			VersionPlusOne,
+			LatestVersion = VersionPlusOne - 1
+		};
+
+		static const FGuid GUID;
+	};
+
+	const FGuid FLLLocomotionAnimSetVersion::GUID(0xEBA39C21, 0xBABD41B7, 0xBBA7127B, 0x2E8C85D0);
+	FCustomVersionRegistration GRegisterLLLocomotionAnimSetVersion(FLLLocomotionAnimSetVersion::GUID, FLLLocomotionAnimSetVersion::LatestVersion, TEXT("LLLocomotionAnimSetVer"));
+
+	void AddPath(const TSoftObjectPtr<UAnimSequence>& Sequence, TArray<FSoftObjectPath>& OutPaths)
+	{
+		if (!Sequence.IsNull())
+		{
+			OutPaths.Add(Sequence.ToSoftObjectPath());
+		}
+	}
+
+	void AddPaths(const FLLSoftCardinalDirections& Cardinals, TArray<FSoftObjectPath>& OutPaths)
+	{
+		for (const TSoftObjectPtr<UAnimSequence>* Sequence : Cardinals.GetAll())
+		{
+			AddPath(*Sequence, OutPaths);
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FLLBakedDistanceTable& Baked)
+{
+	Ar << Baked.Sequence;
+	Ar << Baked.CurveName;
+	Ar << Baked.Table;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FLLBakedRootMotionSpeed& Baked)
+{
+	Ar << Baked.Sequence;
+	Ar << Baked.Speed;
+	return Ar;
+}
+
+void ULLLocomotionAnimSet::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Packages saved before the baked data have nothing after the properties
+	Ar.UsingCustomVersion(FLLLocomotionAnimSetVersion::GUID);
+	if (Ar.CustomVer(FLLLocomotionAnimSetVersion::GUID) >= FLLLocomotionAnimSetVersion::BakedData)
+	{
+		Ar << BakedDistanceTables;
+		Ar << BakedRootMotionSpeeds;
+	}
+}
+
+#if WITH_EDITOR
+void ULLLocomotionAnimSet::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	// Only cooked data carries baked data, editor builds keep building it from the curves as they are edited.
+	if (SaveContext.IsCooking())
+	{
+		BakeDerivedData();
+	}
+	else
+	{
+		BakedDistanceTables.Reset();
+		BakedRootMotionSpeeds.Reset();
+	}
+}
+
+void ULLLocomotionAnimSet::BakeDerivedData()
+{
+	BakedDistanceTables.Reset();
+	BakedRootMotionSpeeds.Reset();
+
+	auto BakeDistanceTable = [this](const TSoftObjectPtr<UAnimSequence>& SoftSequence, FName CurveName)
+	{
+		const UAnimSequence* Sequence = SoftSequence.LoadSynchronous();
+		if (Sequence && Sequence->HasCurveData(CurveName))
+		{
+			BakedDistanceTables.Add({ SoftSequence.ToSoftObjectPath(), CurveName, FLLDistanceCurveTable(Sequence, CurveName) });
+		}
+	};
+
+	for (const FLLSoftCardinalDirections* Cardinals : { &JogStartCardinals, &JogStopCardinals, &JogPivotCardinals })
+	{
+		for (const TSoftObjectPtr<UAnimSequence>* Sequence : Cardinals->GetAll())
+		{
+			BakeDistanceTable(*Sequence, LocomotionDistanceCurveName);
+		}
+	}
+	BakeDistanceTable(JumpFallLand, JumpDistanceCurveName);
+
+	for (const TSoftObjectPtr<UAnimSequence>* SoftSequence : JogCardinals.GetAll())
+	{
+		if (const UAnimSequence* Sequence = SoftSequence->LoadSynchronous())
+		{
+			BakedRootMotionSpeeds.Add({ SoftSequence->ToSoftObjectPath(), FLLDistanceMatching::ComputeRootMotionSpeed(Sequence) });
+		}
+	}
+}
+#endif
+
+void ULLLocomotionAnimSet::RegisterBakedData() const
+{
+	for (const FLLBakedDistanceTable& Baked : BakedDistanceTables)
+	{
+		if (const UAnimSequenceBase* Sequence = Cast<UAnimSequenceBase>(Baked.Sequence.ResolveObject()))
+		{
+			FLLDistanceMatching::AddBakedTable(Sequence, Baked.CurveName, Baked.Table);
+		}
+	}
+
+	for (const FLLBakedRootMotionSpeed& Baked : BakedRootMotionSpeeds)
+	{
+		if (const UAnimSequence* Sequence = Cast<UAnimSequence>(Baked.Sequence.ResolveObject()))
+		{
+			FLLDistanceMatching::AddBakedRootMotionSpeed(Sequence, Baked.Speed);
+		}
+	}
+}
+
+void ULLLocomotionAnimSet::GetSequencesToStream(ELLAnimSetGroup Group, TArray<FSoftObjectPath>& OutPaths) const
+{
+	switch (Group)
+	{
+	case ELLAnimSetGroup::Core:
+		AddPath(IdleAnimSequence, OutPaths);
+		AddPaths(JogCardinals, OutPaths);
+		break;
+	case ELLAnimSetGroup::Transitions:
+		AddPaths(JogStartCardinals, OutPaths);
+		AddPaths(JogStopCardinals, OutPaths);
+		AddPaths(JogPivotCardinals, OutPaths);
+		AddPath(TurnInPlaceLeftAnimSequence, OutPaths);
+		AddPath(TurnInPlaceRightAnimSequence, OutPaths);
+		break;
+	case ELLAnimSetGroup::IdleBreaks:
+		for (const TSoftObjectPtr<UAnimSequence>& Sequence : IdleBreakAnimSequences)
+		{
+			AddPath(Sequence, OutPaths);
+		}
+		break;
+	case ELLAnimSetGroup::Jump:
+		for (const TSoftObjectPtr<UAnimSequence>* Sequence : { &JumpStart, &JumpStartLoop, &JumpApex, &JumpFallLand, &JumpFallLoop, &JumpRecoveryAdditive })
+		{
+			AddPath(*Sequence, OutPaths);
+		}
+		break;
+	default:
+		break;
+	}
+}
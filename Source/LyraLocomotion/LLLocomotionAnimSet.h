@@ -0,0 +1,155 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "LLDistanceMatching.h"
+#include "LLLocomotionAnimSet.generated.h"
+
+class UAnimSequence;
+
+// Sequences of an anim set streamed in together, in the order ULLAnimInstance requests them
+enum class ELLAnimSetGroup : uint8
+{
+	// Idle and cycles, requested first with high priority
+	Core,
+	// Starts, stops, pivots and turn in place, requested once the core group arrived
+	Transitions,
+	// Requested when the character can play an idle break
+	IdleBreaks,
+	// Requested when the character leaves the ground
+	Jump,
+	Num
+};
+
+USTRUCT(BlueprintType)
+struct FLLSoftCardinalDirections
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> Forward;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> Backward;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> Left;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> Right;
+
+	// Diagonals of an 8-way set, see FCardinalDirections
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> ForwardRight;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> BackwardRight;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> BackwardLeft;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	TSoftObjectPtr<UAnimSequence> ForwardLeft;
+
+	TArray<const TSoftObjectPtr<UAnimSequence>*, TFixedAllocator<8>> GetAll() const
+	{
+		return { &Forward, &Backward, &Left, &Right, &ForwardRight, &BackwardRight, &BackwardLeft, &ForwardLeft };
+	}
+};
+
+// Distance matching data of one sequence, baked on cook
+struct FLLBakedDistanceTable
+{
+	FSoftObjectPath Sequence;
+	FName CurveName;
+	FLLDistanceCurveTable Table;
+
+	friend FArchive& operator<<(FArchive& Ar, FLLBakedDistanceTable& Baked);
+};
+
+struct FLLBakedRootMotionSpeed
+{
+	FSoftObjectPath Sequence;
+	float Speed = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FLLBakedRootMotionSpeed& Baked);
+};
+
+// Locomotion sequences of one weapon or archetype, soft referenced so ULLAnimInstance can stream them in as the character
+// is likely to need them. Sequences left empty keep the ones set on the anim instance.
+// Cooking bakes the distance matching tables and root motion speeds of the sequences, which then don't have to be built from curves at runtime.
+UCLASS(BlueprintType)
+class LYRALOCOMOTION_API ULLLocomotionAnimSet : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Serialize(FArchive& Ar) override;
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#endif
+
+	void GetSequencesToStream(ELLAnimSetGroup Group, TArray<FSoftObjectPath>& OutPaths) const;
+
+	// Hands the baked data of the sequences loaded so far to FLLDistanceMatching
+	void RegisterBakedData() const;
+
+	// Curves the distance matching tables are baked for, the same as on the anim instance
+	UPROPERTY(EditDefaultsOnly, Category = "Baked Data")
+	FName LocomotionDistanceCurveName = TEXT("Distance");
+
+	UPROPERTY(EditDefaultsOnly, Category = "Baked Data")
+	FName JumpDistanceCurveName = TEXT("GroundDistance");
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Idle")
+	TSoftObjectPtr<UAnimSequence> IdleAnimSequence;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Idle")
+	TArray<TSoftObjectPtr<UAnimSequence>> IdleBreakAnimSequences;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Turn in Place")
+	TSoftObjectPtr<UAnimSequence> TurnInPlaceLeftAnimSequence;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Turn in Place")
+	TSoftObjectPtr<UAnimSequence> TurnInPlaceRightAnimSequence;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Starts")
+	FLLSoftCardinalDirections JogStartCardinals;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jog")
+	FLLSoftCardinalDirections JogCardinals;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Stops")
+	FLLSoftCardinalDirections JogStopCardinals;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Pivots")
+	FLLSoftCardinalDirections JogPivotCardinals;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
+	TSoftObjectPtr<UAnimSequence> JumpStart;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
+	TSoftObjectPtr<UAnimSequence> JumpStartLoop;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
+	TSoftObjectPtr<UAnimSequence> JumpApex;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
+	TSoftObjectPtr<UAnimSequence> JumpFallLand;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
+	TSoftObjectPtr<UAnimSequence> JumpFallLoop;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
+	TSoftObjectPtr<UAnimSequence> JumpRecoveryAdditive;
+
+private:
+#if WITH_EDITOR
+	void BakeDerivedData();
+#endif
+
+	TArray<FLLBakedDistanceTable> BakedDistanceTables;
+	TArray<FLLBakedRootMotionSpeed> BakedRootMotionSpeeds;
+};
@@ -0,0 +1,266 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLLocomotionBenchmarkCommandlet.h"
+#include "AIController.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "LLCharacter.h"
+#include "LLLocomotionProfiler.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLLBenchmark, Log, All);
+
+ULLLocomotionBenchmarkCommandlet::ULLLocomotionBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 ULLLocomotionBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<int32> CharacterCounts { 1, 64, 256, 1024 };
+
+	FString CountsParam;
+	if (FParse::Value(*Params, TEXT("Counts="), CountsParam))
+	{
+		TArray<FString> Tokens;
+		CountsParam.ParseIntoArray(Tokens, TEXT(","));
+		CharacterCounts.Reset();
+		for (const FString& Token : Tokens)
+		{
+			CharacterCounts.Add(FMath::Max(FCString::Atoi(*Token), 1));
+		}
+	}
+
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("WarmupFrames="), NumWarmupFrames);
+	NumFrames = FMath::Max(NumFrames, 1);
+	NumWarmupFrames = FMath::Max(NumWarmupFrames, 0);
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("LocomotionBenchmark.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	FString Csv = TEXT("Characters,Metric,P50FrameMs,P99FrameMs,P50CallUs,P99CallUs,MeanCallsPerFrame\n");
+
+	for (const int32 NumCharacters : CharacterCounts)
+	{
+		TArray<FMetricResult> Results;
+		RunScenario(NumCharacters, Results);
+
+		for (int32 MetricIndex = 0; MetricIndex < Results.Num(); ++MetricIndex)
+		{
+			const TCHAR* MetricName = FLLLocomotionProfiler::GetMetricName(static_cast<ELLProfilerMetric>(MetricIndex));
+			const FMetricResult& Result = Results[MetricIndex];
+
+			UE_LOG(LogLLBenchmark, Display, TEXT("%5d characters | %-32s | frame p50 %8.3f ms p99 %8.3f ms | call p50 %8.2f us p99 %8.2f us | %.1f calls/frame"),
+				NumCharacters, MetricName, Result.P50FrameMs, Result.P99FrameMs, Result.P50CallUs, Result.P99CallUs, Result.MeanCallsPerFrame);
+
+			Csv += FString::Printf(TEXT("%d,%s,%.4f,%.4f,%.3f,%.3f,%.2f\n"),
+				NumCharacters, MetricName, Result.P50FrameMs, Result.P99FrameMs, Result.P50CallUs, Result.P99CallUs, Result.MeanCallsPerFrame);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogLLBenchmark, Error, TEXT("Failed to write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogLLBenchmark, Display, TEXT("Wrote %s"), *OutputPath);
+	return 0;
+}
+
+void ULLLocomotionBenchmarkCommandlet::RunScenario(int32 NumCharacters, TArray<FMetricResult>& OutResults) const
+{
+	static constexpr float CharacterSpacing = 300.0f;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("LLLocomotionBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumCharacters)));
+	const float GridExtent = GridSize * CharacterSpacing;
+
+	if (AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(FVector(GridExtent * 0.5f, GridExtent * 0.5f, -50.0f), FRotator::ZeroRotator))
+	{
+		UStaticMeshComponent* FloorComponent = Floor->GetStaticMeshComponent();
+		FloorComponent->SetMobility(EComponentMobility::Movable);
+		FloorComponent->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+		FloorComponent->SetWorldScale3D(FVector((GridExtent + 2000.0f) / 100.0f, (GridExtent + 2000.0f) / 100.0f, 1.0f));
+	}
+
+	TArray<ALLCharacter*> Characters;
+	Characters.Reserve(NumCharacters);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 Index = 0; Index < NumCharacters; ++Index)
+	{
+		const FVector Location((Index % GridSize) * CharacterSpacing, (Index / GridSize) * CharacterSpacing, 100.0f);
+		if (ALLCharacter* Character = World->SpawnActor<ALLCharacter>(Location, FRotator::ZeroRotator, SpawnParams))
+		{
+			Character->GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+
+			AAIController* Controller = World->SpawnActor<AAIController>(SpawnParams);
+			Controller->bSetControlRotationFromPawnOrientation = false;
+			Controller->Possess(Character);
+
+			Characters.Add(Character);
+		}
+	}
+
+	TArray<TArray<double>> FrameMs;
+	TArray<TArray<double>> CallUs;
+	TArray<uint64> TotalCalls;
+	FrameMs.SetNum(static_cast<int32>(ELLProfilerMetric::Count));
+	CallUs.SetNum(static_cast<int32>(ELLProfilerMetric::Count));
+	TotalCalls.SetNumZeroed(static_cast<int32>(ELLProfilerMetric::Count));
+
+	float Time = 0;
+	for (int32 Frame = 0; Frame < NumWarmupFrames + NumFrames; ++Frame)
+	{
+		const bool bMeasure = Frame >= NumWarmupFrames;
+		FLLLocomotionProfiler::SetEnabled(bMeasure);
+
+		for (int32 Index = 0; Index < Characters.Num(); ++Index)
+		{
+			ApplyScriptedInput(Characters[Index], Index, Time, FrameDeltaSeconds);
+		}
+
+		World->Tick(LEVELTICK_All, FrameDeltaSeconds);
+		++GFrameCounter;
+		Time += FrameDeltaSeconds;
+
+		if (bMeasure)
+		{
+			const FLLProfilerFrame Sample = FLLLocomotionProfiler::ConsumeFrame();
+			for (int32 MetricIndex = 0; MetricIndex < FrameMs.Num(); ++MetricIndex)
+			{
+				const double Ms = FPlatformTime::ToMilliseconds64(Sample.Cycles[MetricIndex]);
+				FrameMs[MetricIndex].Add(Ms);
+				if (Sample.Calls[MetricIndex] > 0)
+				{
+					CallUs[MetricIndex].Add(Ms * 1000.0 / Sample.Calls[MetricIndex]);
+				}
+				TotalCalls[MetricIndex] += Sample.Calls[MetricIndex];
+			}
+		}
+	}
+
+	FLLLocomotionProfiler::SetEnabled(false);
+
+	OutResults.SetNum(FrameMs.Num());
+	for (int32 MetricIndex = 0; MetricIndex < FrameMs.Num(); ++MetricIndex)
+	{
+		FMetricResult& Result = OutResults[MetricIndex];
+		Result.P50FrameMs = Percentile(FrameMs[MetricIndex], 0.5);
+		Result.P99FrameMs = Percentile(FrameMs[MetricIndex], 0.99);
+		Result.P50CallUs = Percentile(CallUs[MetricIndex], 0.5);
+		Result.P99CallUs = Percentile(CallUs[MetricIndex], 0.99);
+		Result.MeanCallsPerFrame = static_cast<double>(TotalCalls[MetricIndex]) / NumFrames;
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void ULLLocomotionBenchmarkCommandlet::ApplyScriptedInput(ALLCharacter* Character, int32 Index, float Time, float DeltaSeconds)
+{
+	static constexpr float ScriptPeriod = 8.0f;
+	static constexpr float TurnInPlaceRate = 180.0f;
+
+	AController* Controller = Character->GetController();
+	if (Controller == nullptr)
+	{
+		return;
+	}
+
+	// Offset every character so a crowd covers all locomotion states in the same frame.
+	// The previous phase wraps with the script too, so edges right after the wrap still see where the last frame was.
+	auto GetPhase = [Index](float ScriptTime)
+	{
+		const float Phase = FMath::Fmod(ScriptTime + Index * 0.37f, ScriptPeriod);
+		return Phase < 0 ? Phase + ScriptPeriod : Phase;
+	};
+	const float Phase = GetPhase(Time);
+	const float PrevPhase = GetPhase(Time - DeltaSeconds);
+
+	FRotator ControlRotation = Controller->GetControlRotation();
+	FVector2D MovementVector = FVector2D::ZeroVector;
+
+	if (Phase < 0.5f)
+	{
+		// Idle
+	}
+	else if (Phase < 2.5f)
+	{
+		// Start and cycle forward
+		MovementVector.Y = 1;
+	}
+	else if (Phase < 4.0f)
+	{
+		// Pivot into a backward cycle
+		MovementVector.Y = -1;
+	}
+	else if (Phase < 5.0f)
+	{
+		// Stop
+	}
+	else if (Phase < 6.0f)
+	{
+		// Jump, fall and land
+		if (PrevPhase < 5.0f)
+		{
+			Character->Jump();
+		}
+	}
+	else if (Phase < 6.5f)
+	{
+		// Turn in place
+		ControlRotation.Yaw = FRotator::NormalizeAxis(ControlRotation.Yaw + TurnInPlaceRate * DeltaSeconds);
+		Controller->SetControlRotation(ControlRotation);
+	}
+	else if (Phase < 7.5f)
+	{
+		// Start and cycle to the right
+		MovementVector.X = 1;
+	}
+
+	if (PrevPhase >= 5.0f || Phase < 5.0f)
+	{
+		Character->StopJumping();
+	}
+
+	if (!MovementVector.IsZero())
+	{
+		const FRotator YawRotation(0, ControlRotation.Yaw, 0);
+		Character->AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X), MovementVector.Y);
+		Character->AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y), MovementVector.X);
+	}
+}
+
+double ULLLocomotionBenchmarkCommandlet::Percentile(TArray<double>& Samples, double Ratio)
+{
+	if (Samples.IsEmpty())
+	{
+		return 0;
+	}
+
+	Samples.Sort();
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Ratio * Samples.Num()) - 1, 0, Samples.Num() - 1);
+	return Samples[Index];
+}
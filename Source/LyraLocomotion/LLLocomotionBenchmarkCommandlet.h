@@ -0,0 +1,41 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "LLLocomotionBenchmarkCommandlet.generated.h"
+
+// Spawns crowds of ALLCharacter in a headless world, drives them with scripted locomotion input
+// and reports the per-frame cost of the locomotion layer.
+//
+// UnrealEditor-Cmd LyraLocomotion.uproject -run=LLLocomotionBenchmark -nullrhi -unattended
+//   [-Counts=1,64,256,1024] [-Frames=600] [-WarmupFrames=60] [-Output=<csv path>]
+UCLASS()
+class ULLLocomotionBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULLLocomotionBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FMetricResult
+	{
+		double P50FrameMs = 0;
+		double P99FrameMs = 0;
+		double P50CallUs = 0;
+		double P99CallUs = 0;
+		double MeanCallsPerFrame = 0;
+	};
+
+	void RunScenario(int32 NumCharacters, TArray<FMetricResult>& OutResults) const;
+	static void ApplyScriptedInput(class ALLCharacter* Character, int32 Index, float Time, float DeltaSeconds);
+	static double Percentile(TArray<double>& Samples, double Ratio);
+
+	int32 NumFrames = 600;
+	int32 NumWarmupFrames = 60;
+	float FrameDeltaSeconds = 1.0f / 60.0f;
+};
@@ -0,0 +1,66 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLLocomotionProfiler.h"
+
+#if LL_WITH_LOCOMOTION_PROFILER
+UE_TRACE_CHANNEL_DEFINE(LyraLocomotionChannel);
+
+DEFINE_STAT(STAT_LL_GroundTraces);
+DEFINE_STAT(STAT_LL_SyncGroundTraces);
+DEFINE_STAT(STAT_LL_DistanceMatchCalls);
+DEFINE_STAT(STAT_LL_InertialBlendRequests);
+DEFINE_STAT(STAT_LL_SharedPosesCopied);
+DEFINE_STAT(STAT_LL_IdleInstances);
+DEFINE_STAT(STAT_LL_StartInstances);
+DEFINE_STAT(STAT_LL_CycleInstances);
+DEFINE_STAT(STAT_LL_StopInstances);
+DEFINE_STAT(STAT_LL_PivotInstances);
+DEFINE_STAT(STAT_LL_TurnInPlaceInstances);
+DEFINE_STAT(STAT_LL_FallLandInstances);
+#endif
+
+std::atomic<bool> FLLLocomotionProfiler::bEnabled { false };
+std::atomic<uint64> FLLLocomotionProfiler::Cycles[static_cast<uint8>(ELLProfilerMetric::Count)] = {};
+std::atomic<uint32> FLLLocomotionProfiler::Calls[static_cast<uint8>(ELLProfilerMetric::Count)] = {};
+
+void FLLLocomotionProfiler::SetEnabled(bool bInEnabled)
+{
+	ConsumeFrame();
+	bEnabled.store(bInEnabled, std::memory_order_relaxed);
+}
+
+void FLLLocomotionProfiler::AddSample(ELLProfilerMetric Metric, uint64 InCycles)
+{
+	const uint8 Index = static_cast<uint8>(Metric);
+	Cycles[Index].fetch_add(InCycles, std::memory_order_relaxed);
+	Calls[Index].fetch_add(1, std::memory_order_relaxed);
+}
+
+FLLProfilerFrame FLLLocomotionProfiler::ConsumeFrame()
+{
+	FLLProfilerFrame Frame;
+	for (uint8 Index = 0; Index < static_cast<uint8>(ELLProfilerMetric::Count); ++Index)
+	{
+		Frame.Cycles[Index] = Cycles[Index].exchange(0, std::memory_order_relaxed);
+		Frame.Calls[Index] = Calls[Index].exchange(0, std::memory_order_relaxed);
+	}
+	return Frame;
+}
+
+const TCHAR* FLLLocomotionProfiler::GetMetricName(ELLProfilerMetric Metric)
+{
+	switch (Metric)
+	{
+	case ELLProfilerMetric::NativeUpdateAnimation:
+		return TEXT("NativeUpdateAnimation");
+	case ELLProfilerMetric::NativeThreadSafeUpdateAnimation:
+		return TEXT("NativeThreadSafeUpdateAnimation");
+	case ELLProfilerMetric::GetGroundDistance:
+		return TEXT("GetGroundDistance");
+	case ELLProfilerMetric::LocomotionAnimNode:
+		return TEXT("LocomotionAnimNode");
+	default:
+		return TEXT("Unknown");
+	}
+}
@@ -0,0 +1,108 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+#include <atomic>
+
+#define LL_WITH_LOCOMOTION_PROFILER !UE_BUILD_SHIPPING
+
+enum class ELLProfilerMetric : uint8
+{
+	NativeUpdateAnimation,
+	NativeThreadSafeUpdateAnimation,
+	GetGroundDistance,
+	LocomotionAnimNode,
+	Count
+};
+
+struct FLLProfilerFrame
+{
+	uint64 Cycles[static_cast<uint8>(ELLProfilerMetric::Count)] = {};
+	uint32 Calls[static_cast<uint8>(ELLProfilerMetric::Count)] = {};
+};
+
+// Accumulates the cost of the locomotion layer per frame. Disabled unless a benchmark turns it on,
+// timers are thread safe because NativeThreadSafeUpdateAnimation runs on anim worker threads.
+class LYRALOCOMOTION_API FLLLocomotionProfiler
+{
+public:
+	static void SetEnabled(bool bInEnabled);
+	static bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+
+	static void AddSample(ELLProfilerMetric Metric, uint64 Cycles);
+	static FLLProfilerFrame ConsumeFrame();
+
+	static const TCHAR* GetMetricName(ELLProfilerMetric Metric);
+
+private:
+	static std::atomic<bool> bEnabled;
+	static std::atomic<uint64> Cycles[static_cast<uint8>(ELLProfilerMetric::Count)];
+	static std::atomic<uint32> Calls[static_cast<uint8>(ELLProfilerMetric::Count)];
+};
+
+#if LL_WITH_LOCOMOTION_PROFILER
+
+// Stat group and trace channel of the locomotion layer, "stat LyraLocomotion" in game and -trace=LyraLocomotion for Insights
+DECLARE_STATS_GROUP(TEXT("LyraLocomotion"), STATGROUP_LyraLocomotion, STATCAT_Advanced);
+UE_TRACE_CHANNEL_EXTERN(LyraLocomotionChannel, LYRALOCOMOTION_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ground Traces"), STAT_LL_GroundTraces, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sync Ground Traces"), STAT_LL_SyncGroundTraces, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Distance Match Calls"), STAT_LL_DistanceMatchCalls, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Inertial Blend Requests"), STAT_LL_InertialBlendRequests, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shared Poses Copied"), STAT_LL_SharedPosesCopied, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+
+// Instances per locomotion state, counted by the anim node logic of the state so blending states count in both
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances in Idle"), STAT_LL_IdleInstances, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances in Start"), STAT_LL_StartInstances, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances in Cycle"), STAT_LL_CycleInstances, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances in Stop"), STAT_LL_StopInstances, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances in Pivot"), STAT_LL_PivotInstances, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances in Turn In Place"), STAT_LL_TurnInPlaceInstances, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances in Fall Land"), STAT_LL_FallLandInstances, STATGROUP_LyraLocomotion, LYRALOCOMOTION_API);
+
+// CPU scope in the stat group and on the trace channel
+#define LL_SCOPED_STAT(Name) \
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT(#Name), STAT_LL_##Name, STATGROUP_LyraLocomotion); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, LyraLocomotionChannel)
+
+#define LL_INC_COUNTER(Name) INC_DWORD_STAT(STAT_LL_##Name)
+
+class FLLScopedProfilerTimer
+{
+public:
+	explicit FLLScopedProfilerTimer(ELLProfilerMetric InMetric)
+		: Metric(InMetric)
+		, StartCycles(FLLLocomotionProfiler::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FLLScopedProfilerTimer()
+	{
+		if (StartCycles != 0)
+		{
+			FLLLocomotionProfiler::AddSample(Metric, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	ELLProfilerMetric Metric;
+	uint64 StartCycles;
+};
+
+// Benchmark metric that is also a CPU scope of the stat group and trace channel
+#define LL_SCOPED_PROFILER_TIMER(Metric) \
+	LL_SCOPED_STAT(Metric); \
+	const FLLScopedProfilerTimer ANONYMOUS_VARIABLE(LLProfilerTimer)(ELLProfilerMetric::Metric)
+
+#else
+
+#define LL_SCOPED_STAT(Name)
+#define LL_INC_COUNTER(Name)
+#define LL_SCOPED_PROFILER_TIMER(Metric)
+
+#endif
@@ -0,0 +1,102 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLLocomotionRecorder.h"
+#include "HAL/FileManager.h"
+#include "LLAnimInstance.h"
+#include "LLCharacterMovementComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLLRecorder, Log, All);
+
+TUniquePtr<FLLLocomotionRecorder> FLLLocomotionRecorder::Create(const FString& Path)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer)
+	{
+		UE_LOG(LogLLRecorder, Error, TEXT("Failed to open %s for recording"), *Path);
+		return nullptr;
+	}
+
+	return TUniquePtr<FLLLocomotionRecorder>(new FLLLocomotionRecorder(MoveTemp(Writer), Path));
+}
+
+FLLLocomotionRecorder::FLLLocomotionRecorder(TUniquePtr<FArchive> InWriter, const FString& InPath)
+	: Writer(MoveTemp(InWriter))
+	, Path(InPath)
+	, StartFrame(GFrameCounter)
+{
+	Header.RecordSize = sizeof(LLLocomotionRecording::FLLInputRecord);
+
+	// NumRecords stays 0 until the recording stops, so a recording cut short by a crash reads as empty rather than torn.
+	WriteHeader();
+}
+
+FLLLocomotionRecorder::~FLLLocomotionRecorder()
+{
+	Header.TuningOffset = static_cast<uint64>(Writer->Tell());
+	Writer->Serialize(Tunings.GetData(), Tunings.Num() * sizeof(LLLocomotionMath::FLLKinematicsTuning));
+
+	Writer->Seek(0);
+	WriteHeader();
+	Writer->Close();
+
+	UE_LOG(LogLLRecorder, Display, TEXT("Recorded %llu updates of %u characters over %u frames to %s"),
+		Header.NumRecords, Header.NumCharacters, Header.NumFrames, *Path);
+}
+
+void FLLLocomotionRecorder::WriteHeader()
+{
+	Writer->Serialize(&Header, sizeof(Header));
+}
+
+void FLLLocomotionRecorder::Record(const ULLAnimInstance* AnimInstance, const FLLLocomotionSnapshot& Snapshot, float GroundDistance, float DeltaSeconds,
+	const LLLocomotionMath::FLLKinematicsTuning& Tuning)
+{
+	const uint16* Character = Characters.Find(AnimInstance);
+	if (!Character)
+	{
+		if (Characters.Num() > MAX_uint16)
+		{
+			return;
+		}
+		Character = &Characters.Add(AnimInstance, static_cast<uint16>(Characters.Num()));
+		Tunings.Add(Tuning);
+		Header.NumCharacters = Characters.Num();
+	}
+
+	using namespace LLLocomotionRecording;
+
+	FLLInputRecord Record;
+	Record.Frame = static_cast<uint32>(GFrameCounter - StartFrame);
+	Record.Character = *Character;
+	Record.MovementMode = Snapshot.MovementMode;
+	Record.Flags = (Snapshot.bUseSeparateBrakingFriction ? UseSeparateBrakingFriction : 0) |
+		(Snapshot.bIsMovingOnGround ? MovingOnGround : 0) | (Snapshot.bIsAnyMontagePlaying ? AnyMontagePlaying : 0);
+	Record.DeltaTime = DeltaSeconds;
+	Record.GroundDistance = GroundDistance;
+	Record.LocationX = Snapshot.Location.X;
+	Record.LocationY = Snapshot.Location.Y;
+	Record.LocationZ = Snapshot.Location.Z;
+	Record.VelocityX = Snapshot.Velocity.X;
+	Record.VelocityY = Snapshot.Velocity.Y;
+	Record.VelocityZ = Snapshot.Velocity.Z;
+	Record.AccelerationX = Snapshot.Acceleration.X;
+	Record.AccelerationY = Snapshot.Acceleration.Y;
+	Record.AccelerationZ = Snapshot.Acceleration.Z;
+	Record.LastUpdateVelocityX = Snapshot.LastUpdateVelocity.X;
+	Record.LastUpdateVelocityY = Snapshot.LastUpdateVelocity.Y;
+	Record.LastUpdateVelocityZ = Snapshot.LastUpdateVelocity.Z;
+	Record.Pitch = Snapshot.Rotation.Pitch;
+	Record.Yaw = Snapshot.Rotation.Yaw;
+	Record.Roll = Snapshot.Rotation.Roll;
+	Record.GroundFriction = Snapshot.GroundFriction;
+	Record.BrakingFriction = Snapshot.BrakingFriction;
+	Record.BrakingFrictionFactor = Snapshot.BrakingFrictionFactor;
+	Record.BrakingDecelerationWalking = Snapshot.BrakingDecelerationWalking;
+	Record.GravityZ = Snapshot.GravityZ;
+
+	Writer->Serialize(&Record, sizeof(Record));
+
+	++Header.NumRecords;
+	Header.NumFrames = FMath::Max(Header.NumFrames, Record.Frame + 1);
+}
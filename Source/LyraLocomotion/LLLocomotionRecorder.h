@@ -0,0 +1,40 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "LLLocomotionRecording.h"
+
+class ULLAnimInstance;
+struct FLLLocomotionSnapshot;
+
+// Writes the locomotion inputs every anim instance gathers in NativeUpdateAnimation to a recording file,
+// for LLLocomotionReplay to replay without the game. Game thread only.
+class FLLLocomotionRecorder
+{
+public:
+	// Nullptr when the file can't be written
+	static TUniquePtr<FLLLocomotionRecorder> Create(const FString& Path);
+
+	// Writes the final header, the recording can't be replayed before
+	~FLLLocomotionRecorder();
+
+	// Tuning is only written for the first record of each anim instance
+	void Record(const ULLAnimInstance* AnimInstance, const FLLLocomotionSnapshot& Snapshot, float GroundDistance, float DeltaSeconds,
+		const LLLocomotionMath::FLLKinematicsTuning& Tuning);
+
+	const FString& GetPath() const { return Path; }
+
+private:
+	FLLLocomotionRecorder(TUniquePtr<FArchive> InWriter, const FString& InPath);
+
+	void WriteHeader();
+
+	TUniquePtr<FArchive> Writer;
+	FString Path;
+	LLLocomotionRecording::FLLRecordingHeader Header;
+	TMap<TObjectKey<ULLAnimInstance>, uint16> Characters;
+	TArray<LLLocomotionMath::FLLKinematicsTuning> Tunings;
+	uint64 StartFrame = 0;
+};
@@ -0,0 +1,131 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "LLLocomotionSettings.generated.h"
+
+USTRUCT()
+struct FLLUpdateRateTier
+{
+	GENERATED_BODY()
+
+	// Characters at least this far from the closest local viewer use this tier
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0", Units = "cm"))
+	float MinDistance = 0;
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1", ClampMax = "16"))
+	int32 FramesPerUpdate = 1;
+};
+
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Lyra Locomotion"))
+class LYRALOCOMOTION_API ULLLocomotionSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	// Compute location, rotation, velocity, acceleration and root yaw offset data of every ULLAnimInstance in one batch per frame
+	UPROPERTY(Config, EditAnywhere, Category = "Kinematics")
+	bool bBatchKinematics = false;
+
+	// Number of instances computed by one task of the kinematics batch, a single chunk runs on the game thread
+	UPROPERTY(Config, EditAnywhere, Category = "Kinematics", meta = (ClampMin = "1"))
+	int32 KinematicsBatchChunkSize = 256;
+
+	// Skeletal mesh update rate optimizations, picked by screen size. ULLLocomotionSubsystem turns them off again
+	// on the meshes it registers while UpdateRateTiers, the animation budget or the kinematics batch is on.
+	UPROPERTY(Config, EditAnywhere, Category = "Update Rate")
+	bool bEnableUpdateRateOptimizations = false;
+
+	// Anim updates read the locomotion snapshot of the previous frame, so meshes no longer wait for the movement of their character
+	// and the anim worker overlaps the game thread. Trades exactly one frame of locomotion latency for game thread throughput.
+	UPROPERTY(Config, EditAnywhere, Category = "Update Rate")
+	bool bPipelineLocomotionUpdate = false;
+
+	// Update anim instances every N frames by distance to the closest local viewer, the tier with the largest MinDistance below the distance wins
+	UPROPERTY(Config, EditAnywhere, Category = "Update Rate")
+	TArray<FLLUpdateRateTier> UpdateRateTiers;
+
+	// Pick a locomotion fidelity per character from its significance to the local viewers
+	UPROPERTY(Config, EditAnywhere, Category = "Fidelity")
+	bool bEnableFidelityTiers = false;
+
+	// Characters below this significance drop the ground trace and the pivot prediction.
+	// Significance is the screen size of the character bounds to the closest local viewer, scaled down when not rendered.
+	UPROPERTY(Config, EditAnywhere, Category = "Fidelity", meta = (ClampMin = "0", ClampMax = "1"))
+	float ReducedFidelitySignificance = 0.1f;
+
+	// Characters below this significance only play idle and cycle
+	UPROPERTY(Config, EditAnywhere, Category = "Fidelity", meta = (ClampMin = "0", ClampMax = "1"))
+	float CycleOnlySignificance = 0.02f;
+
+	// Characters further than this from every local viewer are cycle only whatever their screen size
+	UPROPERTY(Config, EditAnywhere, Category = "Fidelity", meta = (ClampMin = "0", Units = "cm"))
+	float FidelityMaxDistance = 8000.0f;
+
+	// Significance multiplier of characters that weren't rendered recently
+	UPROPERTY(Config, EditAnywhere, Category = "Fidelity", meta = (ClampMin = "0", ClampMax = "1"))
+	float HiddenSignificanceScale = 0.25f;
+
+	// Share a per-frame time budget between all locomotion anim instances, giving the most significant ones the best update rate and fidelity
+	UPROPERTY(Config, EditAnywhere, Category = "Budget")
+	bool bEnableAnimationBudget = false;
+
+	// Time per frame all locomotion anim instance updates may take, as measured over the whole update of each instance:
+	// both native updates, the graph update, pose evaluation and its share of the kinematics batch
+	UPROPERTY(Config, EditAnywhere, Category = "Budget", meta = (ClampMin = "0", Units = "ms"))
+	float AnimationBudgetMs = 1.0f;
+
+	// Lowest update rate the budget may assign
+	UPROPERTY(Config, EditAnywhere, Category = "Budget", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 BudgetMaxFramesPerUpdate = 8;
+
+	// Put fully idle characters to sleep, skipping their anim updates and keeping the last pose until they move, turn or play a montage
+	UPROPERTY(Config, EditAnywhere, Category = "Dormancy")
+	bool bEnableDormancy = false;
+
+	// How long a character stays fully idle before it sleeps, long enough for the blend into idle to finish
+	UPROPERTY(Config, EditAnywhere, Category = "Dormancy", meta = (ClampMin = "0", Units = "s"))
+	float DormancyDelay = 0.5f;
+
+	// Sample TurnYawWeight and RemainingTurnYaw from the turn in place sequence at its current time instead of the last evaluated pose,
+	// so the root yaw offset stays right on characters whose pose evaluation is skipped or throttled
+	UPROPERTY(Config, EditAnywhere, Category = "Turn In Place")
+	bool bSampleTurnYawFromSequence = false;
+
+	// Characters idling or cycling on the same sequence at about the same time share the pose one leader evaluates.
+	// Followers skip evaluating the graph below their Shared Locomotion Pose node and only evaluate the nodes above it, such as the root yaw offset and lean.
+	UPROPERTY(Config, EditAnywhere, Category = "Pose Sharing")
+	bool bEnablePoseSharing = false;
+
+	// Playback times within the same step of this length share a pose, followers are at most this far off their own time
+	UPROPERTY(Config, EditAnywhere, Category = "Pose Sharing", meta = (ClampMin = "0.001", Units = "s"))
+	float PoseSharingTimeStep = 0.1f;
+
+	// Followers go back to their own graph past this root yaw offset, below the angle the ABP turns in place at
+	UPROPERTY(Config, EditAnywhere, Category = "Pose Sharing", meta = (ClampMin = "0", ClampMax = "180", Units = "deg"))
+	float PoseSharingMaxRootYawOffset = 45.0f;
+
+	// On dedicated servers, meshes only tick montages and skip the graph and pose evaluation. ULLLocomotionSubsystem still updates
+	// the locomotion values gameplay reads through FLLLocomotionGameplayState. Bones stay in the reference pose outside of montages.
+	UPROPERTY(Config, EditAnywhere, Category = "Dedicated Server")
+	bool bGameplayOnlyOnDedicatedServer = false;
+
+	// Issue ground traces of airborne characters as one async batch and consume them the next frame
+	UPROPERTY(Config, EditAnywhere, Category = "Ground Trace")
+	bool bAsyncGroundTraces = false;
+
+	// Oldest ground distance, in seconds, that is extrapolated instead of tracing synchronously. The longest trace interval
+	// is one frame shorter, so the result of a trace arrives before the distance it replaces gets too old.
+	UPROPERTY(Config, EditAnywhere, Category = "Ground Trace", meta = (ClampMin = "0", Units = "s"))
+	float GroundTraceLatencyTolerance = 0.2f;
+
+	// Rising characters further than this from the jump apex trace at the longest interval
+	UPROPERTY(Config, EditAnywhere, Category = "Ground Trace", meta = (ClampMin = "0", Units = "s"))
+	float GroundTraceApexTimeThreshold = 0.2f;
+
+	// Falling characters wait this fraction of their estimated time to reach the ground before tracing again
+	UPROPERTY(Config, EditAnywhere, Category = "Ground Trace", meta = (ClampMin = "0", ClampMax = "1"))
+	float GroundTraceTimeToGroundRatio = 0.25f;
+};
@@ -0,0 +1,960 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLLocomotionSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "LLAnimInstance.h"
+#include "LLLocomotionProfiler.h"
+#include "LLLocomotionSettings.h"
+#include "LLLocomotionTuning.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLLLocomotion, Log, All);
+
+static FAutoConsoleCommandWithWorld LLMemoryReportCommand(
+	TEXT("LL.MemoryReport"),
+	TEXT("Logs the memory of the locomotion anim instances per class, before and after sharing their tuning."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const ULLLocomotionSubsystem* LocomotionSubsystem = UWorld::GetSubsystem<ULLLocomotionSubsystem>(World))
+		{
+			LocomotionSubsystem->LogMemoryReport();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs LLRecordInputsCommand(
+	TEXT("LL.RecordInputs"),
+	TEXT("Records the locomotion inputs of every character to a file for LLLocomotionReplay until LL.StopRecordingInputs. ")
+	TEXT("Usage: LL.RecordInputs [Path], defaults to Saved/Profiling/Locomotion-<time>.llrec"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (ULLLocomotionSubsystem* LocomotionSubsystem = UWorld::GetSubsystem<ULLLocomotionSubsystem>(World))
+		{
+			const FString Path = Args.Num() > 0 ? Args[0] :
+				FPaths::ProjectSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("Locomotion-%s.llrec"), *FDateTime::Now().ToString());
+			LocomotionSubsystem->StartRecordingInputs(Path);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld LLStopRecordingInputsCommand(
+	TEXT("LL.StopRecordingInputs"),
+	TEXT("Stops the recording started by LL.RecordInputs and finalizes the file."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (ULLLocomotionSubsystem* LocomotionSubsystem = UWorld::GetSubsystem<ULLLocomotionSubsystem>(World))
+		{
+			LocomotionSubsystem->StopRecordingInputs();
+		}
+	}));
+
+void FLLLocomotionBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->TickBatch(DeltaTime);
+	}
+}
+
+FString FLLLocomotionBatchTickFunction::DiagnosticMessage()
+{
+	return TEXT("FLLLocomotionBatchTickFunction");
+}
+
+FLLGroundTrace::FLLGroundTrace(const ACharacter* Owner)
+	: QueryParams(SCENE_QUERY_STAT(LyraCharacterMovementComponent_GetGroundInfo), false, Owner)
+{
+	const UCharacterMovementComponent* MoveComponent = Owner->GetCharacterMovement();
+	const UCapsuleComponent* CapsuleComp = Owner->GetCapsuleComponent();
+	check(MoveComponent && CapsuleComp);
+
+	CapsuleHalfHeight = CapsuleComp->GetUnscaledCapsuleHalfHeight();
+	CollisionChannel = (MoveComponent->UpdatedComponent ? MoveComponent->UpdatedComponent->GetCollisionObjectType() : ECC_Pawn);
+	Start = Owner->GetActorLocation();
+	End = FVector(Start.X, Start.Y, (Start.Z - GroundTraceDistance - CapsuleHalfHeight));
+
+	MoveComponent->InitCollisionParams(QueryParams, ResponseParams);
+}
+
+float FLLGroundTrace::GetGroundDistance(const FHitResult& HitResult, float CapsuleHalfHeight)
+{
+	return HitResult.bBlockingHit ? FMath::Max((HitResult.Distance - CapsuleHalfHeight), 0.0f) : GroundTraceDistance;
+}
+
+int32 FLLKinematicsBatch::Add()
+{
+	const int32 Index = Num();
+	ForEachArray([](auto& Array) { Array.AddDefaulted(); });
+	bUpdateThisFrame[Index] = false;
+	return Index;
+}
+
+void FLLKinematicsBatch::RemoveAtSwap(int32 Index)
+{
+	ForEachArray([Index](auto& Array) { Array.RemoveAtSwap(Index, 1, false); });
+}
+
+template <typename FuncType>
+void FLLKinematicsBatch::ForEachArray(FuncType&& Func)
+{
+	Func(DeltaTime);
+	Func(bUpdateThisFrame);
+	Func(Inputs);
+	Func(Tuning);
+	Func(State);
+}
+
+void ULLLocomotionSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const ULLLocomotionSettings* Settings = GetDefault<ULLLocomotionSettings>();
+	// Update rates, fidelity tiers, the budget and pose sharing only matter to meshes that evaluate a pose
+	bGameplayOnly = Settings->bGameplayOnlyOnDedicatedServer && InWorld.GetNetMode() == NM_DedicatedServer;
+	bBatchKinematics = Settings->bBatchKinematics;
+	bAsyncGroundTraces = Settings->bAsyncGroundTraces;
+	bAnimationBudget = Settings->bEnableAnimationBudget && !bGameplayOnly;
+	bControlUpdateRate = !bGameplayOnly && (bAnimationBudget || !Settings->UpdateRateTiers.IsEmpty());
+	bFidelityTiers = Settings->bEnableFidelityTiers && !bGameplayOnly;
+	bPipelineUpdate = Settings->bPipelineLocomotionUpdate;
+	bPoseSharing = Settings->bEnablePoseSharing && !bGameplayOnly;
+
+	// Only features that hand the batch results to the anim update order it between the movement and the meshes.
+	// Otherwise no mesh waits for the batch, and so not for the movement of every other character either.
+	bMeshesWaitForBatch = bBatchKinematics || bControlUpdateRate || bFidelityTiers || bAsyncGroundTraces || bPoseSharing || bGameplayOnly;
+	bBatchWaitsForMovement = !bPipelineUpdate && (bBatchKinematics || bGameplayOnly);
+
+	// Skipped mesh updates would add up frames the batch already computed displacements for, one at a time
+	bDisableUpdateRateOptimizations = bBatchKinematics || bControlUpdateRate;
+
+	BatchTickFunction.Target = this;
+	BatchTickFunction.TickGroup = TG_PrePhysics;
+	BatchTickFunction.bCanEverTick = true;
+	BatchTickFunction.bStartWithTickEnabled = true;
+	BatchTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void ULLLocomotionSubsystem::Deinitialize()
+{
+	if (BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.UnRegisterTickFunction();
+	}
+	BatchTickFunction.Target = nullptr;
+
+	StopRecordingInputs();
+
+	AnimInstances.Reset();
+	Owners.Reset();
+	Kinematics = FLLKinematicsBatch();
+	GroundTraces.Reset();
+	UpdateRateStates.Reset();
+	Significances.Reset();
+	BudgetLevels.Reset();
+	BudgetOrder.Reset();
+
+	Super::Deinitialize();
+}
+
+bool ULLLocomotionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void ULLLocomotionSubsystem::RegisterAnimInstance(ULLAnimInstance* AnimInstance)
+{
+	if (AnimInstance->LocomotionSlot != INDEX_NONE)
+	{
+		return;
+	}
+
+	ACharacter* Owner = Cast<ACharacter>(AnimInstance->GetOwningActor());
+	if (!Owner || !Owner->GetCharacterMovement())
+	{
+		return;
+	}
+
+	// Movement -> kinematics batch -> mesh, so the batch sees this frame's movement and the anim update sees the batch result.
+	// Pipelined meshes don't wait for movement, the batch then reads the previous frame's movement like they do.
+	if (bBatchWaitsForMovement)
+	{
+		BatchTickFunction.AddPrerequisite(Owner->GetCharacterMovement(), Owner->GetCharacterMovement()->PrimaryComponentTick);
+	}
+	if (bMeshesWaitForBatch)
+	{
+		AnimInstance->GetSkelMeshComponent()->PrimaryComponentTick.AddPrerequisite(this, BatchTickFunction);
+	}
+
+	AnimInstance->LocomotionSubsystem = this;
+	AnimInstance->LocomotionSlot = Kinematics.Add();
+	Kinematics.Tuning[AnimInstance->LocomotionSlot] = AnimInstance->GetTuning().GetKinematicsTuning();
+	AnimInstance->bKinematicsBatched = bBatchKinematics;
+	AnimInstance->bMeasureUpdateCost = bAnimationBudget;
+	AnimInstances.Add(AnimInstance);
+	Owners.Add(Owner);
+	GroundTraces.AddDefaulted();
+	UpdateRateStates.AddDefaulted_GetRef().Phase = AnimInstance->LocomotionSlot;
+	Significances.Add(1.0f);
+	BudgetLevels.AddDefaulted();
+
+	// The batch computes displacements over the delta time of each anim update, the mesh must not skip the frames it computes them for
+	if (bDisableUpdateRateOptimizations && AnimInstance->GetSkelMeshComponent()->bEnableUpdateRateOptimizations)
+	{
+		AnimInstance->GetSkelMeshComponent()->bEnableUpdateRateOptimizations = false;
+		AnimInstance->bRestoreUpdateRateOptimizations = true;
+	}
+
+	// With a rate feature on, the subsystem decides which frames the mesh updates on and with which delta time,
+	// so batched kinematics and update rate tiers always see the time actually elapsed since the last update.
+	if (bControlUpdateRate)
+	{
+		USkeletalMeshComponent* SkelMeshComponent = AnimInstance->GetSkelMeshComponent();
+		SkelMeshComponent->EnableExternalTickRateControl(true);
+		SkelMeshComponent->EnableExternalInterpolation(false);
+	}
+
+	// The mesh only ticks montages, so they still play and fire their notifies, and skips the graph update and
+	// pose evaluation. UpdateGameplayOnly runs the locomotion update of the instance in their place.
+	if (bGameplayOnly)
+	{
+		AnimInstance->bGameplayOnly = true;
+		AnimInstance->GetSkelMeshComponent()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+	}
+}
+
+void ULLLocomotionSubsystem::UnregisterAnimInstance(ULLAnimInstance* AnimInstance)
+{
+	const int32 Index = AnimInstance->LocomotionSlot;
+	if (!AnimInstances.IsValidIndex(Index) || AnimInstances[Index] != AnimInstance)
+	{
+		return;
+	}
+
+	ACharacter* Owner = Owners[Index];
+	if (bBatchWaitsForMovement && Owner)
+	{
+		BatchTickFunction.RemovePrerequisite(Owner->GetCharacterMovement(), Owner->GetCharacterMovement()->PrimaryComponentTick);
+	}
+	if (USkeletalMeshComponent* SkelMeshComponent = AnimInstance->GetSkelMeshComponent())
+	{
+		if (bMeshesWaitForBatch)
+		{
+			SkelMeshComponent->PrimaryComponentTick.RemovePrerequisite(this, BatchTickFunction);
+		}
+		if (bControlUpdateRate)
+		{
+			SkelMeshComponent->EnableExternalTickRateControl(false);
+		}
+		if (AnimInstance->bRestoreUpdateRateOptimizations)
+		{
+			SkelMeshComponent->bEnableUpdateRateOptimizations = true;
+		}
+	}
+
+	Kinematics.RemoveAtSwap(Index);
+	AnimInstances.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	GroundTraces.RemoveAtSwap(Index, 1, false);
+	UpdateRateStates.RemoveAtSwap(Index, 1, false);
+	Significances.RemoveAtSwap(Index, 1, false);
+	BudgetLevels.RemoveAtSwap(Index, 1, false);
+	if (AnimInstances.IsValidIndex(Index))
+	{
+		AnimInstances[Index]->LocomotionSlot = Index;
+	}
+	AnimInstance->LocomotionSlot = INDEX_NONE;
+	AnimInstance->bKinematicsBatched = false;
+	AnimInstance->bMeasureUpdateCost = false;
+	AnimInstance->MeasuredUpdateCycles = 0;
+	AnimInstance->bGameplayOnly = false;
+	AnimInstance->bRestoreUpdateRateOptimizations = false;
+	AnimInstance->LocomotionSubsystem = nullptr;
+	AnimInstance->SetLocomotionFidelity(ELLLocomotionFidelity::Full);
+	AnimInstance->PoseSharingRole = ELLPoseSharingRole::None;
+	AnimInstance->SharedPose.Reset();
+}
+
+bool ULLLocomotionSubsystem::GetAsyncGroundDistance(int32 Slot, double ActorZ, float& OutGroundDistance) const
+{
+	if (!bAsyncGroundTraces || !GroundTraces.IsValidIndex(Slot))
+	{
+		return false;
+	}
+
+	// A result that aged past the tolerance on a long frame still stands in while the trace issued this frame to replace it
+	// is in flight, instead of tracing again on the game thread.
+	const FLLGroundTraceState& State = GroundTraces[Slot];
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float LatencyTolerance = GetDefault<ULLLocomotionSettings>()->GroundTraceLatencyTolerance;
+	const bool bTraceInFlight = State.PendingTrace.IsValid() && Now - State.PendingTraceTime <= LatencyTolerance;
+	if (!State.HasGroundDistance() || (Now - State.GroundDistanceTime > LatencyTolerance && !bTraceInFlight))
+	{
+		return false;
+	}
+
+	// Assume flat ground below the character since the trace was issued.
+	OutGroundDistance = FMath::Max(State.GroundDistance + static_cast<float>(ActorZ - State.GroundDistanceZ), 0.0f);
+	return true;
+}
+
+void ULLLocomotionSubsystem::SetGroundDistance(int32 Slot, double ActorZ, float GroundDistance)
+{
+	if (GroundTraces.IsValidIndex(Slot))
+	{
+		FLLGroundTraceState& State = GroundTraces[Slot];
+		State.GroundDistance = GroundDistance;
+		State.GroundDistanceZ = ActorZ;
+		State.GroundDistanceTime = GetWorld()->GetTimeSeconds();
+	}
+}
+
+void ULLLocomotionSubsystem::LogMemoryReport() const
+{
+	struct FClassMemory
+	{
+		int32 Instances = 0;
+		SIZE_T Bytes = 0;
+		TSet<const ULLLocomotionTuning*> Tunings;
+	};
+
+	// Measured per instance, the object itself plus what it reports owning, so curve names, anim set pointers and
+	// arrays count as they are now instead of as a fixed list of fields.
+	TMap<const UClass*, FClassMemory> MemoryPerClass;
+	for (ULLAnimInstance* AnimInstance : AnimInstances)
+	{
+		FClassMemory& ClassMemory = MemoryPerClass.FindOrAdd(AnimInstance->GetClass());
+		++ClassMemory.Instances;
+		ClassMemory.Bytes += AnimInstance->GetClass()->GetStructureSize() + AnimInstance->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		ClassMemory.Tunings.Add(&AnimInstance->GetTuning());
+	}
+
+	// Estimate of the layout before the move, not a measurement: the tuning fields ULLLocomotionTuning took over
+	// come back in place of the Tuning pointer. Curve names and anim set pointers stayed on the instance, so the
+	// measured bytes already hold them for both layouts.
+	const int32 TuningBytes = ULLLocomotionTuning::StaticClass()->GetStructureSize() - UDataAsset::StaticClass()->GetStructureSize();
+	const int32 EstimatedSavedBytes = TuningBytes - static_cast<int32>(sizeof(TObjectPtr<ULLLocomotionTuning>));
+
+	for (const TPair<const UClass*, FClassMemory>& Pair : MemoryPerClass)
+	{
+		const FClassMemory& ClassMemory = Pair.Value;
+		// The shared tuning assets are paid once per class rather than once per instance
+		const SIZE_T SharedBytes = ClassMemory.Tunings.Num() * ULLLocomotionTuning::StaticClass()->GetStructureSize();
+		const SIZE_T TotalBytes = ClassMemory.Bytes + SharedBytes;
+		const SIZE_T EstimatedBeforeBytes = ClassMemory.Bytes + static_cast<SIZE_T>(EstimatedSavedBytes) * ClassMemory.Instances;
+		UE_LOG(LogLLLocomotion, Display, TEXT("%-48s | %5d instances | %6llu bytes per instance measured, %6llu est. before | %8.1f KiB total measured, %8.1f KiB est. before"),
+			*Pair.Key->GetName(), ClassMemory.Instances,
+			static_cast<uint64>(ClassMemory.Bytes / ClassMemory.Instances), static_cast<uint64>(EstimatedBeforeBytes / ClassMemory.Instances),
+			TotalBytes / 1024.0f, EstimatedBeforeBytes / 1024.0f);
+	}
+}
+
+bool ULLLocomotionSubsystem::StartRecordingInputs(const FString& Path)
+{
+	StopRecordingInputs();
+
+	InputRecorder = FLLLocomotionRecorder::Create(Path);
+	if (InputRecorder)
+	{
+		UE_LOG(LogLLLocomotion, Display, TEXT("Recording locomotion inputs to %s"), *Path);
+	}
+	return InputRecorder.IsValid();
+}
+
+void ULLLocomotionSubsystem::StopRecordingInputs()
+{
+	InputRecorder.Reset();
+}
+
+void ULLLocomotionSubsystem::TickBatch(float DeltaTime)
+{
+	if (Kinematics.Num() == 0)
+	{
+		return;
+	}
+
+	if (bGameplayOnly)
+	{
+		UpdateGameplayOnly(DeltaTime);
+		return;
+	}
+
+	TArray<FLLViewPoint, TInlineAllocator<4>> ViewPoints;
+	if (bFidelityTiers || bAnimationBudget || !GetDefault<ULLLocomotionSettings>()->UpdateRateTiers.IsEmpty())
+	{
+		GatherViewPoints(ViewPoints);
+	}
+
+	if (bFidelityTiers || bAnimationBudget)
+	{
+		UpdateSignificances(ViewPoints);
+	}
+
+	if (bAnimationBudget)
+	{
+		UpdateBudget();
+	}
+
+	if (bFidelityTiers || bAnimationBudget)
+	{
+		UpdateFidelity();
+	}
+
+	if (bControlUpdateRate)
+	{
+		UpdateRates(DeltaTime, ViewPoints);
+	}
+	else if (bBatchKinematics)
+	{
+		UpdateEveryFrame(DeltaTime);
+	}
+
+	if (bAsyncGroundTraces)
+	{
+		UpdateGroundTraces(DeltaTime);
+	}
+
+	if (bPoseSharing)
+	{
+		UpdatePoseSharing();
+	}
+
+	if (bBatchKinematics)
+	{
+		UpdateKinematics();
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateGameplayOnly(float DeltaTime)
+{
+	LL_SCOPED_STAT(UpdateGameplayOnly);
+
+	if (bAsyncGroundTraces)
+	{
+		UpdateGroundTraces(DeltaTime);
+	}
+
+	// Nothing looks at the characters to pick a lower rate for.
+	UpdateEveryFrame(DeltaTime);
+
+	if (bBatchKinematics)
+	{
+		UpdateKinematics();
+	}
+
+	for (int32 Index = 0; Index < AnimInstances.Num(); ++Index)
+	{
+		AnimInstances[Index]->UpdateGameplayOnly(Kinematics.DeltaTime[Index]);
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateEveryFrame(float DeltaTime)
+{
+	// Meshes keep their own tick, the batch computes every awake instance each frame
+	for (int32 Index = 0; Index < Kinematics.Num(); ++Index)
+	{
+		const bool bUpdate = !AnimInstances[Index]->IsDormant();
+		Kinematics.bUpdateThisFrame[Index] = bUpdate;
+		Kinematics.DeltaTime[Index] = DeltaTime * Owners[Index]->CustomTimeDilation;
+		if (!bUpdate)
+		{
+			Kinematics.State[Index].bIsFirstUpdate = true;
+		}
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateKinematics()
+{
+	const uint64 StartCycles = bAnimationBudget ? FPlatformTime::Cycles64() : 0;
+
+	GatherKinematics();
+
+	const int32 Num = Kinematics.Num();
+	const int32 ChunkSize = FMath::Max(GetDefault<ULLLocomotionSettings>()->KinematicsBatchChunkSize, 1);
+	const int32 NumChunks = FMath::DivideAndRoundUp(Num, ChunkSize);
+	ParallelFor(NumChunks, [this, Num, ChunkSize](int32 ChunkIndex)
+	{
+		const int32 Begin = ChunkIndex * ChunkSize;
+		ComputeKinematics(Begin, FMath::Min(Begin + ChunkSize, Num));
+	}, NumChunks == 1);
+
+	ScatterKinematics();
+
+	// The batch replaces part of each update, so the budget charges it to the instances it updated
+	if (!bAnimationBudget)
+	{
+		return;
+	}
+
+	int32 NumUpdated = 0;
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		NumUpdated += Kinematics.bUpdateThisFrame[Index] ? 1 : 0;
+	}
+	if (NumUpdated > 0)
+	{
+		const uint64 CyclesPerInstance = (FPlatformTime::Cycles64() - StartCycles) / NumUpdated;
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			if (Kinematics.bUpdateThisFrame[Index])
+			{
+				AnimInstances[Index]->MeasuredUpdateCycles += CyclesPerInstance;
+			}
+		}
+	}
+}
+
+void ULLLocomotionSubsystem::GatherKinematics()
+{
+	FLLKinematicsBatch& K = Kinematics;
+
+	for (int32 Index = 0; Index < K.Num(); ++Index)
+	{
+		if (!K.bUpdateThisFrame[Index])
+		{
+			continue;
+		}
+
+		const ACharacter* Owner = Owners[Index];
+		ULLAnimInstance* AnimInstance = AnimInstances[Index];
+
+		const FLLLocomotionSnapshot Snapshot = AnimInstance->LocomotionMovement ?
+			AnimInstance->LocomotionMovement->GetLocomotionSnapshot() : FLLLocomotionSnapshot::Capture(Owner);
+
+		AnimInstance->HotState.PrevWorldLocation = AnimInstance->WorldLocation;
+		AnimInstance->WorldLocation = Snapshot.Location;
+		AnimInstance->HotState.PrevWorldRotation = AnimInstance->WorldRotation;
+		AnimInstance->WorldRotation = Snapshot.Rotation;
+		AnimInstance->WorldVelocity = Snapshot.Velocity;
+
+		LLLocomotionMath::FLLKinematicsInputs& Inputs = K.Inputs[Index];
+		Inputs.LocationX = AnimInstance->WorldLocation.X;
+		Inputs.LocationY = AnimInstance->WorldLocation.Y;
+		Inputs.SetRotation(AnimInstance->WorldRotation.Pitch, AnimInstance->WorldRotation.Yaw, AnimInstance->WorldRotation.Roll);
+		Inputs.VelocityX = AnimInstance->WorldVelocity.X;
+		Inputs.VelocityY = AnimInstance->WorldVelocity.Y;
+		Inputs.AccelerationX = Snapshot.Acceleration.X;
+		Inputs.AccelerationY = Snapshot.Acceleration.Y;
+
+		FLLKinematics& State = K.State[Index];
+		State.RootYawOffset = AnimInstance->RootYawOffset;
+		State.RootYawOffsetMode = AnimInstance->HotState.RootYawOffsetMode;
+		State.RootYawOffsetSpringState = AnimInstance->HotState.RootYawOffsetSpringState;
+	}
+}
+
+void ULLLocomotionSubsystem::ComputeKinematics(int32 Begin, int32 End)
+{
+	FLLKinematicsBatch& K = Kinematics;
+
+	for (int32 Index = Begin; Index < End; ++Index)
+	{
+		if (K.bUpdateThisFrame[Index])
+		{
+			LLLocomotionMath::ComputeKinematics(K.Inputs[Index], K.Tuning[Index], K.DeltaTime[Index], K.State[Index]);
+		}
+	}
+}
+
+void ULLLocomotionSubsystem::ScatterKinematics()
+{
+	const FLLKinematicsBatch& K = Kinematics;
+
+	for (int32 Index = 0; Index < K.Num(); ++Index)
+	{
+		if (!K.bUpdateThisFrame[Index])
+		{
+			continue;
+		}
+
+		ULLAnimInstance* AnimInstance = AnimInstances[Index];
+		const FLLKinematics& State = K.State[Index];
+
+		AnimInstance->HotState.DisplacementSinceLastUpdate = State.DisplacementSinceLastUpdate;
+		AnimInstance->DisplacementSpeed = State.DisplacementSpeed;
+		AnimInstance->HotState.YawDeltaSinceLastUpdate = State.YawDeltaSinceLastUpdate;
+		AnimInstance->AdditiveLeanAngle = State.AdditiveLeanAngle;
+		AnimInstance->LocalVelocity2D = FVector(State.LocalVelocityX, State.LocalVelocityY, State.LocalVelocityZ);
+		AnimInstance->LocalVelocityDirectionAngle = State.LocalVelocityDirectionAngle;
+		AnimInstance->LocalVelocityDirectionAngleWithOffset = State.LocalVelocityDirectionAngleWithOffset;
+		AnimInstance->LocalVelocityDirection = State.LocalVelocityDirection;
+		AnimInstance->HotState.LocalVelocityDirectionNoOffset = State.LocalVelocityDirectionNoOffset;
+		AnimInstance->bHasVelocity = State.bHasVelocity;
+		AnimInstance->LocalAcceleration2D = FVector(State.LocalAccelerationX, State.LocalAccelerationY, State.LocalAccelerationZ);
+		AnimInstance->bHasAcceleration = State.bHasAcceleration;
+		AnimInstance->bIsRunningIntoWall = State.bIsRunningIntoWall;
+		AnimInstance->HotState.PivotDirection2D = FVector(State.PivotDirectionX, State.PivotDirectionY, 0);
+		AnimInstance->HotState.CardinalDirectionFromAcceleration = State.CardinalDirectionFromAcceleration;
+		AnimInstance->HotState.LocalVelocityOctant = State.LocalVelocityOctant;
+		AnimInstance->HotState.LocalVelocityOctantNoOffset = State.LocalVelocityOctantNoOffset;
+		AnimInstance->HotState.OctantFromAcceleration = State.OctantFromAcceleration;
+		AnimInstance->RootYawOffset = State.RootYawOffset;
+		AnimInstance->HotState.RootYawOffsetMode = State.RootYawOffsetMode;
+		AnimInstance->HotState.RootYawOffsetSpringState = State.RootYawOffsetSpringState;
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateGroundTraces(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	const double Now = World->GetTimeSeconds();
+	const ULLLocomotionSettings* Settings = GetDefault<ULLLocomotionSettings>();
+
+	for (int32 Index = 0; Index < GroundTraces.Num(); ++Index)
+	{
+		FLLGroundTraceState& State = GroundTraces[Index];
+		const ACharacter* Owner = Owners[Index];
+		const UCharacterMovementComponent* MoveComponent = Owner->GetCharacterMovement();
+
+		// Results of the traces issued last frame
+		if (State.PendingTrace.IsValid())
+		{
+			FTraceDatum TraceDatum;
+			if (World->QueryTraceData(State.PendingTrace, TraceDatum))
+			{
+				const FHitResult HitResult = TraceDatum.OutHits.Num() > 0 ? TraceDatum.OutHits[0] : FHitResult();
+				State.GroundDistance = FLLGroundTrace::GetGroundDistance(HitResult, Owner->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight());
+				State.GroundDistanceZ = State.PendingTraceZ;
+				State.GroundDistanceTime = State.PendingTraceTime;
+			}
+			State.PendingTrace = FTraceHandle();
+		}
+
+		const double ActorZ = Owner->GetActorLocation().Z;
+
+		if (MoveComponent->MovementMode == MOVE_Walking || MoveComponent->MovementMode == MOVE_NavWalking)
+		{
+			State.GroundDistance = 0;
+			State.GroundDistanceZ = ActorZ;
+			State.GroundDistanceTime = Now;
+			continue;
+		}
+
+		// Below full fidelity the anim instance extrapolates the last ground distance instead
+		if (AnimInstances[Index]->GetLocomotionFidelity() != ELLLocomotionFidelity::Full)
+		{
+			continue;
+		}
+
+		// Throttle by how soon the ground distance can matter, short enough that the anim update never finds it too old
+		const float Extrapolated = FMath::Max(State.GroundDistance + static_cast<float>(ActorZ - State.GroundDistanceZ), 0.0f);
+		const float TraceInterval = LLLocomotionMath::GroundTraceInterval(Owner->GetVelocity().Z, MoveComponent->GetGravityZ(), Extrapolated,
+			DeltaTime, Settings->GroundTraceLatencyTolerance, Settings->GroundTraceApexTimeThreshold, Settings->GroundTraceTimeToGroundRatio);
+
+		if (Now - State.GroundDistanceTime >= TraceInterval)
+		{
+			LL_INC_COUNTER(GroundTraces);
+			const FLLGroundTrace Trace(Owner);
+			State.PendingTrace = World->AsyncLineTraceByChannel(
+				EAsyncTraceType::Single, Trace.Start, Trace.End, Trace.CollisionChannel, Trace.QueryParams, Trace.ResponseParams);
+			State.PendingTraceZ = ActorZ;
+			State.PendingTraceTime = Now;
+		}
+	}
+}
+
+void ULLLocomotionSubsystem::GatherViewPoints(TArray<FLLViewPoint, TInlineAllocator<4>>& OutViewPoints) const
+{
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FLLViewPoint& ViewPoint = OutViewPoints.AddDefaulted_GetRef();
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewPoint.Location, ViewRotation);
+			if (PlayerController->PlayerCameraManager)
+			{
+				ViewPoint.TanHalfFOV = FMath::Tan(FMath::DegreesToRadians(PlayerController->PlayerCameraManager->GetFOVAngle() * 0.5f));
+			}
+		}
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateRates(float DeltaTime, TConstArrayView<FLLViewPoint> ViewPoints)
+{
+	const bool bUseTiers = !GetDefault<ULLLocomotionSettings>()->UpdateRateTiers.IsEmpty();
+
+	for (int32 Index = 0; Index < UpdateRateStates.Num(); ++Index)
+	{
+		FLLUpdateRateState& State = UpdateRateStates[Index];
+		const ACharacter* Owner = Owners[Index];
+		USkeletalMeshComponent* SkelMeshComponent = AnimInstances[Index]->GetSkelMeshComponent();
+
+		// Dormant instances don't update, and their first update after waking up starts over from the current state.
+		if (AnimInstances[Index]->IsDormant())
+		{
+			State.AccumulatedDeltaTime = 0;
+			Kinematics.bUpdateThisFrame[Index] = false;
+			Kinematics.State[Index].bIsFirstUpdate = true;
+			continue;
+		}
+
+		State.FramesPerUpdate = bUseTiers ? SelectFramesPerUpdate(Owner->GetActorLocation(), ViewPoints) : 1;
+		if (bAnimationBudget)
+		{
+			State.FramesPerUpdate = FMath::Max(State.FramesPerUpdate, BudgetLevels[Index].FramesPerUpdate);
+		}
+		State.AccumulatedDeltaTime += DeltaTime * Owner->CustomTimeDilation;
+
+		// Stagger instances on the same tier so their updates spread evenly over frames.
+		const bool bUpdate = State.FramesPerUpdate <= 1 || (GFrameCounter + State.Phase) % State.FramesPerUpdate == 0;
+
+		SkelMeshComponent->SetExternalTickRate(State.FramesPerUpdate);
+		SkelMeshComponent->EnableExternalUpdate(bUpdate);
+
+		Kinematics.bUpdateThisFrame[Index] = bUpdate;
+		if (bUpdate)
+		{
+			SkelMeshComponent->SetExternalDeltaTime(State.AccumulatedDeltaTime);
+			Kinematics.DeltaTime[Index] = State.AccumulatedDeltaTime;
+			State.AccumulatedDeltaTime = 0;
+		}
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateSignificances(TConstArrayView<FLLViewPoint> ViewPoints)
+{
+	for (int32 Index = 0; Index < AnimInstances.Num(); ++Index)
+	{
+		Significances[Index] = ComputeSignificance(Index, ViewPoints);
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateBudget()
+{
+	const ULLLocomotionSettings* Settings = GetDefault<ULLLocomotionSettings>();
+	const int32 MaxFramesPerUpdate = FMath::Max(Settings->BudgetMaxFramesPerUpdate, 1);
+
+	// Average the costs measured since the last budget per tier, then fold each average into the running cost of its tier once,
+	// so the running costs don't depend on the order of the instances. A cost covers the game thread and worker updates, the graph,
+	// the pose evaluation and the instance's share of the kinematics batch.
+	uint64 MeasuredCycles[UE_ARRAY_COUNT(UpdateCostMs)] = {};
+	int32 NumMeasured[UE_ARRAY_COUNT(UpdateCostMs)] = {};
+	for (ULLAnimInstance* AnimInstance : AnimInstances)
+	{
+		if (AnimInstance->MeasuredUpdateCycles != 0)
+		{
+			const uint8 Tier = static_cast<uint8>(AnimInstance->GetLocomotionFidelity());
+			MeasuredCycles[Tier] += AnimInstance->MeasuredUpdateCycles;
+			++NumMeasured[Tier];
+			AnimInstance->MeasuredUpdateCycles = 0;
+		}
+	}
+	for (int32 Tier = 0; Tier < UE_ARRAY_COUNT(UpdateCostMs); ++Tier)
+	{
+		if (NumMeasured[Tier] != 0)
+		{
+			const float AverageCostMs = static_cast<float>(FPlatformTime::ToMilliseconds64(MeasuredCycles[Tier]) / NumMeasured[Tier]);
+			UpdateCostMs[Tier] = FMath::Lerp(UpdateCostMs[Tier], AverageCostMs, 0.05f);
+		}
+	}
+
+	// From the best to the cheapest, an instance gets the first level it can still afford
+	const FLLBudgetLevel Levels[] =
+	{
+		{ ELLLocomotionFidelity::Full, 1 },
+		{ ELLLocomotionFidelity::Full, FMath::Min(2, MaxFramesPerUpdate) },
+		{ ELLLocomotionFidelity::Reduced, FMath::Min(2, MaxFramesPerUpdate) },
+		{ ELLLocomotionFidelity::Reduced, FMath::Min(4, MaxFramesPerUpdate) },
+		{ ELLLocomotionFidelity::CycleOnly, FMath::Min(4, MaxFramesPerUpdate) },
+		{ ELLLocomotionFidelity::CycleOnly, MaxFramesPerUpdate },
+	};
+	auto GetCostPerFrame = [this](const FLLBudgetLevel& Level)
+	{
+		return UpdateCostMs[static_cast<uint8>(Level.Fidelity)] / Level.FramesPerUpdate;
+	};
+
+	// Every awake instance gets at least the cheapest level, what is left of the budget upgrades the most significant first.
+	BudgetOrder.Reset();
+	for (int32 Index = 0; Index < AnimInstances.Num(); ++Index)
+	{
+		if (!AnimInstances[Index]->IsDormant())
+		{
+			BudgetOrder.Add(Index);
+		}
+	}
+
+	const FLLBudgetLevel& CheapestLevel = Levels[UE_ARRAY_COUNT(Levels) - 1];
+	const float CheapestCost = GetCostPerFrame(CheapestLevel);
+	float RemainingBudget = Settings->AnimationBudgetMs - CheapestCost * BudgetOrder.Num();
+
+	BudgetOrder.Sort([this](int32 A, int32 B) { return Significances[A] > Significances[B]; });
+
+	for (const int32 Index : BudgetOrder)
+	{
+		BudgetLevels[Index] = CheapestLevel;
+		for (const FLLBudgetLevel& Level : Levels)
+		{
+			const float ExtraCost = GetCostPerFrame(Level) - CheapestCost;
+			if (ExtraCost <= RemainingBudget)
+			{
+				BudgetLevels[Index] = Level;
+				RemainingBudget -= ExtraCost;
+				break;
+			}
+		}
+	}
+}
+
+void ULLLocomotionSubsystem::UpdateFidelity()
+{
+	// Characters only move up a tier once clearly above its threshold, so they don't flicker between tiers at the boundary.
+	constexpr float Hysteresis = 1.25f;
+
+	const ULLLocomotionSettings* Settings = GetDefault<ULLLocomotionSettings>();
+
+	for (int32 Index = 0; Index < AnimInstances.Num(); ++Index)
+	{
+		ULLAnimInstance* AnimInstance = AnimInstances[Index];
+		const float Significance = Significances[Index];
+
+		ELLLocomotionFidelity Fidelity = ELLLocomotionFidelity::Full;
+		if (bFidelityTiers)
+		{
+			const ELLLocomotionFidelity CurrentFidelity = AnimInstance->GetLocomotionFidelity();
+			const float ReducedThreshold = Settings->ReducedFidelitySignificance * (CurrentFidelity == ELLLocomotionFidelity::Full ? 1.0f : Hysteresis);
+			const float CycleOnlyThreshold = Settings->CycleOnlySignificance * (CurrentFidelity == ELLLocomotionFidelity::CycleOnly ? Hysteresis : 1.0f);
+
+			if (Significance < CycleOnlyThreshold)
+			{
+				Fidelity = ELLLocomotionFidelity::CycleOnly;
+			}
+			else if (Significance < ReducedThreshold)
+			{
+				Fidelity = ELLLocomotionFidelity::Reduced;
+			}
+		}
+
+		// The lower of the significance tier and the budget tier wins
+		if (bAnimationBudget)
+		{
+			Fidelity = FMath::Max(Fidelity, BudgetLevels[Index].Fidelity);
+		}
+		AnimInstance->SetLocomotionFidelity(Fidelity);
+	}
+}
+
+void ULLLocomotionSubsystem::UpdatePoseSharing()
+{
+	LL_SCOPED_STAT(UpdatePoseSharing);
+
+	// Runs before any mesh of the frame updates, so the keys are those of the last update and no worker reads a buffer being flipped.
+	TMap<FLLPoseSharingKey, TSharedPtr<FLLSharedPose>> PosesByKey;
+	TSet<const FLLSharedPose*> LivePoses;
+	for (ULLAnimInstance* AnimInstance : AnimInstances)
+	{
+		if (AnimInstance->PoseSharingRole != ELLPoseSharingRole::Leader)
+		{
+			continue;
+		}
+
+		// A leader keeps its pose while it plays the same sequence in the same state at the same LOD, whatever bucket its time moved to.
+		FLLPoseSharingKey Key;
+		if (AnimInstance->GetPoseSharingKey(Key) && Key.IsSameState(AnimInstance->SharedPose->GetKey()))
+		{
+			AnimInstance->SharedPose->Flip();
+			PosesByKey.FindOrAdd(Key, AnimInstance->SharedPose);
+			LivePoses.Add(AnimInstance->SharedPose.Get());
+		}
+		else
+		{
+			AnimInstance->PoseSharingRole = ELLPoseSharingRole::None;
+			AnimInstance->SharedPose.Reset();
+		}
+	}
+
+	for (ULLAnimInstance* AnimInstance : AnimInstances)
+	{
+		// A follower whose own graph drifted off the leader's time, LOD or state picks a pose to share again, like a new one.
+		// Before the leader's first pose there's nothing to compare against yet.
+		if (AnimInstance->PoseSharingRole == ELLPoseSharingRole::Follower &&
+			(AnimInstance->bPoseSharingDiverged || !LivePoses.Contains(AnimInstance->SharedPose.Get()) ||
+			(AnimInstance->SharedPose->IsReadable() && !AnimInstance->IsInStepWithSharedPose())))
+		{
+			AnimInstance->PoseSharingRole = ELLPoseSharingRole::None;
+			AnimInstance->SharedPose.Reset();
+		}
+
+		FLLPoseSharingKey Key;
+		if (AnimInstance->PoseSharingRole != ELLPoseSharingRole::None || !AnimInstance->GetPoseSharingKey(Key))
+		{
+			continue;
+		}
+
+		AnimInstance->bPoseSharingDiverged = false;
+		if (const TSharedPtr<FLLSharedPose>* Pose = PosesByKey.Find(Key))
+		{
+			AnimInstance->PoseSharingRole = ELLPoseSharingRole::Follower;
+			AnimInstance->SharedPose = *Pose;
+		}
+		else
+		{
+			// Followers that join a leader before its first pose keep running their own graph until it publishes one.
+			AnimInstance->PoseSharingRole = ELLPoseSharingRole::Leader;
+			AnimInstance->SharedPose = MakeShared<FLLSharedPose>(Key);
+			PosesByKey.Add(Key, AnimInstance->SharedPose);
+		}
+	}
+}
+
+float ULLLocomotionSubsystem::ComputeSignificance(int32 Index, TConstArrayView<FLLViewPoint> ViewPoints) const
+{
+	const USkeletalMeshComponent* SkelMeshComponent = AnimInstances[Index]->GetSkelMeshComponent();
+	if (ViewPoints.IsEmpty() || !SkelMeshComponent)
+	{
+		return 1.0f;
+	}
+
+	const ULLLocomotionSettings* Settings = GetDefault<ULLLocomotionSettings>();
+	const FBoxSphereBounds& Bounds = SkelMeshComponent->Bounds;
+
+	float Significance = 0;
+	for (const FLLViewPoint& ViewPoint : ViewPoints)
+	{
+		const double Distance = FVector::Dist(Bounds.Origin, ViewPoint.Location);
+		if (Distance > Settings->FidelityMaxDistance)
+		{
+			continue;
+		}
+
+		// Screen size of the bounding sphere, radius over half the view height at that distance
+		const float ScreenSize = Distance > Bounds.SphereRadius ?
+			static_cast<float>(Bounds.SphereRadius / (Distance * FMath::Max(ViewPoint.TanHalfFOV, UE_KINDA_SMALL_NUMBER))) : 1.0f;
+		Significance = FMath::Max(Significance, FMath::Min(ScreenSize, 1.0f));
+	}
+
+	return SkelMeshComponent->WasRecentlyRendered() ? Significance : Significance * Settings->HiddenSignificanceScale;
+}
+
+int32 ULLLocomotionSubsystem::SelectFramesPerUpdate(const FVector& Location, TConstArrayView<FLLViewPoint> ViewPoints) const
+{
+	if (ViewPoints.IsEmpty())
+	{
+		return 1;
+	}
+
+	double MinDistanceSquared = UE_DOUBLE_BIG_NUMBER;
+	for (const FLLViewPoint& ViewPoint : ViewPoints)
+	{
+		MinDistanceSquared = FMath::Min(MinDistanceSquared, FVector::DistSquared(Location, ViewPoint.Location));
+	}
+
+	int32 FramesPerUpdate = 1;
+	float TierDistance = -1;
+	for (const FLLUpdateRateTier& Tier : GetDefault<ULLLocomotionSettings>()->UpdateRateTiers)
+	{
+		if (Tier.MinDistance > TierDistance && FMath::Square(Tier.MinDistance) <= MinDistanceSquared)
+		{
+			TierDistance = Tier.MinDistance;
+			FramesPerUpdate = Tier.FramesPerUpdate;
+		}
+	}
+	return FMath::Max(FramesPerUpdate, 1);
+}
@@ -0,0 +1,206 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineBaseTypes.h"
+#include "WorldCollision.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LLLocomotionMath.h"
+#include "LLLocomotionRecorder.h"
+#include "LyraLocomotionTypes.h"
+#include "LLLocomotionSubsystem.generated.h"
+
+class ACharacter;
+class ULLAnimInstance;
+class ULLLocomotionTuning;
+class ULLLocomotionSubsystem;
+
+USTRUCT()
+struct FLLLocomotionBatchTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	ULLLocomotionSubsystem* Target = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FLLLocomotionBatchTickFunction> : public TStructOpsTypeTraitsBase2<FLLLocomotionBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+// Downward trace from the capsule center used to measure the distance to the ground while airborne.
+struct FLLGroundTrace
+{
+	static constexpr float GroundTraceDistance = 100000.0f;
+
+	explicit FLLGroundTrace(const ACharacter* Owner);
+
+	static float GetGroundDistance(const FHitResult& HitResult, float CapsuleHalfHeight);
+
+	FVector Start;
+	FVector End;
+	ECollisionChannel CollisionChannel;
+	FCollisionQueryParams QueryParams;
+	FCollisionResponseParams ResponseParams;
+	float CapsuleHalfHeight;
+};
+
+struct FLLGroundTraceState
+{
+	FTraceHandle PendingTrace;
+	double PendingTraceZ = 0;
+	double PendingTraceTime = 0;
+
+	// Last known ground distance and the actor height and time it was measured at
+	float GroundDistance = 0;
+	double GroundDistanceZ = 0;
+	double GroundDistanceTime = -UE_BIG_NUMBER;
+
+	bool HasGroundDistance() const { return GroundDistanceTime > -UE_BIG_NUMBER; }
+};
+
+struct FLLViewPoint
+{
+	FVector Location;
+	float TanHalfFOV = 1;
+};
+
+// Update rate and fidelity the animation budget gives one instance
+struct FLLBudgetLevel
+{
+	ELLLocomotionFidelity Fidelity = ELLLocomotionFidelity::Full;
+	int32 FramesPerUpdate = 1;
+};
+
+struct FLLUpdateRateState
+{
+	float AccumulatedDeltaTime = 0;
+	int32 FramesPerUpdate = 1;
+	uint32 Phase = 0;
+};
+
+using FLLKinematics = LLLocomotionMath::TLLKinematics<ECardinalDirection, ERootYawOffsetMode>;
+
+// Per-character kinematics, one array per part so each pass over the batch only touches what it reads.
+// Every array has one entry per registered anim instance.
+struct FLLKinematicsBatch
+{
+	// Time since the last update of the instance, only slots flagged for this frame are computed
+	TArray<float> DeltaTime;
+	TArray<uint8> bUpdateThisFrame;
+
+	// Inputs gathered from the owner
+	TArray<LLLocomotionMath::FLLKinematicsInputs> Inputs;
+
+	// Tuning of the anim instance, set on registration
+	TArray<LLLocomotionMath::FLLKinematicsTuning> Tuning;
+
+	// State carried between updates and the outputs, with the root yaw offset gathered from the anim instance
+	TArray<FLLKinematics> State;
+
+	int32 Num() const { return State.Num(); }
+	int32 Add();
+	void RemoveAtSwap(int32 Index);
+
+private:
+	template <typename FuncType>
+	void ForEachArray(FuncType&& Func);
+};
+
+UCLASS()
+class LYRALOCOMOTION_API ULLLocomotionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void RegisterAnimInstance(ULLAnimInstance* AnimInstance);
+	void UnregisterAnimInstance(ULLAnimInstance* AnimInstance);
+
+	// Ground distance extrapolated from the latest async trace, false when there is no result within the latency tolerance
+	// and no trace in flight to replace it.
+	bool GetAsyncGroundDistance(int32 Slot, double ActorZ, float& OutGroundDistance) const;
+	// Async traces keep the ground distance of the slot, GetAsyncGroundDistance only fails before its first result.
+	bool HasAsyncGroundDistance(int32 Slot) const { return bAsyncGroundTraces && GroundTraces.IsValidIndex(Slot) && GroundTraces[Slot].HasGroundDistance(); }
+	void SetGroundDistance(int32 Slot, double ActorZ, float GroundDistance);
+
+	// Significance of the character to the local viewers computed this frame, 1 when fidelity tiers are off
+	float GetSignificance(int32 Slot) const { return Significances.IsValidIndex(Slot) ? Significances[Slot] : 1.0f; }
+
+	// Logs the bytes per registered anim instance of each class, next to what they took with their own copy of the tuning
+	void LogMemoryReport() const;
+
+	// Records the locomotion inputs of every registered anim instance to Path until stopped, see LLLocomotionRecording.h
+	bool StartRecordingInputs(const FString& Path);
+	void StopRecordingInputs();
+	FLLLocomotionRecorder* GetInputRecorder() const { return InputRecorder.Get(); }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	friend struct FLLLocomotionBatchTickFunction;
+
+	void TickBatch(float DeltaTime);
+	void UpdateGameplayOnly(float DeltaTime);
+	void UpdateEveryFrame(float DeltaTime);
+	void UpdateKinematics();
+	void GatherKinematics();
+	void ComputeKinematics(int32 Begin, int32 End);
+	void ScatterKinematics();
+	void UpdateGroundTraces(float DeltaTime);
+	void GatherViewPoints(TArray<FLLViewPoint, TInlineAllocator<4>>& OutViewPoints) const;
+	void UpdateRates(float DeltaTime, TConstArrayView<FLLViewPoint> ViewPoints);
+	void UpdateSignificances(TConstArrayView<FLLViewPoint> ViewPoints);
+	void UpdateBudget();
+	void UpdateFidelity();
+	void UpdatePoseSharing();
+	int32 SelectFramesPerUpdate(const FVector& Location, TConstArrayView<FLLViewPoint> ViewPoints) const;
+	float ComputeSignificance(int32 Index, TConstArrayView<FLLViewPoint> ViewPoints) const;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ULLAnimInstance>> AnimInstances;
+
+	TArray<ACharacter*> Owners;
+
+	FLLKinematicsBatch Kinematics;
+
+	TArray<FLLGroundTraceState> GroundTraces;
+
+	TArray<FLLUpdateRateState> UpdateRateStates;
+
+	TArray<float> Significances;
+
+	TArray<FLLBudgetLevel> BudgetLevels;
+	TArray<int32> BudgetOrder;
+
+	// Running cost in milliseconds of one update per fidelity tier, fed back once per budget from the average measured update of the tier
+	float UpdateCostMs[3] = { 0.15f, 0.1f, 0.05f };
+
+	bool bBatchKinematics = false;
+	bool bControlUpdateRate = false;
+	bool bAsyncGroundTraces = false;
+	bool bFidelityTiers = false;
+	bool bAnimationBudget = false;
+	bool bPipelineUpdate = false;
+	bool bPoseSharing = false;
+	bool bGameplayOnly = false;
+	bool bMeshesWaitForBatch = false;
+	bool bBatchWaitsForMovement = false;
+	bool bDisableUpdateRateOptimizations = false;
+
+	FLLLocomotionBatchTickFunction BatchTickFunction;
+
+	TUniquePtr<FLLLocomotionRecorder> InputRecorder;
+};
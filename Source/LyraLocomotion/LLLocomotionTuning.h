@@ -0,0 +1,41 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "LLLocomotionMath.h"
+#include "LLLocomotionTuning.generated.h"
+
+// Tuning values shared by every ULLAnimInstance of an archetype, which only keeps a pointer to them.
+// Anim instances without one use the class defaults.
+UCLASS(BlueprintType, Const)
+class LYRALOCOMOTION_API ULLLocomotionTuning : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditDefaultsOnly, Category = "Stride Warping")
+	float StrideWarpingBlendInStartOffset = 0.15f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stride Warping")
+	float StrideWarpingBlendInDurationScaled = 0.2f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Velocity Data")
+	float CardinalDirectionDeadZone = 10.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Play Rate")
+	FVector2D PlayRateClampCycle { 0.8f, 1.2f };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Play Rate")
+	FVector2D PlayRateClampStartsPivots { 0.6f, 5.0f };
+
+	UPROPERTY(EditDefaultsOnly, Category = "Turn In Place")
+	FVector2D RootYawOffsetAngleClamp { -120, 100 };
+
+	// The part the batched kinematics and LLLocomotionReplay read
+	LLLocomotionMath::FLLKinematicsTuning GetKinematicsTuning() const
+	{
+		return { CardinalDirectionDeadZone, static_cast<float>(RootYawOffsetAngleClamp.X), static_cast<float>(RootYawOffsetAngleClamp.Y) };
+	}
+};
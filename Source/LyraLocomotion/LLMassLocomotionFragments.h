@@ -0,0 +1,125 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "LLLocomotionMath.h"
+#include "LyraLocomotionTypes.h"
+#include "LLMassLocomotionFragments.generated.h"
+
+class UAnimSequence;
+class ULLLocomotionTuning;
+
+// States of the locomotion state machine of the ABP a crowd agent goes through, without jumps and idle breaks
+UENUM()
+enum class ELLMassLocomotionState : uint8
+{
+	Idle,
+	TurnInPlace,
+	TurnInPlaceRecovery,
+	Start,
+	Cycle,
+	Stop,
+	Pivot
+};
+
+// Locomotion state of a crowd agent ULLMassLocomotionProcessor carries from one frame to the next,
+// the subset of ULLAnimInstance the state transitions, cardinal directions and root yaw offset need
+USTRUCT()
+struct LYRALOCOMOTION_API FLLMassLocomotionFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	LLLocomotionMath::FLLSpringState RootYawOffsetSpringState;
+	LLLocomotionMath::FLLGroundMovementPrediction GroundMovementPrediction;
+	FVector2f PivotDirection2D { 0, 0 };
+	float PrevYaw = 0;
+	float RootYawOffset = 0;
+	float TurnYawCurveValue = 0;
+	float TurnInPlaceDirection = 0;
+	float LastPivotTime = 0;
+
+	ELLMassLocomotionState State = ELLMassLocomotionState::Idle;
+	ERootYawOffsetMode RootYawOffsetMode = ERootYawOffsetMode::BlendOut;
+	ECardinalDirection LocalVelocityDirection = ECardinalDirection::Forward;
+	ECardinalDirection LocalVelocityDirectionNoOffset = ECardinalDirection::Forward;
+	ECardinalDirection CardinalDirectionFromAcceleration = ECardinalDirection::Forward;
+	ECardinalDirection StartDirection = ECardinalDirection::Forward;
+	ECardinalDirection PivotInitialDirection = ECardinalDirection::Forward;
+	// Octants of the same directions, used by 8-way sets
+	uint8 LocalVelocityOctant = 0;
+	uint8 LocalVelocityOctantNoOffset = 0;
+	uint8 OctantFromAcceleration = 0;
+	bool bWasMovingLastUpdate = false;
+	bool bIsFirstUpdate = true;
+};
+
+// Sequence and playback time of a crowd agent, what an instanced or shared pose renderer plays for it.
+// The sequence is kept alive by the FLLMassLocomotionParameters of the agent.
+USTRUCT()
+struct LYRALOCOMOTION_API FLLMassAnimationPlaybackFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	const UAnimSequence* Sequence = nullptr;
+	float Time = 0;
+	float PlayRate = 1;
+	float RootYawOffset = 0;
+
+	// Set on the frame the sequence changed, for a renderer that blends from the previous pose
+	bool bSequenceChanged = false;
+};
+
+// Anim set and tuning shared by every agent of an entity config, the counterpart of the Anim Set and Settings of ULLAnimInstance
+USTRUCT()
+struct LYRALOCOMOTION_API FLLMassLocomotionParameters : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Anim Set - Idle")
+	TObjectPtr<UAnimSequence> IdleAnimSequence;
+
+	UPROPERTY(EditAnywhere, Category = "Anim Set - Turn in Place")
+	TObjectPtr<UAnimSequence> TurnInPlaceLeftAnimSequence;
+
+	UPROPERTY(EditAnywhere, Category = "Anim Set - Turn in Place")
+	TObjectPtr<UAnimSequence> TurnInPlaceRightAnimSequence;
+
+	UPROPERTY(EditAnywhere, Category = "Anim Set - Starts")
+	FCardinalDirections JogStartCardinals;
+
+	UPROPERTY(EditAnywhere, Category = "Anim Set - Jog")
+	FCardinalDirections JogCardinals;
+
+	UPROPERTY(EditAnywhere, Category = "Anim Set - Stops")
+	FCardinalDirections JogStopCardinals;
+
+	UPROPERTY(EditAnywhere, Category = "Anim Set - Pivots")
+	FCardinalDirections JogPivotCardinals;
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FName LocomotionDistanceCurveName = TEXT("Distance");
+
+	// The class defaults of ULLLocomotionTuning when not set
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TObjectPtr<ULLLocomotionTuning> Tuning;
+
+	// Root yaw offset an idle agent turns in place at
+	UPROPERTY(EditAnywhere, Category = "Turn In Place", meta = (ClampMin = "0", ClampMax = "180", Units = "deg"))
+	float TurnInPlaceAngle = 50.0f;
+
+	// Movement of the agents the stop and pivot predictions would otherwise read from a character movement component.
+	// Agents accelerate toward their desired velocity at MaxAcceleration.
+	UPROPERTY(EditAnywhere, Category = "Movement", meta = (ClampMin = "0"))
+	float MaxAcceleration = 2048.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Movement", meta = (ClampMin = "0"))
+	float GroundFriction = 8.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Movement", meta = (ClampMin = "0"))
+	float BrakingFrictionFactor = 2.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Movement", meta = (ClampMin = "0"))
+	float BrakingDecelerationWalking = 2048.0f;
+};
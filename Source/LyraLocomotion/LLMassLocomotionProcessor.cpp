@@ -0,0 +1,478 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLMassLocomotionProcessor.h"
+#include "Animation/AnimSequence.h"
+#include "MassCommonFragments.h"
+#include "MassCommonTypes.h"
+#include "MassExecutionContext.h"
+#include "MassMovementFragments.h"
+#include "LLDistanceMatching.h"
+#include "LLLocomotionProfiler.h"
+#include "LLLocomotionTuning.h"
+#include "LLMassLocomotionFragments.h"
+
+namespace
+{
+	const FName TurnYawWeightCurveName(TEXT("TurnYawWeight"));
+	const FName RemainingTurnYawCurveName(TEXT("RemainingTurnYaw"));
+
+	// Time left in a start or pivot at which the cycle takes over, the blend time of those transitions in the ABP
+	constexpr float TransitionBlendTime = 0.2f;
+
+	// What ULLAnimInstance derives from the snapshot of its character, here from the movement fragments of an agent
+	struct FLLMassAgentKinematics
+	{
+		FVector2f Velocity2D { 0, 0 };
+		FVector2f Acceleration2D { 0, 0 };
+		FVector2f LocalVelocity2D { 0, 0 };
+		FVector2f LocalAcceleration2D { 0, 0 };
+		float DeltaTime = 0;
+		float DisplacementSinceLastUpdate = 0;
+		float DisplacementSpeed = 0;
+		float YawDeltaSinceLastUpdate = 0;
+		bool bHasVelocity = false;
+		bool bHasAcceleration = false;
+	};
+
+	const UAnimSequence* SelectDirectionalAnimation(const FCardinalDirections& Cardinals, ECardinalDirection Direction, uint8 Octant)
+	{
+		return Cardinals.Select(Direction, Octant);
+	}
+
+	float GetPlayLength(const UAnimSequence* Sequence)
+	{
+		return Sequence ? Sequence->GetPlayLength() : 0;
+	}
+
+	void SetSequence(FLLMassAnimationPlaybackFragment& Playback, const UAnimSequence* Sequence)
+	{
+		if (Playback.Sequence != Sequence)
+		{
+			Playback.Sequence = Sequence;
+			Playback.bSequenceChanged = true;
+		}
+	}
+
+	void AdvanceTime(FLLMassAnimationPlaybackFragment& Playback, float DeltaTime, bool bLooping)
+	{
+		const float PlayLength = GetPlayLength(Playback.Sequence);
+		Playback.Time += Playback.PlayRate * DeltaTime;
+		if (PlayLength <= 0)
+		{
+			Playback.Time = 0;
+		}
+		else if (bLooping)
+		{
+			Playback.Time = FMath::Fmod(Playback.Time, PlayLength);
+		}
+		else
+		{
+			Playback.Time = FMath::Min(Playback.Time, PlayLength);
+		}
+	}
+
+	bool IsFinished(const FLLMassAnimationPlaybackFragment& Playback, float TimeLeft = 0)
+	{
+		return Playback.Time >= GetPlayLength(Playback.Sequence) - TimeLeft;
+	}
+
+	// Same as ULLAnimInstance::IsMovingPerpendicularToInitialPivot
+	bool IsMovingPerpendicularToInitialPivot(const FLLMassLocomotionFragment& Locomotion)
+	{
+		const auto IsForwardOrBackward = [](ECardinalDirection Direction)
+		{
+			return Direction == ECardinalDirection::Forward || Direction == ECardinalDirection::Backward;
+		};
+		return IsForwardOrBackward(Locomotion.PivotInitialDirection) != IsForwardOrBackward(Locomotion.LocalVelocityDirection);
+	}
+
+	// UpdateLocationData, UpdateRotationData, UpdateVelocityData and UpdateAccelerationData of ULLAnimInstance
+	FLLMassAgentKinematics UpdateKinematics(const FLLMassLocomotionParameters& Parameters, const ULLLocomotionTuning& Tuning,
+		const FTransform& Transform, const FVector& Velocity, const FVector& DesiredVelocity, float DeltaTime, FLLMassLocomotionFragment& Locomotion)
+	{
+		FLLMassAgentKinematics Kinematics;
+		Kinematics.DeltaTime = DeltaTime;
+
+		const FQuat Rotation = Transform.GetRotation();
+		const FVector Forward = Rotation.GetForwardVector();
+		const FVector Right = Rotation.GetRightVector();
+		const float Yaw = static_cast<float>(Rotation.Rotator().Yaw);
+
+		Kinematics.Velocity2D = FVector2f(static_cast<float>(Velocity.X), static_cast<float>(Velocity.Y));
+		Kinematics.DisplacementSpeed = Kinematics.Velocity2D.Size();
+		Kinematics.DisplacementSinceLastUpdate = Locomotion.bIsFirstUpdate ? 0 : Kinematics.DisplacementSpeed * DeltaTime;
+		Kinematics.YawDeltaSinceLastUpdate = Locomotion.bIsFirstUpdate ? 0 : Yaw - Locomotion.PrevYaw;
+		Locomotion.PrevYaw = Yaw;
+
+		Kinematics.LocalVelocity2D = FVector2f(
+			static_cast<float>(FVector::DotProduct(Velocity, Forward)), static_cast<float>(FVector::DotProduct(Velocity, Right)));
+		Kinematics.bHasVelocity = !FMath::IsNearlyZero(Kinematics.LocalVelocity2D.SizeSquared());
+
+		const float ForwardX = static_cast<float>(Forward.X);
+		const float ForwardY = static_cast<float>(Forward.Y);
+		const float RightX = static_cast<float>(Right.X);
+		const float RightY = static_cast<float>(Right.Y);
+
+		const float LocalVelocityDirectionAngle = LLLocomotionMath::CalculateDirection2D(
+			Kinematics.Velocity2D.X, Kinematics.Velocity2D.Y, ForwardX, ForwardY, RightX, RightY);
+		const float DeadZone = Tuning.CardinalDirectionDeadZone;
+		Locomotion.LocalVelocityDirection = LLLocomotionMath::SelectCardinalDirectionFromAngle(
+			LocalVelocityDirectionAngle - Locomotion.RootYawOffset, DeadZone, Locomotion.LocalVelocityDirection, Locomotion.bWasMovingLastUpdate);
+		Locomotion.LocalVelocityDirectionNoOffset = LLLocomotionMath::SelectCardinalDirectionFromAngle(
+			LocalVelocityDirectionAngle, DeadZone, Locomotion.LocalVelocityDirectionNoOffset, Locomotion.bWasMovingLastUpdate);
+		Locomotion.LocalVelocityOctant = LLLocomotionMath::SelectDirectionFromAngle<8>(
+			LocalVelocityDirectionAngle - Locomotion.RootYawOffset, DeadZone, Locomotion.LocalVelocityOctant, Locomotion.bWasMovingLastUpdate);
+		Locomotion.LocalVelocityOctantNoOffset = LLLocomotionMath::SelectDirectionFromAngle<8>(
+			LocalVelocityDirectionAngle, DeadZone, Locomotion.LocalVelocityOctantNoOffset, Locomotion.bWasMovingLastUpdate);
+		Locomotion.bWasMovingLastUpdate = !Kinematics.LocalVelocity2D.IsZero();
+
+		// Agents have no input acceleration, they accelerate toward the velocity they want
+		const FVector2f DesiredVelocity2D(static_cast<float>(DesiredVelocity.X), static_cast<float>(DesiredVelocity.Y));
+		const FVector2f DesiredDirection2D = DesiredVelocity2D.GetSafeNormal();
+		Kinematics.Acceleration2D = DesiredDirection2D * Parameters.MaxAcceleration;
+		Kinematics.LocalAcceleration2D = FVector2f(
+			Kinematics.Acceleration2D.X * ForwardX + Kinematics.Acceleration2D.Y * ForwardY,
+			Kinematics.Acceleration2D.X * RightX + Kinematics.Acceleration2D.Y * RightY);
+		Kinematics.bHasAcceleration = !FMath::IsNearlyZero(Kinematics.LocalAcceleration2D.SizeSquared());
+
+		Locomotion.PivotDirection2D = FMath::Lerp(Locomotion.PivotDirection2D, DesiredDirection2D, 0.5f).GetSafeNormal();
+		const float PivotAngle = LLLocomotionMath::CalculateDirection2D(
+			Locomotion.PivotDirection2D.X, Locomotion.PivotDirection2D.Y, ForwardX, ForwardY, RightX, RightY);
+		Locomotion.CardinalDirectionFromAcceleration = LLLocomotionMath::GetOppositeCardinalDirection(
+			LLLocomotionMath::SelectCardinalDirectionFromAngle(PivotAngle, DeadZone, ECardinalDirection::Forward, false));
+		Locomotion.OctantFromAcceleration = LLLocomotionMath::GetOppositeDirection<8>(
+			LLLocomotionMath::SelectDirectionFromAngle<8>(PivotAngle, DeadZone, 0, false));
+
+		return Kinematics;
+	}
+
+	// ULLAnimInstance::UpdateRootYawOffset with the mode the states set on the last update
+	void UpdateRootYawOffset(const ULLLocomotionTuning& Tuning, const FLLMassAgentKinematics& Kinematics, FLLMassLocomotionFragment& Locomotion)
+	{
+		const FVector2D& AngleClamp = Tuning.RootYawOffsetAngleClamp;
+		switch (Locomotion.RootYawOffsetMode)
+		{
+		case ERootYawOffsetMode::Accumulate:
+			Locomotion.RootYawOffset = LLLocomotionMath::ClampRootYawOffset(
+				Locomotion.RootYawOffset - Kinematics.YawDeltaSinceLastUpdate, AngleClamp.X, AngleClamp.Y);
+			break;
+		case ERootYawOffsetMode::BlendOut:
+			Locomotion.RootYawOffset = LLLocomotionMath::ClampRootYawOffset(
+				LLLocomotionMath::BlendOutRootYawOffset(Locomotion.RootYawOffset, Locomotion.RootYawOffsetSpringState, Kinematics.DeltaTime),
+				AngleClamp.X, AngleClamp.Y);
+			break;
+		default:
+			break;
+		}
+		Locomotion.RootYawOffsetMode = ERootYawOffsetMode::BlendOut;
+	}
+
+	// ULLAnimInstance::ProcessTurnYawCurve sampling the turn in place sequence, returns the turn yaw weight
+	float ProcessTurnYawCurve(const ULLLocomotionTuning& Tuning, const FLLMassAnimationPlaybackFragment& Playback, FLLMassLocomotionFragment& Locomotion)
+	{
+		const float PreviousTurnYawCurveValue = Locomotion.TurnYawCurveValue;
+		const float TurnYawWeight = Playback.Sequence ? Playback.Sequence->EvaluateCurveData(TurnYawWeightCurveName, Playback.Time) : 0;
+		if (FMath::IsNearlyZero(TurnYawWeight))
+		{
+			Locomotion.TurnYawCurveValue = 0;
+			return 0;
+		}
+
+		const float RemainingTurnYaw = Playback.Sequence->EvaluateCurveData(RemainingTurnYawCurveName, Playback.Time);
+		Locomotion.TurnYawCurveValue = RemainingTurnYaw / TurnYawWeight;
+		if (PreviousTurnYawCurveValue != 0)
+		{
+			const FVector2D& AngleClamp = Tuning.RootYawOffsetAngleClamp;
+			Locomotion.RootYawOffset = LLLocomotionMath::ClampRootYawOffset(
+				Locomotion.RootYawOffset - (Locomotion.TurnYawCurveValue - PreviousTurnYawCurveValue), AngleClamp.X, AngleClamp.Y);
+		}
+		return TurnYawWeight;
+	}
+
+	// Set up functions of the states and anim nodes of ULLAnimInstance
+	void EnterState(ELLMassLocomotionState State, const FLLMassLocomotionParameters& Parameters, const FLLMassAgentKinematics& Kinematics,
+		FLLMassLocomotionFragment& Locomotion, FLLMassAnimationPlaybackFragment& Playback)
+	{
+		Locomotion.State = State;
+		Playback.Time = 0;
+		Playback.PlayRate = 1;
+
+		switch (State)
+		{
+		case ELLMassLocomotionState::Idle:
+			SetSequence(Playback, Parameters.IdleAnimSequence);
+			break;
+		case ELLMassLocomotionState::TurnInPlace:
+			Locomotion.TurnInPlaceDirection = FMath::Sign(Locomotion.RootYawOffset) * -1.f;
+			Locomotion.TurnYawCurveValue = 0;
+			SetSequence(Playback, Locomotion.TurnInPlaceDirection > 0 ? Parameters.TurnInPlaceRightAnimSequence : Parameters.TurnInPlaceLeftAnimSequence);
+			break;
+		case ELLMassLocomotionState::Start:
+			Locomotion.StartDirection = Locomotion.LocalVelocityDirection;
+			SetSequence(Playback, SelectDirectionalAnimation(Parameters.JogStartCardinals, Locomotion.LocalVelocityDirection, Locomotion.LocalVelocityOctant));
+			break;
+		case ELLMassLocomotionState::Cycle:
+			SetSequence(Playback, SelectDirectionalAnimation(Parameters.JogCardinals, Locomotion.LocalVelocityDirectionNoOffset, Locomotion.LocalVelocityOctantNoOffset));
+			break;
+		case ELLMassLocomotionState::Stop:
+			SetSequence(Playback, SelectDirectionalAnimation(Parameters.JogStopCardinals, Locomotion.LocalVelocityDirection, Locomotion.LocalVelocityOctant));
+			if (!(Kinematics.bHasVelocity && !Kinematics.bHasAcceleration))
+			{
+				FLLDistanceMatching::DistanceMatchToTarget(Playback.Sequence, 0, Parameters.LocomotionDistanceCurveName, Playback.Time);
+			}
+			break;
+		case ELLMassLocomotionState::Pivot:
+			Locomotion.PivotInitialDirection = Locomotion.LocalVelocityDirection;
+			Locomotion.LastPivotTime = TransitionBlendTime;
+			SetSequence(Playback, SelectDirectionalAnimation(Parameters.JogPivotCardinals, Locomotion.CardinalDirectionFromAcceleration, Locomotion.OctantFromAcceleration));
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Transition rules of the locomotion state machine of the ABP
+	ELLMassLocomotionState SelectNextState(const FLLMassLocomotionParameters& Parameters, const FLLMassAgentKinematics& Kinematics,
+		const FLLMassLocomotionFragment& Locomotion, const FLLMassAnimationPlaybackFragment& Playback, float TurnYawWeight)
+	{
+		const bool bIsPivoting = Kinematics.bHasAcceleration && FVector2f::DotProduct(Kinematics.LocalVelocity2D, Kinematics.LocalAcceleration2D) < 0;
+
+		switch (Locomotion.State)
+		{
+		case ELLMassLocomotionState::Idle:
+			if (Kinematics.bHasAcceleration)
+			{
+				return ELLMassLocomotionState::Start;
+			}
+			if (FMath::Abs(Locomotion.RootYawOffset) > Parameters.TurnInPlaceAngle)
+			{
+				return ELLMassLocomotionState::TurnInPlace;
+			}
+			break;
+		case ELLMassLocomotionState::TurnInPlace:
+			if (Kinematics.bHasAcceleration)
+			{
+				return ELLMassLocomotionState::Start;
+			}
+			if ((Playback.Time > 0 && FMath::IsNearlyZero(TurnYawWeight)) || IsFinished(Playback))
+			{
+				return ELLMassLocomotionState::TurnInPlaceRecovery;
+			}
+			break;
+		case ELLMassLocomotionState::TurnInPlaceRecovery:
+			if (Kinematics.bHasAcceleration)
+			{
+				return ELLMassLocomotionState::Start;
+			}
+			if (FMath::Abs(Locomotion.RootYawOffset) > Parameters.TurnInPlaceAngle)
+			{
+				return ELLMassLocomotionState::TurnInPlace;
+			}
+			if (IsFinished(Playback))
+			{
+				return ELLMassLocomotionState::Idle;
+			}
+			break;
+		case ELLMassLocomotionState::Start:
+			if (!Kinematics.bHasAcceleration)
+			{
+				return ELLMassLocomotionState::Stop;
+			}
+			if (Locomotion.LocalVelocityDirection != Locomotion.StartDirection || IsFinished(Playback, TransitionBlendTime))
+			{
+				return ELLMassLocomotionState::Cycle;
+			}
+			break;
+		case ELLMassLocomotionState::Cycle:
+			if (!Kinematics.bHasAcceleration)
+			{
+				return ELLMassLocomotionState::Stop;
+			}
+			if (bIsPivoting)
+			{
+				return ELLMassLocomotionState::Pivot;
+			}
+			break;
+		case ELLMassLocomotionState::Stop:
+			if (Kinematics.bHasAcceleration)
+			{
+				return ELLMassLocomotionState::Start;
+			}
+			if (!Kinematics.bHasVelocity && IsFinished(Playback))
+			{
+				return ELLMassLocomotionState::Idle;
+			}
+			break;
+		case ELLMassLocomotionState::Pivot:
+			if (!Kinematics.bHasAcceleration)
+			{
+				return ELLMassLocomotionState::Stop;
+			}
+			if (!bIsPivoting && (IsMovingPerpendicularToInitialPivot(Locomotion) || IsFinished(Playback, TransitionBlendTime)))
+			{
+				return ELLMassLocomotionState::Cycle;
+			}
+			break;
+		default:
+			break;
+		}
+		return Locomotion.State;
+	}
+
+	// Update functions of the states and anim nodes of ULLAnimInstance, returns the turn yaw weight while turning in place
+	float UpdateState(const FLLMassLocomotionParameters& Parameters, const ULLLocomotionTuning& Tuning, const FLLMassAgentKinematics& Kinematics,
+		FLLMassLocomotionFragment& Locomotion, FLLMassAnimationPlaybackFragment& Playback)
+	{
+		const FName CurveName = Parameters.LocomotionDistanceCurveName;
+		const float DeltaTime = Kinematics.DeltaTime;
+
+		switch (Locomotion.State)
+		{
+		case ELLMassLocomotionState::Idle:
+			Locomotion.RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
+			AdvanceTime(Playback, DeltaTime, true);
+			break;
+		case ELLMassLocomotionState::TurnInPlace:
+			Locomotion.RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
+			AdvanceTime(Playback, DeltaTime, false);
+			return ProcessTurnYawCurve(Tuning, Playback, Locomotion);
+		case ELLMassLocomotionState::TurnInPlaceRecovery:
+			Locomotion.RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
+			AdvanceTime(Playback, DeltaTime, false);
+			break;
+		case ELLMassLocomotionState::Start:
+			{
+				Locomotion.RootYawOffsetMode = ERootYawOffsetMode::Hold;
+				const float StrideWarpingStartAlpha = FMath::GetMappedRangeValueClamped(
+					FVector2f(0, Tuning.StrideWarpingBlendInDurationScaled), FVector2f(0, 1), Playback.Time - Tuning.StrideWarpingBlendInStartOffset);
+				const FVector2D PlayRateClamp(
+					FMath::Lerp(Tuning.StrideWarpingBlendInDurationScaled, static_cast<float>(Tuning.PlayRateClampStartsPivots.X), StrideWarpingStartAlpha),
+					Tuning.PlayRateClampStartsPivots.Y);
+				FLLDistanceMatching::AdvanceTimeByDistanceMatching(Playback.Sequence, GetPlayLength(Playback.Sequence), false,
+					DeltaTime, Kinematics.DisplacementSinceLastUpdate, CurveName, PlayRateClamp, Playback.Time);
+			}
+			break;
+		case ELLMassLocomotionState::Cycle:
+			{
+				const UAnimSequence* Sequence = SelectDirectionalAnimation(Parameters.JogCardinals, Locomotion.LocalVelocityDirectionNoOffset, Locomotion.LocalVelocityOctantNoOffset);
+				if (Sequence != Playback.Sequence)
+				{
+					// Cycles are authored in sync, so the new direction picks up where the previous one was
+					const float PlayLength = GetPlayLength(Playback.Sequence);
+					const float Phase = PlayLength > 0 ? Playback.Time / PlayLength : 0;
+					SetSequence(Playback, Sequence);
+					Playback.Time = Phase * GetPlayLength(Sequence);
+				}
+				FLLDistanceMatching::GetPlayRateToMatchSpeed(Sequence, Kinematics.DisplacementSpeed, Tuning.PlayRateClampCycle, Playback.PlayRate);
+				AdvanceTime(Playback, DeltaTime, true);
+			}
+			break;
+		case ELLMassLocomotionState::Stop:
+			Locomotion.RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
+			if (Kinematics.bHasVelocity && !Kinematics.bHasAcceleration)
+			{
+				const float DistanceToMatch = Locomotion.GroundMovementPrediction.StopDistance(Kinematics.Velocity2D.X, Kinematics.Velocity2D.Y,
+					false, 0, Parameters.GroundFriction, Parameters.BrakingFrictionFactor, Parameters.BrakingDecelerationWalking);
+				if (DistanceToMatch > 0)
+				{
+					FLLDistanceMatching::DistanceMatchToTarget(Playback.Sequence, DistanceToMatch, CurveName, Playback.Time);
+					break;
+				}
+			}
+			AdvanceTime(Playback, DeltaTime, false);
+			break;
+		case ELLMassLocomotionState::Pivot:
+			if (Locomotion.LastPivotTime > 0)
+			{
+				Locomotion.LastPivotTime -= DeltaTime;
+				SetSequence(Playback, SelectDirectionalAnimation(Parameters.JogPivotCardinals, Locomotion.CardinalDirectionFromAcceleration, Locomotion.OctantFromAcceleration));
+			}
+			if (FVector2f::DotProduct(Kinematics.LocalVelocity2D, Kinematics.LocalAcceleration2D) < 0)
+			{
+				const float DistanceToTarget = Locomotion.GroundMovementPrediction.PivotDistance(Kinematics.Acceleration2D.X, Kinematics.Acceleration2D.Y,
+					Kinematics.Velocity2D.X, Kinematics.Velocity2D.Y, Parameters.GroundFriction);
+				FLLDistanceMatching::DistanceMatchToTarget(Playback.Sequence, DistanceToTarget, CurveName, Playback.Time);
+			}
+			else
+			{
+				FLLDistanceMatching::AdvanceTimeByDistanceMatching(Playback.Sequence, GetPlayLength(Playback.Sequence), false,
+					DeltaTime, Kinematics.DisplacementSinceLastUpdate, CurveName, Tuning.PlayRateClampStartsPivots, Playback.Time);
+			}
+			break;
+		default:
+			break;
+		}
+		return 0;
+	}
+}
+
+ULLMassLocomotionProcessor::ULLMassLocomotionProcessor()
+	: EntityQuery(*this)
+{
+	// Nothing renders the agents on a dedicated server
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Client | EProcessorExecutionFlags::Standalone);
+	ExecutionOrder.ExecuteAfter.Add(UE::Mass::ProcessorGroupNames::Movement);
+	ExecutionOrder.ExecuteBefore.Add(UE::Mass::ProcessorGroupNames::Representation);
+}
+
+void ULLMassLocomotionProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassVelocityFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassDesiredMovementFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FLLMassLocomotionFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FLLMassAnimationPlaybackFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FLLMassLocomotionParameters>();
+}
+
+void ULLMassLocomotionProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	LL_SCOPED_STAT(MassLocomotionProcessor);
+
+	// Distance matching tables are shared and built under a lock, so chunks can run on any worker
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& ChunkContext)
+		{
+			const int32 NumEntities = ChunkContext.GetNumEntities();
+			const float DeltaTime = ChunkContext.GetDeltaTimeSeconds();
+			const TConstArrayView<FTransformFragment> Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+			const TConstArrayView<FMassVelocityFragment> Velocities = ChunkContext.GetFragmentView<FMassVelocityFragment>();
+			const TConstArrayView<FMassDesiredMovementFragment> DesiredMovements = ChunkContext.GetFragmentView<FMassDesiredMovementFragment>();
+			const TArrayView<FLLMassLocomotionFragment> LocomotionFragments = ChunkContext.GetMutableFragmentView<FLLMassLocomotionFragment>();
+			const TArrayView<FLLMassAnimationPlaybackFragment> PlaybackFragments = ChunkContext.GetMutableFragmentView<FLLMassAnimationPlaybackFragment>();
+			const FLLMassLocomotionParameters& Parameters = ChunkContext.GetConstSharedFragment<FLLMassLocomotionParameters>();
+			const ULLLocomotionTuning& Tuning = Parameters.Tuning ? *Parameters.Tuning : *GetDefault<ULLLocomotionTuning>();
+
+			for (int32 EntityIndex = 0; EntityIndex < NumEntities; ++EntityIndex)
+			{
+				FLLMassLocomotionFragment& Locomotion = LocomotionFragments[EntityIndex];
+				FLLMassAnimationPlaybackFragment& Playback = PlaybackFragments[EntityIndex];
+				Playback.bSequenceChanged = false;
+
+				const FLLMassAgentKinematics Kinematics = UpdateKinematics(Parameters, Tuning, Transforms[EntityIndex].GetTransform(),
+					Velocities[EntityIndex].Value, DesiredMovements[EntityIndex].DesiredVelocity, DeltaTime, Locomotion);
+				UpdateRootYawOffset(Tuning, Kinematics, Locomotion);
+
+				if (Locomotion.bIsFirstUpdate)
+				{
+					EnterState(ELLMassLocomotionState::Idle, Parameters, Kinematics, Locomotion, Playback);
+					Locomotion.bIsFirstUpdate = false;
+				}
+
+				const float TurnYawWeight = UpdateState(Parameters, Tuning, Kinematics, Locomotion, Playback);
+
+				const ELLMassLocomotionState NextState = SelectNextState(Parameters, Kinematics, Locomotion, Playback, TurnYawWeight);
+				if (NextState == ELLMassLocomotionState::TurnInPlaceRecovery)
+				{
+					// Recovery plays out the rest of the turn in place sequence
+					Locomotion.State = NextState;
+				}
+				else if (NextState != Locomotion.State)
+				{
+					EnterState(NextState, Parameters, Kinematics, Locomotion, Playback);
+				}
+
+				Playback.RootYawOffset = Locomotion.RootYawOffset;
+			}
+		});
+}
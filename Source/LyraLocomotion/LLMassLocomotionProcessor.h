@@ -0,0 +1,26 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "LLMassLocomotionProcessor.generated.h"
+
+// Runs the start, cycle, stop, pivot and turn in place decisions of ULLAnimInstance over chunks of crowd agents after
+// their movement, and distance matches their playback with the same tables. Agents only ever carry a handful of fragments,
+// so thousands of them cost about as much as a few characters with a full anim graph.
+UCLASS()
+class LYRALOCOMOTION_API ULLMassLocomotionProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	ULLMassLocomotionProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
@@ -0,0 +1,23 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLMassLocomotionTrait.h"
+#include "MassCommonFragments.h"
+#include "MassEntityTemplateRegistry.h"
+#include "MassEntityUtils.h"
+#include "MassMovementFragments.h"
+
+void ULLMassLocomotionTrait::BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const
+{
+	FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(World);
+
+	BuildContext.RequireFragment<FTransformFragment>();
+	BuildContext.RequireFragment<FMassVelocityFragment>();
+	BuildContext.RequireFragment<FMassDesiredMovementFragment>();
+
+	BuildContext.AddFragment<FLLMassLocomotionFragment>();
+	BuildContext.AddFragment<FLLMassAnimationPlaybackFragment>();
+
+	const FConstSharedStruct ParametersFragment = EntityManager.GetOrCreateConstSharedFragment(Parameters);
+	BuildContext.AddConstSharedFragment(ParametersFragment);
+}
@@ -0,0 +1,22 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTraitBase.h"
+#include "LLMassLocomotionFragments.h"
+#include "LLMassLocomotionTrait.generated.h"
+
+// Lyra locomotion for crowd agents without an anim instance or character. The agent needs the transform, velocity and
+// desired movement of the Mass movement traits, and gets the sequence and playback time to render from ULLMassLocomotionProcessor.
+UCLASS(meta = (DisplayName = "LL Locomotion"))
+class LYRALOCOMOTION_API ULLMassLocomotionTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const override;
+
+	UPROPERTY(EditAnywhere, Category = "Locomotion")
+	FLLMassLocomotionParameters Parameters;
+};
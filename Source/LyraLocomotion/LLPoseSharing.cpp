@@ -0,0 +1,36 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLPoseSharing.h"
+#include "Animation/AnimNodeBase.h"
+
+void FLLSharedPose::Publish(const FPoseContext& Pose, float Time)
+{
+	Bones[WriteIndex] = Pose.Pose.GetBones();
+	Curves[WriteIndex].CopyFrom(Pose.Curve);
+	Times[WriteIndex] = Time;
+	bPublished[WriteIndex] = true;
+}
+
+bool FLLSharedPose::CopyTo(FPoseContext& Output) const
+{
+	const uint8 ReadIndex = WriteIndex ^ 1;
+	if (!bPublished[ReadIndex] || Bones[ReadIndex].Num() != Output.Pose.GetNumBones())
+	{
+		return false;
+	}
+
+	Output.Pose.CopyBonesFrom(Bones[ReadIndex]);
+	Output.Curve.CopyFrom(Curves[ReadIndex]);
+	return true;
+}
+
+void FLLSharedPose::Flip()
+{
+	// A leader that skipped its update keeps followers on the last pose it published.
+	if (bPublished[WriteIndex])
+	{
+		WriteIndex ^= 1;
+		bPublished[WriteIndex] = false;
+	}
+}
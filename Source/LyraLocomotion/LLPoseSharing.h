@@ -0,0 +1,77 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimCurveTypes.h"
+#include "UObject/ObjectKey.h"
+#include "LyraLocomotionTypes.h"
+
+class UAnimSequenceBase;
+class USkeletalMesh;
+struct FPoseContext;
+
+enum class ELLPoseSharingRole : uint8
+{
+	None,
+	Leader,
+	Follower
+};
+
+// Mesh, LOD, locomotion state, sequence and quantized playback time of a character, characters with equal keys can share one pose
+struct FLLPoseSharingKey
+{
+	TObjectKey<USkeletalMesh> Mesh;
+	int32 LODLevel = 0;
+	TObjectKey<UAnimSequenceBase> Sequence;
+	ELLSequencePlayerRole Role = ELLSequencePlayerRole::Idle;
+	int32 TimeBucket = 0;
+
+	bool operator==(const FLLPoseSharingKey& Other) const
+	{
+		return Mesh == Other.Mesh && LODLevel == Other.LODLevel && Sequence == Other.Sequence && Role == Other.Role && TimeBucket == Other.TimeBucket;
+	}
+
+	// Same pose apart from the playback time, which ULLLocomotionSubsystem checks against PoseSharingTimeStep instead
+	bool IsSameState(const FLLPoseSharingKey& Other) const
+	{
+		return Mesh == Other.Mesh && LODLevel == Other.LODLevel && Sequence == Other.Sequence && Role == Other.Role;
+	}
+
+	friend uint32 GetTypeHash(const FLLPoseSharingKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.Mesh), GetTypeHash(Key.Sequence)),
+			HashCombine(static_cast<uint32>(Key.LODLevel) << 8 | static_cast<uint32>(Key.Role), Key.TimeBucket));
+	}
+};
+
+// Local space pose, curves and playback time a leader evaluated. The leader writes this frame's pose while followers read last frame's,
+// so both can run on any worker without waiting for each other. ULLLocomotionSubsystem flips the buffers once per frame.
+class FLLSharedPose
+{
+public:
+	explicit FLLSharedPose(const FLLPoseSharingKey& InKey) : Key(InKey) {}
+
+	void Publish(const FPoseContext& Pose, float Time);
+
+	// Whether the leader published a pose followers can read this frame
+	bool IsReadable() const { return bPublished[WriteIndex ^ 1]; }
+
+	// Playback time of the sequence in the pose followers read this frame
+	float GetPublishedTime() const { return Times[WriteIndex ^ 1]; }
+
+	// False when the leader published nothing yet or evaluated a different set of bones
+	bool CopyTo(FPoseContext& Output) const;
+
+	void Flip();
+
+	const FLLPoseSharingKey& GetKey() const { return Key; }
+
+private:
+	FLLPoseSharingKey Key;
+	TArray<FTransform> Bones[2];
+	FBlendedHeapCurve Curves[2];
+	float Times[2] = { 0, 0 };
+	bool bPublished[2] = { false, false };
+	uint8 WriteIndex = 0;
+};
@@ -1,5 +1,6 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class LyraLocomotion : ModuleRules
@@ -8,9 +9,13 @@ public class LyraLocomotion : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "DeveloperSettings" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] { "EnhancedInput", "AnimGraphRuntime", "AnimationLocomotionLibraryRuntime" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "EnhancedInput", "AnimGraphRuntime", "AnimationLocomotionLibraryRuntime", "AIModule",
+			"MassEntity", "MassCommon", "MassMovement", "MassSpawner", "StructUtils" });
+
+		// Engine-free locomotion math, also built standalone with CMake
+		PublicIncludePaths.Add(Path.Combine(ModuleDirectory, "..", "LyraLocomotionCore"));
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
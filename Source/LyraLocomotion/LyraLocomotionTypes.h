@@ -39,4 +39,96 @@ struct FCardinalDirections
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	TObjectPtr<UAnimSequence> Right;
+
+	// Diagonals of an 8-way set, selected from only once all four are set
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	TObjectPtr<UAnimSequence> ForwardRight;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	TObjectPtr<UAnimSequence> BackwardRight;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	TObjectPtr<UAnimSequence> BackwardLeft;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	TObjectPtr<UAnimSequence> ForwardLeft;
+
+	bool IsEightWay() const { return ForwardRight && BackwardRight && BackwardLeft && ForwardLeft; }
+
+	// Every direction, null where not set
+	TArray<UAnimSequence*, TFixedAllocator<8>> GetAll() const
+	{
+		return { Forward, Backward, Left, Right, ForwardRight, BackwardRight, BackwardLeft, ForwardLeft };
+	}
+
+	// Sequence of the octant, the direction index of LLLocomotionMath::TLLDirectionTable<8>, for an 8-way set
+	// and of the cardinal direction otherwise
+	UAnimSequence* Select(ECardinalDirection Direction, uint8 Octant) const
+	{
+		static constexpr TObjectPtr<UAnimSequence> FCardinalDirections::* Cardinals[] = {
+			&FCardinalDirections::Forward, &FCardinalDirections::Backward, &FCardinalDirections::Left, &FCardinalDirections::Right };
+		static constexpr TObjectPtr<UAnimSequence> FCardinalDirections::* EightWay[] = {
+			&FCardinalDirections::Forward, &FCardinalDirections::ForwardRight, &FCardinalDirections::Right, &FCardinalDirections::BackwardRight,
+			&FCardinalDirections::Backward, &FCardinalDirections::BackwardLeft, &FCardinalDirections::Left, &FCardinalDirections::ForwardLeft };
+
+		return IsEightWay() ? this->*EightWay[Octant & 7] : this->*Cardinals[static_cast<uint8>(Direction) & 3];
+	}
+};
+
+// Locomotion detail of a character, picked by ULLLocomotionSubsystem from its significance
+UENUM(BlueprintType)
+enum class ELLLocomotionFidelity : uint8
+{
+	// Everything
+	Full,
+	// No ground trace and no pivot prediction
+	Reduced,
+	// Idle and cycle only: no start, stop or pivot states, distance matching, stride warping alpha updates or turn in place curve
+	CycleOnly
+};
+
+// Locomotion logic run by FLLAnimNode_LocomotionSequencePlayer
+UENUM()
+enum class ELLSequencePlayerRole : uint8
+{
+	Idle,
+	IdleBreak,
+	Cycle,
+	TurnInPlaceRecovery
+};
+
+// Locomotion logic run by FLLAnimNode_LocomotionSequenceEvaluator
+UENUM()
+enum class ELLSequenceEvaluatorRole : uint8
+{
+	Start,
+	Stop,
+	Pivot,
+	FallLand,
+	TurnInPlace
+};
+
+// Locomotion values gameplay code reads from ULLAnimInstance, kept up to date on dedicated servers that evaluate no pose
+USTRUCT(BlueprintType)
+struct FLLLocomotionGameplayState
+{
+	GENERATED_BODY()
+
+	// 0 on the ground, -1 before the first measurement
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float GroundDistance = -1.0f;
+
+	// 0 unless rising
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float TimeToJumpApex = 0;
+
+	// Distance the character would slide if it stopped accelerating now
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float PredictedStopDistance = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	ECardinalDirection LocalVelocityDirection = ECardinalDirection::Forward;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	bool bIsRunningIntoWall = false;
 };
@@ -0,0 +1,295 @@
+// Copyright 2024 jeonghun
+
+// Per frame update of many anim instances over two layouts of the same fields: the hot fields interleaved with the
+// settings, anim sets and streaming state as ULLAnimInstance declared them, and the hot fields kept together in one
+// cache line aligned block as FLLLocomotionHotState does. Configured with -DLL_PERF_COUNTERS=ON on Linux, it also
+// reports the cycles and last level cache misses per instance next to the time.
+
+#include "LLLocomotionMath.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if LL_PERF_COUNTERS
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace
+{
+	struct FVector3
+	{
+		double X = 0;
+		double Y = 0;
+		double Z = 0;
+	};
+
+	// Stand in for FLLLocomotionSnapshot, same size and alignment
+	struct FSnapshot
+	{
+		FVector3 Location;
+		FVector3 Velocity;
+		FVector3 Acceleration;
+		FVector3 LastUpdateVelocity;
+		FVector3 Rotation;
+		float Friction[5] = {};
+		uint8_t MovementMode = 0;
+		uint8_t Flags = 0;
+	};
+
+	// Settings, anim set pointers, streaming handles and the like an update doesn't touch
+	template <int32_t Size>
+	struct FCold
+	{
+		uint8_t Bytes[Size] = {};
+	};
+
+	struct FInterleavedInstance
+	{
+		FCold<1024> AnimInstanceBase;
+		FCold<24> Settings;
+		FVector3 WorldLocation;
+		float DisplacementSpeed = 0;
+		FVector3 WorldRotation;
+		float AdditiveLeanAngle = 0;
+		FVector3 WorldVelocity;
+		float RootYawOffset = 0;
+		FCold<160> BlueprintOnlyState;
+		FCold<264> AnimSets;
+		bool bIsFirstUpdate = true;
+		FSnapshot Snapshot;
+		FCold<8> LocomotionMovement;
+		float DisplacementSinceLastUpdate = 0;
+		FVector3 PrevWorldLocation;
+		float YawDeltaSinceLastUpdate = 0;
+		FCold<8> TurnInPlace;
+		FVector3 PrevWorldRotation;
+		LLLocomotionMath::FLLSpringState RootYawOffsetSpringState;
+		FCold<24> IdleBreaksAndPivots;
+		FCold<32> GroundDistance;
+		float TimeFalling = 0;
+		FCold<24> Subsystem;
+		float UpdateDeltaSeconds = 0;
+		FCold<96> DormancyAndStreaming;
+	};
+
+	struct alignas(64) FHotState
+	{
+		FSnapshot Snapshot;
+		FVector3 PrevWorldLocation;
+		FVector3 PrevWorldRotation;
+		FVector3 PivotDirection2D;
+		LLLocomotionMath::FLLSpringState RootYawOffsetSpringState;
+		float UpdateDeltaSeconds = 0;
+		float DisplacementSinceLastUpdate = 0;
+		float YawDeltaSinceLastUpdate = 0;
+		float TurnYawCurveValue = 0;
+		float TimeFalling = 0;
+		uint8_t Modes[3] = {};
+		bool bIsFirstUpdate = true;
+		bool bWasMovingLastUpdate = false;
+		bool bHasSnapshot = false;
+	};
+
+	struct FHotColdInstance
+	{
+		FCold<1024> AnimInstanceBase;
+		FVector3 WorldLocation;
+		float DisplacementSpeed = 0;
+		FVector3 WorldRotation;
+		float AdditiveLeanAngle = 0;
+		FVector3 WorldVelocity;
+		float RootYawOffset = 0;
+		FCold<160> BlueprintOnlyState;
+		FHotState HotState;
+		FCold<24> Settings;
+		FCold<264> AnimSets;
+		FCold<8> LocomotionMovement;
+		FCold<8> TurnInPlace;
+		FCold<24> IdleBreaksAndPivots;
+		FCold<32> GroundDistance;
+		FCold<24> Subsystem;
+		FCold<96> DormancyAndStreaming;
+	};
+
+#if LL_PERF_COUNTERS
+	// Hardware counters of this thread around the timed loop, read straight from perf_event_open so the benchmark
+	// doesn't need a Google Benchmark built with libpfm. Left out of the results when the kernel or the VM has no PMU.
+	class FPerfCounters
+	{
+	public:
+		FPerfCounters()
+		{
+			Cycles = Open(PERF_COUNT_HW_CPU_CYCLES);
+			CacheMisses = Open(PERF_COUNT_HW_CACHE_MISSES);
+		}
+
+		~FPerfCounters()
+		{
+			Close(Cycles);
+			Close(CacheMisses);
+		}
+
+		FPerfCounters(const FPerfCounters&) = delete;
+		FPerfCounters& operator=(const FPerfCounters&) = delete;
+
+		bool IsValid() const { return Cycles >= 0 && CacheMisses >= 0; }
+
+		void Start()
+		{
+			for (const int Counter : { Cycles, CacheMisses })
+			{
+				ioctl(Counter, PERF_EVENT_IOC_RESET, 0);
+				ioctl(Counter, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+
+		void Stop(benchmark::State& State, int64_t NumItems)
+		{
+			for (const int Counter : { Cycles, CacheMisses })
+			{
+				ioctl(Counter, PERF_EVENT_IOC_DISABLE, 0);
+			}
+			const double Items = static_cast<double>(NumItems);
+			State.counters["Cycles"] = benchmark::Counter(static_cast<double>(Read(Cycles)) / Items);
+			State.counters["CacheMisses"] = benchmark::Counter(static_cast<double>(Read(CacheMisses)) / Items);
+		}
+
+	private:
+		static int Open(uint64_t Config)
+		{
+			perf_event_attr Attributes;
+			std::memset(&Attributes, 0, sizeof(Attributes));
+			Attributes.size = sizeof(Attributes);
+			Attributes.type = PERF_TYPE_HARDWARE;
+			Attributes.config = Config;
+			Attributes.disabled = 1;
+			Attributes.exclude_kernel = 1;
+			Attributes.exclude_hv = 1;
+			return static_cast<int>(syscall(SYS_perf_event_open, &Attributes, 0, -1, -1, 0));
+		}
+
+		static void Close(int Counter)
+		{
+			if (Counter >= 0)
+			{
+				close(Counter);
+			}
+		}
+
+		static uint64_t Read(int Counter)
+		{
+			uint64_t Value = 0;
+			return read(Counter, &Value, sizeof(Value)) == sizeof(Value) ? Value : 0;
+		}
+
+		int Cycles = -1;
+		int CacheMisses = -1;
+	};
+#endif
+
+	FInterleavedInstance& Hot(FInterleavedInstance& Instance)
+	{
+		return Instance;
+	}
+
+	FHotState& Hot(FHotColdInstance& Instance)
+	{
+		return Instance.HotState;
+	}
+
+	// Location, rotation and root yaw offset steps of ULLAnimInstance, reading the snapshot the movement component gathered
+	template <typename InstanceType>
+	void UpdateInstance(InstanceType& Instance, float DeltaTime)
+	{
+		auto& HotState = Hot(Instance);
+		HotState.UpdateDeltaSeconds = DeltaTime;
+
+		HotState.PrevWorldLocation = Instance.WorldLocation;
+		Instance.WorldLocation = HotState.Snapshot.Location;
+		HotState.PrevWorldRotation = Instance.WorldRotation;
+		Instance.WorldRotation = HotState.Snapshot.Rotation;
+		Instance.WorldVelocity = HotState.Snapshot.Velocity;
+		HotState.TimeFalling = HotState.Snapshot.MovementMode == 3 ? HotState.TimeFalling + DeltaTime : 0;
+
+		HotState.DisplacementSinceLastUpdate = LLLocomotionMath::Displacement2D(
+			static_cast<float>(HotState.PrevWorldLocation.X), static_cast<float>(HotState.PrevWorldLocation.Y),
+			static_cast<float>(Instance.WorldLocation.X), static_cast<float>(Instance.WorldLocation.Y));
+		Instance.DisplacementSpeed = LLLocomotionMath::SafeDivide(HotState.DisplacementSinceLastUpdate, DeltaTime);
+
+		HotState.YawDeltaSinceLastUpdate = static_cast<float>(Instance.WorldRotation.Y - HotState.PrevWorldRotation.Y);
+		Instance.AdditiveLeanAngle = LLLocomotionMath::AdditiveLeanAngle(HotState.YawDeltaSinceLastUpdate, DeltaTime);
+		if (HotState.bIsFirstUpdate)
+		{
+			HotState.DisplacementSinceLastUpdate = 0;
+			HotState.YawDeltaSinceLastUpdate = 0;
+			Instance.AdditiveLeanAngle = 0;
+		}
+
+		Instance.RootYawOffset = LLLocomotionMath::BlendOutRootYawOffset(
+			Instance.RootYawOffset - HotState.YawDeltaSinceLastUpdate, HotState.RootYawOffsetSpringState, DeltaTime);
+		HotState.bIsFirstUpdate = false;
+	}
+
+	// One allocation per instance visited in a shuffled order, like UObjects spread over the heap
+	template <typename InstanceType>
+	std::vector<std::unique_ptr<InstanceType>> MakeInstances(int32_t NumInstances)
+	{
+		std::mt19937 Random(1);
+		std::uniform_real_distribution<double> Distribution(-1000, 1000);
+
+		std::vector<std::unique_ptr<InstanceType>> Instances(NumInstances);
+		for (std::unique_ptr<InstanceType>& Instance : Instances)
+		{
+			Instance = std::make_unique<InstanceType>();
+			Hot(*Instance).Snapshot.Location = { Distribution(Random), Distribution(Random), 0 };
+			Hot(*Instance).Snapshot.Rotation = { 0, Distribution(Random), 0 };
+		}
+		std::shuffle(Instances.begin(), Instances.end(), Random);
+		return Instances;
+	}
+
+	template <typename InstanceType>
+	void BM_UpdateInstances(benchmark::State& State)
+	{
+		const int32_t NumInstances = static_cast<int32_t>(State.range(0));
+		std::vector<std::unique_ptr<InstanceType>> Instances = MakeInstances<InstanceType>(NumInstances);
+
+#if LL_PERF_COUNTERS
+		FPerfCounters Counters;
+		if (Counters.IsValid())
+		{
+			Counters.Start();
+		}
+		else
+		{
+			State.SetLabel("no perf counters");
+		}
+#endif
+
+		for (auto _ : State)
+		{
+			for (std::unique_ptr<InstanceType>& Instance : Instances)
+			{
+				UpdateInstance(*Instance, 1.0f / 60.0f);
+			}
+			benchmark::ClobberMemory();
+		}
+		State.SetItemsProcessed(State.iterations() * NumInstances);
+
+#if LL_PERF_COUNTERS
+		if (Counters.IsValid())
+		{
+			Counters.Stop(State, State.iterations() * NumInstances);
+		}
+#endif
+	}
+}
+
+BENCHMARK_TEMPLATE(BM_UpdateInstances, FInterleavedInstance)->Arg(256)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_UpdateInstances, FHotColdInstance)->Arg(256)->Arg(4096);
@@ -0,0 +1,209 @@
+// Copyright 2024 jeonghun
+
+#include "LLLocomotionMath.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+	enum class ECardinalDirection : uint8_t
+	{
+		Forward,
+		Backward,
+		Left,
+		Right
+	};
+
+	constexpr int32_t NumSamples = 4096;
+
+	std::vector<float> MakeSamples(float Min, float Max, uint32_t Seed)
+	{
+		std::mt19937 Random(Seed);
+		std::uniform_real_distribution<float> Distribution(Min, Max);
+		std::vector<float> Samples(NumSamples);
+		for (float& Sample : Samples)
+		{
+			Sample = Distribution(Random);
+		}
+		return Samples;
+	}
+}
+
+static void BM_SelectCardinalDirectionFromAngle(benchmark::State& State)
+{
+	const std::vector<float> Angles = MakeSamples(-180, 180, 1);
+	ECardinalDirection Direction = ECardinalDirection::Forward;
+	for (auto _ : State)
+	{
+		for (const float Angle : Angles)
+		{
+			Direction = LLLocomotionMath::SelectCardinalDirectionFromAngle(Angle, 10.0f, Direction, true);
+		}
+		benchmark::DoNotOptimize(Direction);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_SelectCardinalDirectionFromAngle);
+
+static void BM_SelectDirectionFromAngle8Way(benchmark::State& State)
+{
+	const std::vector<float> Angles = MakeSamples(-180, 180, 1);
+	uint8_t Direction = 0;
+	for (auto _ : State)
+	{
+		for (const float Angle : Angles)
+		{
+			Direction = LLLocomotionMath::SelectDirectionFromAngle<8>(Angle, 10.0f, Direction, true);
+		}
+		benchmark::DoNotOptimize(Direction);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_SelectDirectionFromAngle8Way);
+
+// One update of a batch of characters, each keeping its own direction
+static void BM_SelectDirectionsFromAngles8Way(benchmark::State& State)
+{
+	const std::vector<float> Angles = MakeSamples(-180, 180, 1);
+	const std::vector<uint8_t> bUseCurrentDirections(NumSamples, 1);
+	std::vector<uint8_t> Directions(NumSamples, 0);
+	for (auto _ : State)
+	{
+		LLLocomotionMath::SelectDirectionsFromAngles<8>(Angles.data(), 10.0f, bUseCurrentDirections.data(), Directions.data(), NumSamples);
+		benchmark::DoNotOptimize(Directions.data());
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_SelectDirectionsFromAngles8Way);
+
+static void BM_CalculateDirection2D(benchmark::State& State)
+{
+	const std::vector<float> X = MakeSamples(-600, 600, 2);
+	const std::vector<float> Y = MakeSamples(-600, 600, 3);
+	for (auto _ : State)
+	{
+		float Sum = 0;
+		for (int32_t Index = 0; Index < NumSamples; ++Index)
+		{
+			Sum += LLLocomotionMath::CalculateDirection2D(X[Index], Y[Index], 0.6f, 0.8f, -0.8f, 0.6f);
+		}
+		benchmark::DoNotOptimize(Sum);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_CalculateDirection2D);
+
+static void BM_ClampRootYawOffset(benchmark::State& State)
+{
+	const std::vector<float> Offsets = MakeSamples(-720, 720, 4);
+	for (auto _ : State)
+	{
+		float Sum = 0;
+		for (const float Offset : Offsets)
+		{
+			Sum += LLLocomotionMath::ClampRootYawOffset(Offset, -120, 100);
+		}
+		benchmark::DoNotOptimize(Sum);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_ClampRootYawOffset);
+
+static void BM_BlendOutRootYawOffset(benchmark::State& State)
+{
+	const std::vector<float> Offsets = MakeSamples(-120, 100, 5);
+	std::vector<LLLocomotionMath::FLLSpringState> SpringStates(NumSamples);
+	for (auto _ : State)
+	{
+		float Sum = 0;
+		for (int32_t Index = 0; Index < NumSamples; ++Index)
+		{
+			Sum += LLLocomotionMath::BlendOutRootYawOffset(Offsets[Index], SpringStates[Index], 1.0f / 60.0f);
+		}
+		benchmark::DoNotOptimize(Sum);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_BlendOutRootYawOffset);
+
+static void BM_DisplacementAndLean(benchmark::State& State)
+{
+	const std::vector<float> X = MakeSamples(-10000, 10000, 6);
+	const std::vector<float> Y = MakeSamples(-10000, 10000, 7);
+	const std::vector<float> YawDelta = MakeSamples(-10, 10, 8);
+	for (auto _ : State)
+	{
+		float Sum = 0;
+		for (int32_t Index = 1; Index < NumSamples; ++Index)
+		{
+			Sum += LLLocomotionMath::Displacement2D(X[Index - 1], Y[Index - 1], X[Index], Y[Index]);
+			Sum += LLLocomotionMath::AdditiveLeanAngle(YawDelta[Index], 1.0f / 60.0f);
+		}
+		benchmark::DoNotOptimize(Sum);
+	}
+	State.SetItemsProcessed(State.iterations() * (NumSamples - 1));
+}
+BENCHMARK(BM_DisplacementAndLean);
+
+static void BM_IdleBreakDelayTime(benchmark::State& State)
+{
+	const std::vector<float> X = MakeSamples(-100000, 100000, 9);
+	const std::vector<float> Y = MakeSamples(-100000, 100000, 10);
+	for (auto _ : State)
+	{
+		float Sum = 0;
+		for (int32_t Index = 0; Index < NumSamples; ++Index)
+		{
+			Sum += LLLocomotionMath::IdleBreakDelayTime(X[Index], Y[Index]);
+		}
+		benchmark::DoNotOptimize(Sum);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_IdleBreakDelayTime);
+
+static void BM_PredictStopAndPivotDistance(benchmark::State& State)
+{
+	const std::vector<float> VelocityX = MakeSamples(-600, 600, 11);
+	const std::vector<float> VelocityY = MakeSamples(-600, 600, 12);
+	const std::vector<float> AccelerationX = MakeSamples(-2400, 2400, 13);
+	const std::vector<float> AccelerationY = MakeSamples(-2400, 2400, 14);
+	for (auto _ : State)
+	{
+		float Sum = 0;
+		for (int32_t Index = 0; Index < NumSamples; ++Index)
+		{
+			Sum += LLLocomotionMath::PredictGroundMovementStopDistance(VelocityX[Index], VelocityY[Index], false, 0, 8, 2, 2048);
+			Sum += LLLocomotionMath::PredictGroundMovementPivotDistance(
+				AccelerationX[Index], AccelerationY[Index], VelocityX[Index], VelocityY[Index], 8);
+		}
+		benchmark::DoNotOptimize(Sum);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_PredictStopAndPivotDistance);
+
+// Each input held for four queries, like a character the movement component didn't move between anim updates
+static void BM_PredictStopAndPivotDistanceMemoized(benchmark::State& State)
+{
+	const std::vector<float> VelocityX = MakeSamples(-600, 600, 11);
+	const std::vector<float> VelocityY = MakeSamples(-600, 600, 12);
+	const std::vector<float> AccelerationX = MakeSamples(-2400, 2400, 13);
+	const std::vector<float> AccelerationY = MakeSamples(-2400, 2400, 14);
+	LLLocomotionMath::FLLGroundMovementPrediction Prediction;
+	for (auto _ : State)
+	{
+		float Sum = 0;
+		for (int32_t Index = 0; Index < NumSamples; ++Index)
+		{
+			const int32_t HeldIndex = Index & ~3;
+			Sum += Prediction.StopDistance(VelocityX[HeldIndex], VelocityY[HeldIndex], false, 0, 8, 2, 2048);
+			Sum += Prediction.PivotDistance(
+				AccelerationX[HeldIndex], AccelerationY[HeldIndex], VelocityX[HeldIndex], VelocityY[HeldIndex], 8);
+		}
+		benchmark::DoNotOptimize(Sum);
+	}
+	State.SetItemsProcessed(State.iterations() * NumSamples);
+}
+BENCHMARK(BM_PredictStopAndPivotDistanceMemoized);
@@ -0,0 +1,574 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+// Locomotion math of ULLAnimInstance and ULLLocomotionSubsystem without any engine dependency,
+// so it can be built, benchmarked and checked with plain CMake outside of the Unreal project.
+
+#include <cmath>
+#include <cstdint>
+
+namespace LLLocomotionMath
+{
+	constexpr float KindaSmallNumber = 1.e-4f;
+	constexpr float SmallNumber = 1.e-8f;
+	constexpr float LeanAnglePerYawSpeed = 0.0375f;
+
+	// Same as UKismetMathLibrary::SafeDivide
+	inline float SafeDivide(float A, float B)
+	{
+		return B != 0 ? A / B : 0;
+	}
+
+	// Same as FRotator::ClampAxis, [0, 360)
+	inline float ClampAxis(float Angle)
+	{
+		Angle = std::fmod(Angle, 360.0f);
+		return Angle < 0 ? Angle + 360.0f : Angle;
+	}
+
+	// Same as FRotator::NormalizeAxis, (-180, 180]
+	inline float NormalizeAxis(float Angle)
+	{
+		Angle = ClampAxis(Angle);
+		return Angle > 180.0f ? Angle - 360.0f : Angle;
+	}
+
+	// Same as FMath::ClampAngle
+	inline float ClampAngle(float Angle, float MinAngle, float MaxAngle)
+	{
+		const float MaxDelta = ClampAxis(MaxAngle - MinAngle) * 0.5f;
+		const float RangeCenter = ClampAxis(MinAngle + MaxDelta);
+		const float DeltaFromCenter = NormalizeAxis(Angle - RangeCenter);
+
+		if (DeltaFromCenter > MaxDelta)
+		{
+			return NormalizeAxis(RangeCenter + MaxDelta);
+		}
+		else if (DeltaFromCenter < -MaxDelta)
+		{
+			return NormalizeAxis(RangeCenter - MaxDelta);
+		}
+		return NormalizeAxis(Angle);
+	}
+
+	// Normalized root yaw offset, clamped unless both ends of the clamp are equal
+	inline float ClampRootYawOffset(float RootYawOffset, float MinAngle, float MaxAngle)
+	{
+		const float NormalizedRootYawOffset = NormalizeAxis(RootYawOffset);
+		return MinAngle == MaxAngle ? NormalizedRootYawOffset : ClampAngle(NormalizedRootYawOffset, MinAngle, MaxAngle);
+	}
+
+	// Same as UKismetAnimationLibrary::CalculateDirection for a direction in the XY plane,
+	// written against the rotation axes so it can run over plain arrays.
+	inline float CalculateDirection2D(float X, float Y, float ForwardX, float ForwardY, float RightX, float RightY)
+	{
+		if (std::fabs(X) <= KindaSmallNumber && std::fabs(Y) <= KindaSmallNumber)
+		{
+			return 0;
+		}
+
+		const float SquareSum = X * X + Y * Y;
+		const float Scale = SquareSum < SmallNumber ? 0 : 1.0f / std::sqrt(SquareSum);
+		const float NormalizedX = X * Scale;
+		const float NormalizedY = Y * Scale;
+
+		const float Cosine = std::fmin(std::fmax(ForwardX * NormalizedX + ForwardY * NormalizedY, -1.0f), 1.0f);
+		const float ForwardDeltaDegree = std::acos(Cosine) * (180.0f / 3.14159265358979323846f);
+		return RightX * NormalizedX + RightY * NormalizedY < 0 ? -ForwardDeltaDegree : ForwardDeltaDegree;
+	}
+
+	// Angle buckets of an N-way directional set, built at compile time. Direction 0 is forward and the indices go clockwise,
+	// toward positive angles, so the 4-way set is forward, right, backward, left and the 8-way set adds the diagonals
+	// in between. Each edge between two neighbors moves by a multiple of the dead zone: forward and backward are widened
+	// by it, and the current direction by it again against any neighbor not wider than itself, so the result doesn't
+	// flicker around the boundaries. The dead zone has to stay below a third of the bucket size.
+	template <int32_t N>
+	struct TLLDirectionTable
+	{
+		static_assert(N >= 4 && N % 2 == 0, "A directional set needs a forward and a backward direction");
+
+		// Clockwise edge of each direction in [0, 360) before the dead zone
+		float EdgeAngle[N] = {};
+		// Dead zone multiple each edge moves clockwise by, per current direction, the last row without a current direction
+		int8_t DeadZoneScale[N + 1][N] = {};
+		uint8_t Opposite[N] = {};
+
+		static constexpr bool IsWidened(int32_t Direction)
+		{
+			return Direction == 0 || Direction == N / 2;
+		}
+
+		constexpr TLLDirectionTable()
+		{
+			for (int32_t Edge = 0; Edge < N; ++Edge)
+			{
+				const int32_t Before = Edge;
+				const int32_t After = (Edge + 1) % N;
+				EdgeAngle[Edge] = (Edge + 0.5f) * 360.0f / N;
+
+				for (int32_t Current = 0; Current <= N; ++Current)
+				{
+					int32_t Scale = int32_t(IsWidened(Before)) - int32_t(IsWidened(After));
+					Scale += Current == Before && IsWidened(Before) >= IsWidened(After) ? 1 : 0;
+					Scale -= Current == After && IsWidened(After) >= IsWidened(Before) ? 1 : 0;
+					DeadZoneScale[Current][Edge] = static_cast<int8_t>(Scale);
+				}
+			}
+
+			for (int32_t Direction = 0; Direction < N; ++Direction)
+			{
+				Opposite[Direction] = static_cast<uint8_t>((Direction + N / 2) % N);
+			}
+		}
+	};
+
+	template <int32_t N>
+	inline constexpr TLLDirectionTable<N> DirectionTable {};
+
+	// Direction of an angle from forward in degrees, (-180, 180]. Counts the edges clockwise of the angle instead of
+	// branching per direction, so a loop over many characters runs the same instructions for each.
+	template <int32_t N>
+	uint8_t SelectDirectionFromAngle(float Angle, float DeadZone, uint8_t CurrentDirection, bool bUseCurrentDirection)
+	{
+		const TLLDirectionTable<N>& Table = DirectionTable<N>;
+		const int8_t* Scale = Table.DeadZoneScale[bUseCurrentDirection ? CurrentDirection : N];
+
+		// Measured clockwise from the counterclockwise edge of forward
+		const float FirstEdge = Table.EdgeAngle[N - 1] + Scale[N - 1] * DeadZone - 360.0f;
+		float Offset = Angle - FirstEdge;
+		Offset += 360.0f * float(Offset < 0);
+
+		uint8_t Direction = 0;
+		for (int32_t Edge = 0; Edge < N - 1; ++Edge)
+		{
+			Direction += uint8_t(Offset > Table.EdgeAngle[Edge] + Scale[Edge] * DeadZone - FirstEdge);
+		}
+		return Direction;
+	}
+
+	// SelectDirectionFromAngle over arrays, InOutDirections holds the current directions and receives the new ones
+	template <int32_t N>
+	void SelectDirectionsFromAngles(const float* Angles, float DeadZone, const uint8_t* bUseCurrentDirections, uint8_t* InOutDirections, int32_t Num)
+	{
+		for (int32_t Index = 0; Index < Num; ++Index)
+		{
+			InOutDirections[Index] = SelectDirectionFromAngle<N>(Angles[Index], DeadZone, InOutDirections[Index], bUseCurrentDirections[Index] != 0);
+		}
+	}
+
+	template <int32_t N>
+	uint8_t GetOppositeDirection(uint8_t Direction)
+	{
+		return DirectionTable<N>.Opposite[Direction];
+	}
+
+	// Cardinal directions in the order of the 4-way direction table, and the table index of each cardinal direction
+	constexpr uint8_t CardinalToDirection[4] = { 0, 2, 3, 1 };
+	constexpr uint8_t DirectionToCardinal[4] = { 0, 3, 1, 2 };
+
+	// Cardinal direction of an angle from forward in degrees, the 4-way direction table in terms of an enum.
+	// DirectionType is any enum with Forward, Backward, Left and Right, in that order.
+	template <typename DirectionType>
+	DirectionType SelectCardinalDirectionFromAngle(float Angle, float DeadZone, DirectionType CurrentDirection, bool bUseCurrentDirection)
+	{
+		static_assert(int32_t(DirectionType::Forward) == 0 && int32_t(DirectionType::Backward) == 1 &&
+			int32_t(DirectionType::Left) == 2 && int32_t(DirectionType::Right) == 3, "Cardinal directions out of order");
+
+		const uint8_t Direction = SelectDirectionFromAngle<4>(
+			Angle, DeadZone, CardinalToDirection[static_cast<uint8_t>(CurrentDirection) & 3], bUseCurrentDirection);
+		return static_cast<DirectionType>(DirectionToCardinal[Direction]);
+	}
+
+	template <typename DirectionType>
+	DirectionType GetOppositeCardinalDirection(DirectionType CurrentDirection)
+	{
+		return static_cast<DirectionType>(DirectionToCardinal[GetOppositeDirection<4>(CardinalToDirection[static_cast<uint8_t>(CurrentDirection) & 3])]);
+	}
+
+	struct FLLSpringState
+	{
+		float Velocity = 0;
+		float PrevTarget = 0;
+		bool bPrevTargetValid = false;
+	};
+
+	// Damped spring toward Target integrated with implicit Euler, stable for any time step.
+	// Parameters are those of UKismetMathLibrary::FloatSpringInterp.
+	inline float SpringInterp(float Current, float Target, FLLSpringState& State, float Stiffness, float CriticalDampingFactor,
+		float DeltaTime, float Mass, float TargetVelocityAmount)
+	{
+		if (DeltaTime <= SmallNumber || Mass <= 0)
+		{
+			return Current;
+		}
+
+		if (!State.bPrevTargetValid)
+		{
+			State.PrevTarget = Target;
+			State.bPrevTargetValid = true;
+		}
+
+		const float TargetVelocity = (Target - State.PrevTarget) * TargetVelocityAmount / DeltaTime;
+		State.PrevTarget = Target;
+
+		const float Omega = std::sqrt(Stiffness / Mass);
+		const float Damping = 2.0f * CriticalDampingFactor * Omega;
+		const float OmegaSquared = Omega * Omega;
+
+		State.Velocity = (State.Velocity + DeltaTime * (OmegaSquared * (Target - Current) + Damping * TargetVelocity)) /
+			(1.0f + DeltaTime * Damping + DeltaTime * DeltaTime * OmegaSquared);
+		return Current + State.Velocity * DeltaTime;
+	}
+
+	// Spring the root yaw offset uses while blending out to 0
+	inline float BlendOutRootYawOffset(float RootYawOffset, FLLSpringState& State, float DeltaTime)
+	{
+		return SpringInterp(RootYawOffset, 0, State, 80, 1, DeltaTime, 1, 0.5f);
+	}
+
+	inline float Displacement2D(float PrevX, float PrevY, float X, float Y)
+	{
+		const float DeltaX = PrevX - X;
+		const float DeltaY = PrevY - Y;
+		return std::sqrt(DeltaX * DeltaX + DeltaY * DeltaY);
+	}
+
+	inline float AdditiveLeanAngle(float YawDelta, float DeltaTime)
+	{
+		return SafeDivide(YawDelta, DeltaTime) * LeanAnglePerYawSpeed;
+	}
+
+	// Wall detection heuristic of the Lyra ABP: accelerating while slow, with the acceleration well off the velocity.
+	// Pushing straight into a wall leaves no velocity at all, which counts as off the velocity.
+	inline bool IsRunningIntoWall(float LocalVelocityX, float LocalVelocityY, float LocalAccelerationX, float LocalAccelerationY)
+	{
+		const float VelocitySquared = LocalVelocityX * LocalVelocityX + LocalVelocityY * LocalVelocityY;
+		const float AccelerationSquared = LocalAccelerationX * LocalAccelerationX + LocalAccelerationY * LocalAccelerationY;
+		if (AccelerationSquared <= 0.1f * 0.1f || VelocitySquared >= 200.0f * 200.0f)
+		{
+			return false;
+		}
+		if (VelocitySquared <= SmallNumber)
+		{
+			return true;
+		}
+
+		const float CosAngle = (LocalVelocityX * LocalAccelerationX + LocalVelocityY * LocalAccelerationY) / std::sqrt(VelocitySquared * AccelerationSquared);
+		return CosAngle >= -0.6f && CosAngle <= 0.6f;
+	}
+
+	// Values of ULLLocomotionTuning the kinematics read, its class defaults unless set
+	struct FLLKinematicsTuning
+	{
+		float CardinalDirectionDeadZone = 10.0f;
+		float RootYawOffsetMinAngle = -120.0f;
+		float RootYawOffsetMaxAngle = 100.0f;
+	};
+
+	// Location, rotation, velocity and acceleration of a character for one kinematics update, from FLLLocomotionSnapshot
+	struct FLLKinematicsInputs
+	{
+		double LocationX = 0;
+		double LocationY = 0;
+		float Yaw = 0;
+		// X and Y of the rotation axes, as FRotationMatrix::GetScaledAxis
+		float AxisXX = 1;
+		float AxisXY = 0;
+		float AxisYX = 0;
+		float AxisYY = 1;
+		float AxisZX = 0;
+		float AxisZY = 0;
+		float VelocityX = 0;
+		float VelocityY = 0;
+		float AccelerationX = 0;
+		float AccelerationY = 0;
+
+		// Yaw and the axes of FRotationMatrix, angles in degrees
+		void SetRotation(float Pitch, float InYaw, float Roll)
+		{
+			constexpr float DegreesToRadians = 3.14159265358979323846f / 180.0f;
+			const float SP = std::sin(Pitch * DegreesToRadians);
+			const float CP = std::cos(Pitch * DegreesToRadians);
+			const float SY = std::sin(InYaw * DegreesToRadians);
+			const float CY = std::cos(InYaw * DegreesToRadians);
+			const float SR = std::sin(Roll * DegreesToRadians);
+			const float CR = std::cos(Roll * DegreesToRadians);
+
+			Yaw = InYaw;
+			AxisXX = CP * CY;
+			AxisXY = CP * SY;
+			AxisYX = SR * SP * CY - CR * SY;
+			AxisYY = SR * SP * SY + CR * CY;
+			AxisZX = -(CR * SP * CY + SR * SY);
+			AxisZY = CY * SR - CR * SP * SY;
+		}
+	};
+
+	// Kinematics ULLAnimInstance carries from one update to the next, and what each update computes from the inputs.
+	// DirectionType is the cardinal direction enum as in SelectCardinalDirectionFromAngle,
+	// RootYawOffsetModeType any enum with BlendOut and Accumulate.
+	template <typename DirectionType, typename RootYawOffsetModeType>
+	struct TLLKinematics
+	{
+		// Set by the state node functions of the anim instance between updates
+		float RootYawOffset = 0;
+		RootYawOffsetModeType RootYawOffsetMode = RootYawOffsetModeType::BlendOut;
+		FLLSpringState RootYawOffsetSpringState;
+
+		// Carried between updates
+		double PrevLocationX = 0;
+		double PrevLocationY = 0;
+		float PrevYaw = 0;
+		float PivotDirectionX = 0;
+		float PivotDirectionY = 0;
+		DirectionType LocalVelocityDirection = DirectionType::Forward;
+		DirectionType LocalVelocityDirectionNoOffset = DirectionType::Forward;
+		uint8_t LocalVelocityOctant = 0;
+		uint8_t LocalVelocityOctantNoOffset = 0;
+		bool bIsFirstUpdate = true;
+
+		// Computed by each update
+		float DisplacementSinceLastUpdate = 0;
+		float DisplacementSpeed = 0;
+		float YawDeltaSinceLastUpdate = 0;
+		float AdditiveLeanAngle = 0;
+		float LocalVelocityX = 0;
+		float LocalVelocityY = 0;
+		float LocalVelocityZ = 0;
+		float LocalVelocityDirectionAngle = 0;
+		float LocalVelocityDirectionAngleWithOffset = 0;
+		float LocalAccelerationX = 0;
+		float LocalAccelerationY = 0;
+		float LocalAccelerationZ = 0;
+		DirectionType CardinalDirectionFromAcceleration = DirectionType::Forward;
+		uint8_t OctantFromAcceleration = 0;
+		bool bHasVelocity = false;
+		bool bHasAcceleration = false;
+		bool bIsRunningIntoWall = false;
+	};
+
+	// One update of the location, rotation, velocity, acceleration and root yaw offset data of a character,
+	// over DeltaTime since its last update. Batched by ULLLocomotionSubsystem and replayed by LLLocomotionReplay.
+	template <typename DirectionType, typename RootYawOffsetModeType>
+	inline void ComputeKinematics(const FLLKinematicsInputs& Inputs, const FLLKinematicsTuning& Tuning, float DeltaTime,
+		TLLKinematics<DirectionType, RootYawOffsetModeType>& K)
+	{
+		// Location and rotation data
+		const float InvDeltaTime = DeltaTime != 0 ? 1.0f / DeltaTime : 0;
+		const float FirstUpdateMask = K.bIsFirstUpdate ? 0.0f : 1.0f;
+		K.DisplacementSinceLastUpdate = Displacement2D(static_cast<float>(K.PrevLocationX), static_cast<float>(K.PrevLocationY),
+			static_cast<float>(Inputs.LocationX), static_cast<float>(Inputs.LocationY)) * FirstUpdateMask;
+		K.DisplacementSpeed = K.DisplacementSinceLastUpdate * InvDeltaTime;
+		K.YawDeltaSinceLastUpdate = (Inputs.Yaw - K.PrevYaw) * FirstUpdateMask;
+		K.AdditiveLeanAngle = K.YawDeltaSinceLastUpdate * InvDeltaTime * LeanAnglePerYawSpeed;
+
+		// Velocity data
+		const bool bWasMovingLastUpdate = K.LocalVelocityX != 0 || K.LocalVelocityY != 0 || K.LocalVelocityZ != 0;
+		K.LocalVelocityX = Inputs.VelocityX * Inputs.AxisXX + Inputs.VelocityY * Inputs.AxisXY;
+		K.LocalVelocityY = Inputs.VelocityX * Inputs.AxisYX + Inputs.VelocityY * Inputs.AxisYY;
+		K.LocalVelocityZ = Inputs.VelocityX * Inputs.AxisZX + Inputs.VelocityY * Inputs.AxisZY;
+
+		const float Angle = CalculateDirection2D(Inputs.VelocityX, Inputs.VelocityY, Inputs.AxisXX, Inputs.AxisXY, Inputs.AxisYX, Inputs.AxisYY);
+		const float AngleWithOffset = Angle - K.RootYawOffset;
+		K.LocalVelocityDirectionAngle = Angle;
+		K.LocalVelocityDirectionAngleWithOffset = AngleWithOffset;
+
+		const float DeadZone = Tuning.CardinalDirectionDeadZone;
+		K.LocalVelocityDirection = SelectCardinalDirectionFromAngle(AngleWithOffset, DeadZone, K.LocalVelocityDirection, bWasMovingLastUpdate);
+		K.LocalVelocityDirectionNoOffset = SelectCardinalDirectionFromAngle(Angle, DeadZone, K.LocalVelocityDirectionNoOffset, bWasMovingLastUpdate);
+		K.LocalVelocityOctant = SelectDirectionFromAngle<8>(AngleWithOffset, DeadZone, K.LocalVelocityOctant, bWasMovingLastUpdate);
+		K.LocalVelocityOctantNoOffset = SelectDirectionFromAngle<8>(Angle, DeadZone, K.LocalVelocityOctantNoOffset, bWasMovingLastUpdate);
+		K.bHasVelocity = K.LocalVelocityX * K.LocalVelocityX + K.LocalVelocityY * K.LocalVelocityY > SmallNumber;
+
+		// Acceleration data
+		K.LocalAccelerationX = Inputs.AccelerationX * Inputs.AxisXX + Inputs.AccelerationY * Inputs.AxisXY;
+		K.LocalAccelerationY = Inputs.AccelerationX * Inputs.AxisYX + Inputs.AccelerationY * Inputs.AxisYY;
+		K.LocalAccelerationZ = Inputs.AccelerationX * Inputs.AxisZX + Inputs.AccelerationY * Inputs.AxisZY;
+		K.bHasAcceleration = K.LocalAccelerationX * K.LocalAccelerationX + K.LocalAccelerationY * K.LocalAccelerationY > SmallNumber;
+		K.bIsRunningIntoWall = IsRunningIntoWall(K.LocalVelocityX, K.LocalVelocityY, K.LocalAccelerationX, K.LocalAccelerationY);
+
+		const float AccelerationSquareSum = Inputs.AccelerationX * Inputs.AccelerationX + Inputs.AccelerationY * Inputs.AccelerationY;
+		const float AccelerationScale = AccelerationSquareSum < SmallNumber ? 0 : 1.0f / std::sqrt(AccelerationSquareSum);
+		const float PivotX = K.PivotDirectionX + (Inputs.AccelerationX * AccelerationScale - K.PivotDirectionX) * 0.5f;
+		const float PivotY = K.PivotDirectionY + (Inputs.AccelerationY * AccelerationScale - K.PivotDirectionY) * 0.5f;
+		const float PivotSquareSum = PivotX * PivotX + PivotY * PivotY;
+		const float PivotScale = PivotSquareSum < SmallNumber ? 0 : 1.0f / std::sqrt(PivotSquareSum);
+		K.PivotDirectionX = PivotX * PivotScale;
+		K.PivotDirectionY = PivotY * PivotScale;
+
+		const float PivotAngle = CalculateDirection2D(K.PivotDirectionX, K.PivotDirectionY, Inputs.AxisXX, Inputs.AxisXY, Inputs.AxisYX, Inputs.AxisYY);
+		K.CardinalDirectionFromAcceleration = GetOppositeCardinalDirection(
+			SelectCardinalDirectionFromAngle(PivotAngle, DeadZone, DirectionType::Forward, false));
+		K.OctantFromAcceleration = GetOppositeDirection<8>(SelectDirectionFromAngle<8>(PivotAngle, DeadZone, 0, false));
+
+		// Root yaw offset, held unless the last update asked to accumulate or blend it out, which it does by default
+		float NewRootYawOffset = K.RootYawOffset;
+		if (K.RootYawOffsetMode == RootYawOffsetModeType::Accumulate)
+		{
+			NewRootYawOffset -= K.YawDeltaSinceLastUpdate;
+		}
+		else if (K.RootYawOffsetMode == RootYawOffsetModeType::BlendOut)
+		{
+			NewRootYawOffset = BlendOutRootYawOffset(NewRootYawOffset, K.RootYawOffsetSpringState, DeltaTime);
+		}
+		K.RootYawOffset = ClampRootYawOffset(NewRootYawOffset, Tuning.RootYawOffsetMinAngle, Tuning.RootYawOffsetMaxAngle);
+		K.RootYawOffsetMode = RootYawOffsetModeType::BlendOut;
+
+		K.PrevLocationX = Inputs.LocationX;
+		K.PrevLocationY = Inputs.LocationY;
+		K.PrevYaw = Inputs.Yaw;
+		K.bIsFirstUpdate = false;
+	}
+
+	// Distance between two playback times of a looping sequence, the short way around the loop
+	inline float LoopingTimeDistance(float TimeA, float TimeB, float PlayLength)
+	{
+		const float Distance = std::fabs(TimeA - TimeB);
+		if (PlayLength <= SmallNumber)
+		{
+			return Distance;
+		}
+
+		const float WrappedDistance = std::fmod(Distance, PlayLength);
+		return std::fmin(WrappedDistance, PlayLength - WrappedDistance);
+	}
+
+	// Seconds to wait since the last ground distance before tracing an airborne character again. Far from the apex while rising,
+	// or far from the ground while falling, the extrapolated distance is good enough. A trace issued now only arrives next frame,
+	// so the wait stops one frame, about as long as the last one, short of the latency tolerance the result has to stay within.
+	inline float GroundTraceInterval(float VerticalSpeed, float GravityZ, float ExtrapolatedGroundDistance, float LastDeltaTime,
+		float LatencyTolerance, float ApexTimeThreshold, float TimeToGroundRatio)
+	{
+		float Interval = 0;
+		if (VerticalSpeed > 0)
+		{
+			const float TimeToJumpApex = GravityZ < 0 ? -VerticalSpeed / GravityZ : 0;
+			Interval = TimeToJumpApex > ApexTimeThreshold ? LatencyTolerance : 0;
+		}
+		else
+		{
+			const float TimeToGround = ExtrapolatedGroundDistance / std::fmax(-VerticalSpeed, 1.0f);
+			Interval = TimeToGround * TimeToGroundRatio;
+		}
+		return std::fmin(std::fmax(Interval, 0.0f), std::fmax(LatencyTolerance - LastDeltaTime, 0.0f));
+	}
+
+	// Seconds before the first idle break, 6 to 15 picked from the location so characters standing together don't break in sync
+	inline float IdleBreakDelayTime(double X, double Y)
+	{
+		return static_cast<float>(static_cast<int64_t>(std::fabs(X + Y)) % 10 + 6);
+	}
+
+	// Size2D of UAnimCharacterMovementLibrary::PredictGroundMovementStopLocation. Velocity and braking deceleration
+	// both act along the velocity, so the stopping distance reduces to v^2 / (2 * (friction * v + deceleration)).
+	inline float PredictGroundMovementStopDistance(float VelocityX, float VelocityY,
+		bool bUseSeparateBrakingFriction, float BrakingFriction, float GroundFriction, float BrakingFrictionFactor, float BrakingDecelerationWalking)
+	{
+		const float ActualBrakingFriction = std::fmax(0.0f, (bUseSeparateBrakingFriction ? BrakingFriction : GroundFriction) * BrakingFrictionFactor);
+		const float BrakingDeceleration = std::fmax(0.0f, BrakingDecelerationWalking);
+		const float Speed2D = std::sqrt(VelocityX * VelocityX + VelocityY * VelocityY);
+		const float Divisor = ActualBrakingFriction * Speed2D + BrakingDeceleration;
+		return Divisor > 0 ? 0.5f * Speed2D * Speed2D / Divisor : 0;
+	}
+
+	// Size2D of UAnimCharacterMovementLibrary::PredictGroundMovementPivotLocation, 0 unless accelerating against the velocity
+	inline float PredictGroundMovementPivotDistance(float AccelerationX, float AccelerationY, float VelocityX, float VelocityY, float GroundFriction)
+	{
+		const float AccelerationSize2D = std::sqrt(AccelerationX * AccelerationX + AccelerationY * AccelerationY);
+		if (AccelerationSize2D <= SmallNumber)
+		{
+			return 0;
+		}
+
+		const float DirectionX = AccelerationX / AccelerationSize2D;
+		const float DirectionY = AccelerationY / AccelerationSize2D;
+		const float VelocityAlongAcceleration = VelocityX * DirectionX + VelocityY * DirectionY;
+		if (VelocityAlongAcceleration >= 0)
+		{
+			return 0;
+		}
+
+		const float SpeedAlongAcceleration = -VelocityAlongAcceleration;
+		const float TimeToDirectionChange = SpeedAlongAcceleration / (AccelerationSize2D + 2.0f * SpeedAlongAcceleration * GroundFriction);
+
+		const float Speed2D = std::sqrt(VelocityX * VelocityX + VelocityY * VelocityY);
+		const float ForceX = AccelerationX - (VelocityX - DirectionX * Speed2D) * GroundFriction;
+		const float ForceY = AccelerationY - (VelocityY - DirectionY * Speed2D) * GroundFriction;
+
+		const float HalfTimeSquared = 0.5f * TimeToDirectionChange * TimeToDirectionChange;
+		const float PivotX = VelocityX * TimeToDirectionChange + ForceX * HalfTimeSquared;
+		const float PivotY = VelocityY * TimeToDirectionChange + ForceY * HalfTimeSquared;
+		return std::sqrt(PivotX * PivotX + PivotY * PivotY);
+	}
+
+	// Velocity change in cm/s below which a memoized stop or pivot distance is reused, well under a millimeter of distance at run speeds
+	constexpr float PredictionVelocityTolerance = 0.5f;
+
+	// Last stop and pivot distances with the inputs they were predicted from. Velocity and acceleration within
+	// PredictionVelocityTolerance and unchanged friction reuse the last distance, which covers the updates where
+	// the movement component didn't move the character and repeated queries within one update.
+	struct FLLGroundMovementPrediction
+	{
+		float StopDistance(float VelocityX, float VelocityY,
+			bool bUseSeparateBrakingFriction, float BrakingFriction, float GroundFriction, float BrakingFrictionFactor, float BrakingDecelerationWalking)
+		{
+			const float ActualBrakingFriction = (bUseSeparateBrakingFriction ? BrakingFriction : GroundFriction) * BrakingFrictionFactor;
+			if (!bStopValid || !IsNearlyEqual(StopVelocityX, VelocityX) || !IsNearlyEqual(StopVelocityY, VelocityY) ||
+				StopBrakingFriction != ActualBrakingFriction || StopBrakingDeceleration != BrakingDecelerationWalking)
+			{
+				StopVelocityX = VelocityX;
+				StopVelocityY = VelocityY;
+				StopBrakingFriction = ActualBrakingFriction;
+				StopBrakingDeceleration = BrakingDecelerationWalking;
+				StopDistanceValue = PredictGroundMovementStopDistance(VelocityX, VelocityY, false, 0, ActualBrakingFriction, 1, BrakingDecelerationWalking);
+				bStopValid = true;
+			}
+			return StopDistanceValue;
+		}
+
+		float PivotDistance(float AccelerationX, float AccelerationY, float VelocityX, float VelocityY, float GroundFriction)
+		{
+			if (!bPivotValid || !IsNearlyEqual(PivotAccelerationX, AccelerationX) || !IsNearlyEqual(PivotAccelerationY, AccelerationY) ||
+				!IsNearlyEqual(PivotVelocityX, VelocityX) || !IsNearlyEqual(PivotVelocityY, VelocityY) || PivotGroundFriction != GroundFriction)
+			{
+				PivotAccelerationX = AccelerationX;
+				PivotAccelerationY = AccelerationY;
+				PivotVelocityX = VelocityX;
+				PivotVelocityY = VelocityY;
+				PivotGroundFriction = GroundFriction;
+				PivotDistanceValue = PredictGroundMovementPivotDistance(AccelerationX, AccelerationY, VelocityX, VelocityY, GroundFriction);
+				bPivotValid = true;
+			}
+			return PivotDistanceValue;
+		}
+
+		void Reset()
+		{
+			bStopValid = false;
+			bPivotValid = false;
+		}
+
+	private:
+		static bool IsNearlyEqual(float A, float B)
+		{
+			return std::fabs(A - B) <= PredictionVelocityTolerance;
+		}
+
+		float StopVelocityX = 0;
+		float StopVelocityY = 0;
+		float StopBrakingFriction = 0;
+		float StopBrakingDeceleration = 0;
+		float StopDistanceValue = 0;
+
+		float PivotAccelerationX = 0;
+		float PivotAccelerationY = 0;
+		float PivotVelocityX = 0;
+		float PivotVelocityY = 0;
+		float PivotGroundFriction = 0;
+		float PivotDistanceValue = 0;
+
+		bool bStopValid = false;
+		bool bPivotValid = false;
+	};
+}
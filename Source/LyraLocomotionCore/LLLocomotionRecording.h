@@ -0,0 +1,153 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+// Binary format of a recording of the locomotion inputs ULLAnimInstance gathers each update, written by
+// FLLLocomotionRecorder in the game and read back from a memory mapped file by LLLocomotionReplay.
+// A header followed by fixed size records in capture order and the tuning of each character, little endian, with
+// no pointers or variable length data, so the mapped file is read in place.
+
+#include "LLLocomotionMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace LLLocomotionRecording
+{
+	// "LLRC"
+	constexpr uint32_t Magic = 0x43524C4C;
+
+	// Bumped whenever a field changes meaning. Fields appended to FLLInputRecord only grow RecordSize, older readers skip them.
+	constexpr uint32_t Version = 2;
+
+	struct FLLRecordingHeader
+	{
+		uint32_t Magic = LLLocomotionRecording::Magic;
+		uint32_t Version = LLLocomotionRecording::Version;
+		uint32_t HeaderSize = sizeof(FLLRecordingHeader);
+		uint32_t RecordSize = 0;
+		uint32_t NumCharacters = 0;
+		uint32_t NumFrames = 0;
+		// Written when the recording stops, a recording that never stopped reads as empty
+		uint64_t NumRecords = 0;
+		// Offset from the start of the file of the FLLKinematicsTuning of each character, written after the records
+		uint64_t TuningOffset = 0;
+	};
+
+	static_assert(sizeof(FLLRecordingHeader) == 40, "FLLRecordingHeader is part of the file format");
+	static_assert(sizeof(LLLocomotionMath::FLLKinematicsTuning) == 12 && std::is_trivially_copyable_v<LLLocomotionMath::FLLKinematicsTuning>,
+		"FLLKinematicsTuning is part of the file format");
+
+	enum EInputFlags : uint8_t
+	{
+		UseSeparateBrakingFriction = 1 << 0,
+		MovingOnGround = 1 << 1,
+		AnyMontagePlaying = 1 << 2
+	};
+
+	// Inputs of one update of one character, the FLLLocomotionSnapshot and ground distance the anim instance saw
+	struct FLLInputRecord
+	{
+		// Frames since the recording started, and the character in the order it was first recorded
+		uint32_t Frame = 0;
+		uint16_t Character = 0;
+		// EMovementMode
+		uint8_t MovementMode = 0;
+		// EInputFlags
+		uint8_t Flags = 0;
+
+		float DeltaTime = 0;
+		// -1 when no ground distance was measured
+		float GroundDistance = -1.0f;
+
+		double LocationX = 0;
+		double LocationY = 0;
+		double LocationZ = 0;
+
+		float VelocityX = 0;
+		float VelocityY = 0;
+		float VelocityZ = 0;
+		float AccelerationX = 0;
+		float AccelerationY = 0;
+		float AccelerationZ = 0;
+		float LastUpdateVelocityX = 0;
+		float LastUpdateVelocityY = 0;
+		float LastUpdateVelocityZ = 0;
+		float Pitch = 0;
+		float Yaw = 0;
+		float Roll = 0;
+
+		float GroundFriction = 0;
+		float BrakingFriction = 0;
+		float BrakingFrictionFactor = 0;
+		float BrakingDecelerationWalking = 0;
+		float GravityZ = 0;
+		uint32_t Reserved = 0;
+
+		bool HasFlag(EInputFlags Flag) const { return (Flags & Flag) != 0; }
+	};
+
+	static_assert(sizeof(FLLInputRecord) == 112 && alignof(FLLInputRecord) == 8, "FLLInputRecord is part of the file format");
+	static_assert(std::is_trivially_copyable_v<FLLInputRecord>, "FLLInputRecord is written and mapped as a block");
+
+	// Records of a recording in memory, usually a mapped file. Doesn't own or copy the data.
+	class FLLRecordingView
+	{
+	public:
+		// False when the data isn't a complete recording of this version
+		bool Open(const void* Data, uint64_t Size)
+		{
+			Header = nullptr;
+			Records = nullptr;
+
+			if (Data == nullptr || Size < sizeof(FLLRecordingHeader))
+			{
+				return false;
+			}
+
+			const FLLRecordingHeader* InHeader = static_cast<const FLLRecordingHeader*>(Data);
+			if (InHeader->Magic != LLLocomotionRecording::Magic || InHeader->Version != LLLocomotionRecording::Version ||
+				InHeader->HeaderSize < sizeof(FLLRecordingHeader) || InHeader->RecordSize < sizeof(FLLInputRecord) ||
+				InHeader->HeaderSize % alignof(FLLInputRecord) != 0 || InHeader->RecordSize % alignof(FLLInputRecord) != 0)
+			{
+				return false;
+			}
+
+			if (Size < InHeader->HeaderSize || InHeader->NumRecords > (Size - InHeader->HeaderSize) / InHeader->RecordSize)
+			{
+				return false;
+			}
+
+			const uint64_t RecordsEnd = InHeader->HeaderSize + InHeader->NumRecords * InHeader->RecordSize;
+			if (InHeader->TuningOffset < RecordsEnd || InHeader->TuningOffset % alignof(LLLocomotionMath::FLLKinematicsTuning) != 0 ||
+				InHeader->TuningOffset > Size || InHeader->NumCharacters > (Size - InHeader->TuningOffset) / sizeof(LLLocomotionMath::FLLKinematicsTuning))
+			{
+				return false;
+			}
+
+			Header = InHeader;
+			Records = static_cast<const uint8_t*>(Data) + InHeader->HeaderSize;
+			Tunings = reinterpret_cast<const LLLocomotionMath::FLLKinematicsTuning*>(static_cast<const uint8_t*>(Data) + InHeader->TuningOffset);
+			return true;
+		}
+
+		const FLLRecordingHeader& GetHeader() const { return *Header; }
+		uint64_t Num() const { return Header ? Header->NumRecords : 0; }
+
+		const FLLInputRecord& operator[](uint64_t Index) const
+		{
+			return *reinterpret_cast<const FLLInputRecord*>(Records + Index * Header->RecordSize);
+		}
+
+		// Tuning the anim instance of a character had when it was first recorded
+		const LLLocomotionMath::FLLKinematicsTuning& GetTuning(uint16_t Character) const
+		{
+			return Tunings[Character];
+		}
+
+	private:
+		const FLLRecordingHeader* Header = nullptr;
+		const uint8_t* Records = nullptr;
+		const LLLocomotionMath::FLLKinematicsTuning* Tunings = nullptr;
+	};
+}
@@ -0,0 +1,28 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+// Frame to frame hand-off of the locomotion snapshot without any engine dependency, so the threaded test builds with plain CMake.
+
+#include <type_traits>
+
+// A value written during a frame that readers only see from the next frame on. Publish runs once at the start of
+// each frame, after the previous frame's anim tasks completed and before anything of this frame ticks, so every
+// reader of a frame sees the same value exactly one frame old, whether it ticks before or after the writer.
+// Readers on worker threads copy the published value on the game thread before they're kicked off, the writer
+// may overwrite the pending value while they run but never the published one.
+template <typename T>
+class TLLPipelinedValue
+{
+	static_assert(std::is_trivially_copyable_v<T>, "TLLPipelinedValue publishes by copying the value as a block");
+
+public:
+	T& GetPending() { return Pending; }
+	const T& GetPublished() const { return Published; }
+
+	void Publish() { Published = Pending; }
+
+private:
+	T Pending {};
+	T Published {};
+};
@@ -0,0 +1,250 @@
+// Copyright 2024 jeonghun
+
+// Replays a recording of locomotion inputs through LLLocomotionMath::ComputeKinematics, the same step the kinematics batch
+// of ULLLocomotionSubsystem runs, with the tuning each character was recorded with, and through the stop and pivot predictions,
+// with no engine, world or physics. Reports the time per update and a checksum of the results. The checksum only changes
+// when the locomotion math does, so two builds can be compared on the same recording.
+//
+// LLLocomotionReplay <recording> [Iterations=100]
+
+#include "LLLocomotionMath.h"
+#include "LLLocomotionRecording.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	using namespace LLLocomotionRecording;
+
+	enum class ECardinalDirection : uint8_t
+	{
+		Forward,
+		Backward,
+		Left,
+		Right
+	};
+
+	enum class ERootYawOffsetMode : uint8_t
+	{
+		BlendOut,
+		Hold,
+		Accumulate
+	};
+
+	// Read only mapping of a whole file
+	class FMappedFile
+	{
+	public:
+		explicit FMappedFile(const char* Path)
+		{
+#if defined(_WIN32)
+			File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER FileSize;
+			if (File == INVALID_HANDLE_VALUE || !GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+			{
+				return;
+			}
+			Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (Mapping != nullptr)
+			{
+				Data = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+				Size = Data ? static_cast<uint64_t>(FileSize.QuadPart) : 0;
+			}
+#else
+			const int File = open(Path, O_RDONLY);
+			struct stat Stat;
+			if (File < 0)
+			{
+				return;
+			}
+			if (fstat(File, &Stat) == 0 && Stat.st_size > 0)
+			{
+				void* Mapped = mmap(nullptr, static_cast<size_t>(Stat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+				if (Mapped != MAP_FAILED)
+				{
+					Data = Mapped;
+					Size = static_cast<uint64_t>(Stat.st_size);
+				}
+			}
+			close(File);
+#endif
+		}
+
+		~FMappedFile()
+		{
+#if defined(_WIN32)
+			if (Data)
+			{
+				UnmapViewOfFile(Data);
+			}
+			if (Mapping)
+			{
+				CloseHandle(Mapping);
+			}
+			if (File != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(File);
+			}
+#else
+			if (Data)
+			{
+				munmap(Data, static_cast<size_t>(Size));
+			}
+#endif
+		}
+
+		FMappedFile(const FMappedFile&) = delete;
+		FMappedFile& operator=(const FMappedFile&) = delete;
+
+		const void* GetData() const { return Data; }
+		uint64_t GetSize() const { return Size; }
+
+	private:
+#if defined(_WIN32)
+		HANDLE File = INVALID_HANDLE_VALUE;
+		HANDLE Mapping = nullptr;
+#endif
+		void* Data = nullptr;
+		uint64_t Size = 0;
+	};
+
+	// What ULLAnimInstance carries between updates for the replayed part of its update
+	struct FReplayCharacter
+	{
+		LLLocomotionMath::TLLKinematics<ECardinalDirection, ERootYawOffsetMode> Kinematics;
+		LLLocomotionMath::FLLGroundMovementPrediction GroundMovementPrediction;
+	};
+
+	uint64_t HashCombine(uint64_t Hash, float Value)
+	{
+		uint32_t Bits;
+		std::memcpy(&Bits, &Value, sizeof(Bits));
+		return (Hash ^ Bits) * 0x100000001B3ull;
+	}
+
+	// LLLocomotionMath::ComputeKinematics as ULLLocomotionSubsystem batches it, followed by the stop and pivot predictions of the stop
+	// and pivot states. The graph isn't replayed, so the root yaw offset accumulates after any update that left the character
+	// standing still on the ground, as the idle state asks for, and blends out otherwise.
+	uint64_t ReplayUpdate(const FLLInputRecord& Record, const LLLocomotionMath::FLLKinematicsTuning& Tuning, FReplayCharacter& Character, uint64_t Hash)
+	{
+		LLLocomotionMath::FLLKinematicsInputs Inputs;
+		Inputs.LocationX = Record.LocationX;
+		Inputs.LocationY = Record.LocationY;
+		Inputs.SetRotation(Record.Pitch, Record.Yaw, Record.Roll);
+		Inputs.VelocityX = Record.VelocityX;
+		Inputs.VelocityY = Record.VelocityY;
+		Inputs.AccelerationX = Record.AccelerationX;
+		Inputs.AccelerationY = Record.AccelerationY;
+
+		auto& K = Character.Kinematics;
+		LLLocomotionMath::ComputeKinematics(Inputs, Tuning, Record.DeltaTime, K);
+
+		if (Record.HasFlag(MovingOnGround) && !K.bHasVelocity && !K.bHasAcceleration)
+		{
+			K.RootYawOffsetMode = ERootYawOffsetMode::Accumulate;
+		}
+
+		// Stop and pivot predictions
+		float PredictedDistance = 0;
+		if (K.bHasVelocity && !K.bHasAcceleration)
+		{
+			PredictedDistance = Character.GroundMovementPrediction.StopDistance(Record.LastUpdateVelocityX, Record.LastUpdateVelocityY,
+				Record.HasFlag(UseSeparateBrakingFriction), Record.BrakingFriction, Record.GroundFriction,
+				Record.BrakingFrictionFactor, Record.BrakingDecelerationWalking);
+		}
+		else if (K.bHasVelocity && K.LocalVelocityX * K.LocalAccelerationX + K.LocalVelocityY * K.LocalAccelerationY < 0)
+		{
+			PredictedDistance = Character.GroundMovementPrediction.PivotDistance(
+				Record.AccelerationX, Record.AccelerationY, Record.LastUpdateVelocityX, Record.LastUpdateVelocityY, Record.GroundFriction);
+		}
+
+		Hash = HashCombine(Hash, K.DisplacementSpeed);
+		Hash = HashCombine(Hash, K.AdditiveLeanAngle);
+		Hash = HashCombine(Hash, K.RootYawOffset);
+		Hash = HashCombine(Hash, PredictedDistance);
+		Hash = HashCombine(Hash, static_cast<float>(static_cast<int32_t>(K.LocalVelocityDirection) << 4 |
+			static_cast<int32_t>(K.LocalVelocityDirectionNoOffset) << 2 | static_cast<int32_t>(K.CardinalDirectionFromAcceleration)));
+		Hash = HashCombine(Hash, static_cast<float>(K.LocalVelocityOctant << 6 | K.LocalVelocityOctantNoOffset << 3 | K.OctantFromAcceleration));
+		return Hash;
+	}
+
+	uint64_t Replay(const FLLRecordingView& Recording, std::vector<FReplayCharacter>& Characters)
+	{
+		uint64_t Hash = 0xCBF29CE484222325ull;
+		for (uint64_t Index = 0; Index < Recording.Num(); ++Index)
+		{
+			const FLLInputRecord& Record = Recording[Index];
+			if (Record.Character < Characters.size())
+			{
+				Hash = ReplayUpdate(Record, Recording.GetTuning(Record.Character), Characters[Record.Character], Hash);
+			}
+		}
+		return Hash;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <recording> [Iterations=100]\n", argv[0]);
+		return 2;
+	}
+
+	const int32_t NumIterations = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 100;
+
+	const FMappedFile File(argv[1]);
+	FLLRecordingView Recording;
+	if (!Recording.Open(File.GetData(), File.GetSize()))
+	{
+		std::fprintf(stderr, "%s is not a complete version %u locomotion recording\n", argv[1], Version);
+		return 1;
+	}
+
+	const FLLRecordingHeader& Header = Recording.GetHeader();
+	std::printf("%s: %llu updates of %u characters over %u frames\n", argv[1],
+		static_cast<unsigned long long>(Recording.Num()), Header.NumCharacters, Header.NumFrames);
+
+	std::vector<double> NsPerUpdate;
+	NsPerUpdate.reserve(NumIterations);
+	uint64_t Checksum = 0;
+	for (int32_t Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		std::vector<FReplayCharacter> Characters(Header.NumCharacters);
+
+		const auto Start = std::chrono::steady_clock::now();
+		const uint64_t Hash = Replay(Recording, Characters);
+		const auto End = std::chrono::steady_clock::now();
+
+		if (Iteration > 0 && Hash != Checksum)
+		{
+			std::fprintf(stderr, "Iteration %d replayed to checksum %016llx instead of %016llx\n",
+				Iteration, static_cast<unsigned long long>(Hash), static_cast<unsigned long long>(Checksum));
+			return 1;
+		}
+		Checksum = Hash;
+
+		const double Ns = std::chrono::duration<double, std::nano>(End - Start).count();
+		NsPerUpdate.push_back(Recording.Num() > 0 ? Ns / static_cast<double>(Recording.Num()) : 0);
+	}
+
+	std::sort(NsPerUpdate.begin(), NsPerUpdate.end());
+	std::printf("%d iterations | p50 %.2f ns/update | p99 %.2f ns/update | checksum %016llx\n", NumIterations,
+		NsPerUpdate[NsPerUpdate.size() / 2], NsPerUpdate[std::min(NsPerUpdate.size() - 1, NsPerUpdate.size() * 99 / 100)],
+		static_cast<unsigned long long>(Checksum));
+	return 0;
+}
@@ -0,0 +1,278 @@
+// Copyright 2024 jeonghun
+
+#include "LLLocomotionMath.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	// Fine enough that the distances are those of the braking model rather than of the frame rate it's integrated at
+	constexpr double SimulationTimeStep = 1.0 / 1000.0;
+	constexpr double BrakeToStopVelocity = 10.0;
+
+	// UCharacterMovementComponent::ApplyVelocityBraking run frame after frame until the character stops,
+	// moving it by the braked velocity of each frame like PhysWalking does
+	double SimulateStopDistance(double VelocityX, double VelocityY, double Friction, double BrakingDeceleration)
+	{
+		Friction = std::max(0.0, Friction);
+		BrakingDeceleration = std::max(0.0, BrakingDeceleration);
+		if (Friction == 0 && BrakingDeceleration == 0)
+		{
+			return 0;
+		}
+
+		double LocationX = 0;
+		double LocationY = 0;
+		for (int32_t Step = 0; Step < 1000000; ++Step)
+		{
+			const double OldVelocityX = VelocityX;
+			const double OldVelocityY = VelocityY;
+			const double Speed = std::hypot(VelocityX, VelocityY);
+			const double ReverseAccelerationX = -BrakingDeceleration * VelocityX / Speed;
+			const double ReverseAccelerationY = -BrakingDeceleration * VelocityY / Speed;
+
+			VelocityX += (-Friction * VelocityX + ReverseAccelerationX) * SimulationTimeStep;
+			VelocityY += (-Friction * VelocityY + ReverseAccelerationY) * SimulationTimeStep;
+
+			const double SpeedSquared = VelocityX * VelocityX + VelocityY * VelocityY;
+			if (VelocityX * OldVelocityX + VelocityY * OldVelocityY <= 0 || SpeedSquared <= 1.e-4 ||
+				(BrakingDeceleration > 0 && SpeedSquared <= BrakeToStopVelocity * BrakeToStopVelocity))
+			{
+				break;
+			}
+
+			LocationX += VelocityX * SimulationTimeStep;
+			LocationY += VelocityY * SimulationTimeStep;
+		}
+		return std::hypot(LocationX, LocationY);
+	}
+
+	// UCharacterMovementComponent::CalcVelocity while accelerating, until the velocity no longer points against the acceleration
+	double SimulatePivotDistance(double AccelerationX, double AccelerationY, double VelocityX, double VelocityY, double Friction)
+	{
+		const double AccelerationSize = std::hypot(AccelerationX, AccelerationY);
+		const double DirectionX = AccelerationX / AccelerationSize;
+		const double DirectionY = AccelerationY / AccelerationSize;
+
+		double LocationX = 0;
+		double LocationY = 0;
+		for (int32_t Step = 0; Step < 1000000 && VelocityX * DirectionX + VelocityY * DirectionY < 0; ++Step)
+		{
+			const double Speed = std::hypot(VelocityX, VelocityY);
+			const double FrictionAmount = std::min(SimulationTimeStep * Friction, 1.0);
+			VelocityX += -(VelocityX - DirectionX * Speed) * FrictionAmount + AccelerationX * SimulationTimeStep;
+			VelocityY += -(VelocityY - DirectionY * Speed) * FrictionAmount + AccelerationY * SimulationTimeStep;
+
+			LocationX += VelocityX * SimulationTimeStep;
+			LocationY += VelocityY * SimulationTimeStep;
+		}
+		return std::hypot(LocationX, LocationY);
+	}
+}
+
+// The closed form brakes at the deceleration the character starts with. Friction only weakens as it slows down,
+// so the prediction never overshoots the simulated stop, is exact without friction and at worst half of it when
+// friction does all of the braking.
+TEST(LLGroundMovementPrediction, StopDistanceAgainstSimulatedBraking)
+{
+	std::mt19937 Random(1);
+	std::uniform_real_distribution<double> Speeds(50.0, 800.0);
+	std::uniform_real_distribution<double> Angles(-3.14159, 3.14159);
+
+	for (const float GroundFriction : { 0.0f, 1.0f, 4.0f, 8.0f })
+	{
+		for (const float BrakingFrictionFactor : { 1.0f, 2.0f })
+		{
+			for (const float BrakingDeceleration : { 256.0f, 1024.0f, 2048.0f, 4096.0f })
+			{
+				for (int32_t Sample = 0; Sample < 8; ++Sample)
+				{
+					const double Speed = Speeds(Random);
+					const double Angle = Angles(Random);
+					const float VelocityX = static_cast<float>(Speed * std::cos(Angle));
+					const float VelocityY = static_cast<float>(Speed * std::sin(Angle));
+					const double Friction = GroundFriction * BrakingFrictionFactor;
+
+					const double Simulated = SimulateStopDistance(VelocityX, VelocityY, Friction, BrakingDeceleration);
+					const float Predicted = LLLocomotionMath::PredictGroundMovementStopDistance(
+						VelocityX, VelocityY, false, 0, GroundFriction, BrakingFrictionFactor, BrakingDeceleration);
+
+					// The simulation stops short by up to the last step and the brake to stop velocity
+					const double Slack = Speed * SimulationTimeStep + BrakeToStopVelocity * BrakeToStopVelocity / (2.0 * BrakingDeceleration);
+					EXPECT_LE(Predicted, Simulated + Slack) << "Speed " << Speed << " friction " << Friction << " deceleration " << BrakingDeceleration;
+					EXPECT_GE(Predicted, 0.5 * Simulated - Slack) << "Speed " << Speed << " friction " << Friction << " deceleration " << BrakingDeceleration;
+					if (GroundFriction == 0)
+					{
+						EXPECT_NEAR(Predicted, Simulated, Slack) << "Speed " << Speed << " deceleration " << BrakingDeceleration;
+					}
+				}
+			}
+		}
+	}
+}
+
+// Without friction the acceleration is all there is and the closed form is exact at any angle. Straight against
+// the velocity, friction adds to the deceleration like braking friction does to a stop, with the same bounds.
+TEST(LLGroundMovementPrediction, PivotDistanceAgainstSimulatedAcceleration)
+{
+	std::mt19937 Random(2);
+	std::uniform_real_distribution<double> Speeds(50.0, 800.0);
+	std::uniform_real_distribution<double> Accelerations(200.0, 2400.0);
+	std::uniform_real_distribution<double> Angles(-3.14159, 3.14159);
+	std::uniform_real_distribution<double> PivotAngles(-1.2, 1.2);
+
+	for (const float GroundFriction : { 0.0f, 1.0f, 4.0f, 8.0f })
+	{
+		for (int32_t Sample = 0; Sample < 32; ++Sample)
+		{
+			const double Speed = Speeds(Random);
+			const double Angle = Angles(Random);
+			const double Acceleration = Accelerations(Random);
+			// Any angle past 90 degrees off the velocity without friction, straight back with it
+			const double AccelerationAngle = Angle + 3.14159 + (GroundFriction == 0 ? PivotAngles(Random) : 0.0);
+
+			const float VelocityX = static_cast<float>(Speed * std::cos(Angle));
+			const float VelocityY = static_cast<float>(Speed * std::sin(Angle));
+			const float AccelerationX = static_cast<float>(Acceleration * std::cos(AccelerationAngle));
+			const float AccelerationY = static_cast<float>(Acceleration * std::sin(AccelerationAngle));
+
+			const double Simulated = SimulatePivotDistance(AccelerationX, AccelerationY, VelocityX, VelocityY, GroundFriction);
+			const float Predicted = LLLocomotionMath::PredictGroundMovementPivotDistance(AccelerationX, AccelerationY, VelocityX, VelocityY, GroundFriction);
+
+			const double Slack = 2.0 * Speed * SimulationTimeStep;
+			if (GroundFriction == 0)
+			{
+				EXPECT_NEAR(Predicted, Simulated, Slack) << "Speed " << Speed << " acceleration " << Acceleration;
+			}
+			else
+			{
+				EXPECT_LE(Predicted, Simulated + Slack) << "Speed " << Speed << " acceleration " << Acceleration << " friction " << GroundFriction;
+				EXPECT_GE(Predicted, 0.5 * Simulated - Slack) << "Speed " << Speed << " acceleration " << Acceleration << " friction " << GroundFriction;
+			}
+		}
+	}
+}
+
+// The memoized prediction returns the distance of the inputs it last predicted from as long as every velocity and
+// acceleration component stays within PredictionVelocityTolerance of them and the friction is unchanged, and predicts
+// again otherwise. Its error against a direct prediction is bounded by the slope of the distance over the tolerance.
+TEST(LLGroundMovementPrediction, MemoizedStopDistance)
+{
+	using LLLocomotionMath::PredictionVelocityTolerance;
+
+	std::mt19937 Random(3);
+	std::uniform_real_distribution<float> Drift(-0.3f, 0.3f);
+	std::uniform_real_distribution<float> Jumps(-600.0f, 600.0f);
+	std::bernoulli_distribution ShouldJump(0.05);
+	std::bernoulli_distribution ShouldChangeFriction(0.02);
+
+	LLLocomotionMath::FLLGroundMovementPrediction Prediction;
+	float VelocityX = 400.0f;
+	float VelocityY = -150.0f;
+	float GroundFriction = 8.0f;
+	const float BrakingDeceleration = 2048.0f;
+
+	bool bHasAnchor = false;
+	float AnchorX = 0;
+	float AnchorY = 0;
+	float AnchorFriction = 0;
+
+	int32_t NumPredictions = 0;
+	for (int32_t Query = 0; Query < 20000; ++Query)
+	{
+		if (ShouldJump(Random))
+		{
+			VelocityX = Jumps(Random);
+			VelocityY = Jumps(Random);
+		}
+		else
+		{
+			VelocityX += Drift(Random);
+			VelocityY += Drift(Random);
+		}
+		if (ShouldChangeFriction(Random))
+		{
+			GroundFriction = GroundFriction == 8.0f ? 2.0f : 8.0f;
+		}
+
+		const bool bReuse = bHasAnchor && std::fabs(VelocityX - AnchorX) <= PredictionVelocityTolerance &&
+			std::fabs(VelocityY - AnchorY) <= PredictionVelocityTolerance && GroundFriction == AnchorFriction;
+		if (!bReuse)
+		{
+			bHasAnchor = true;
+			AnchorX = VelocityX;
+			AnchorY = VelocityY;
+			AnchorFriction = GroundFriction;
+			++NumPredictions;
+		}
+
+		const float Memoized = Prediction.StopDistance(VelocityX, VelocityY, false, 0, GroundFriction, 2, BrakingDeceleration);
+		const float AtAnchor = LLLocomotionMath::PredictGroundMovementStopDistance(AnchorX, AnchorY, false, 0, AnchorFriction, 2, BrakingDeceleration);
+		ASSERT_EQ(Memoized, AtAnchor) << "Query " << Query;
+
+		// d/dv of v^2 / (2 (f v + b)) is v (f v / 2 + b) / (f v + b)^2, at most v / (f v + b)
+		const float Direct = LLLocomotionMath::PredictGroundMovementStopDistance(VelocityX, VelocityY, false, 0, GroundFriction, 2, BrakingDeceleration);
+		const double MaxSpeed = std::max(std::hypot(VelocityX, VelocityY), std::hypot(AnchorX, AnchorY));
+		const double MaxSlope = MaxSpeed / (GroundFriction * 2 * MaxSpeed + BrakingDeceleration);
+		ASSERT_LE(std::fabs(Memoized - Direct), MaxSlope * PredictionVelocityTolerance * std::sqrt(2.0) + 1.e-4) << "Query " << Query;
+	}
+
+	// Most queries drift within the tolerance and reuse the last distance
+	EXPECT_LT(NumPredictions, 20000 / 2);
+
+	Prediction.Reset();
+	EXPECT_EQ(Prediction.StopDistance(VelocityX + 0.1f, VelocityY, false, 0, GroundFriction, 2, BrakingDeceleration),
+		LLLocomotionMath::PredictGroundMovementStopDistance(VelocityX + 0.1f, VelocityY, false, 0, GroundFriction, 2, BrakingDeceleration));
+}
+
+TEST(LLGroundMovementPrediction, MemoizedPivotDistance)
+{
+	using LLLocomotionMath::PredictionVelocityTolerance;
+
+	std::mt19937 Random(4);
+	std::uniform_real_distribution<float> Drift(-0.3f, 0.3f);
+	std::uniform_real_distribution<float> VelocityJumps(-600.0f, 600.0f);
+	std::uniform_real_distribution<float> AccelerationJumps(-2400.0f, 2400.0f);
+	std::bernoulli_distribution ShouldJump(0.05);
+	std::uniform_real_distribution<float> Frictions(0.0f, 12.0f);
+	std::bernoulli_distribution ShouldChangeFriction(0.02);
+
+	LLLocomotionMath::FLLGroundMovementPrediction Prediction;
+	float Inputs[4] = { -2400.0f, 0.0f, 500.0f, 50.0f };
+	float GroundFriction = 8.0f;
+
+	bool bHasAnchor = false;
+	float Anchor[4] = {};
+	float AnchorFriction = 0;
+
+	for (int32_t Query = 0; Query < 20000; ++Query)
+	{
+		const bool bJump = ShouldJump(Random);
+		for (int32_t Input = 0; Input < 4; ++Input)
+		{
+			Inputs[Input] = bJump ? (Input < 2 ? AccelerationJumps(Random) : VelocityJumps(Random)) : Inputs[Input] + Drift(Random);
+		}
+		if (ShouldChangeFriction(Random))
+		{
+			GroundFriction = Frictions(Random);
+		}
+
+		bool bReuse = bHasAnchor && GroundFriction == AnchorFriction;
+		for (int32_t Input = 0; Input < 4; ++Input)
+		{
+			bReuse = bReuse && std::fabs(Inputs[Input] - Anchor[Input]) <= PredictionVelocityTolerance;
+		}
+		if (!bReuse)
+		{
+			bHasAnchor = true;
+			std::copy(Inputs, Inputs + 4, Anchor);
+			AnchorFriction = GroundFriction;
+		}
+
+		const float Memoized = Prediction.PivotDistance(Inputs[0], Inputs[1], Inputs[2], Inputs[3], GroundFriction);
+		const float AtAnchor = LLLocomotionMath::PredictGroundMovementPivotDistance(Anchor[0], Anchor[1], Anchor[2], Anchor[3], AnchorFriction);
+		ASSERT_EQ(Memoized, AtAnchor) << "Query " << Query;
+	}
+}
@@ -0,0 +1,191 @@
+// Copyright 2024 jeonghun
+
+#include "LLLocomotionMath.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	// Lyra defaults of ULLLocomotionSettings and UCharacterMovementComponent
+	constexpr float LatencyTolerance = 0.2f;
+	constexpr float ApexTimeThreshold = 0.2f;
+	constexpr float TimeToGroundRatio = 0.25f;
+	constexpr float GravityZ = -980.0f;
+
+	struct FGroundTraceCounters
+	{
+		int32_t AirborneFrames = 0;
+		int32_t AsyncTraces = 0;
+		int32_t SyncTraces = 0;
+		// Anim updates that extrapolated a result older than the tolerance while the trace replacing it was in flight
+		int32_t InFlightExtrapolations = 0;
+	};
+
+	// One character over flat floors, jumping and walking off ledges, with ULLLocomotionSubsystem::UpdateGroundTraces
+	// ahead of the anim update of each frame and ULLAnimInstance::GetGroundDistance falling back to a synchronous trace
+	// whenever GetAsyncGroundDistance has nothing to extrapolate.
+	template <typename DeltaTimeFuncType>
+	FGroundTraceCounters SimulateGroundTraces(double Duration, DeltaTimeFuncType&& NextDeltaTime)
+	{
+		FGroundTraceCounters Counters;
+
+		double FloorZ = 0;
+		double ActorZ = 0;
+		float VerticalSpeed = 0;
+		bool bWalking = true;
+
+		// FLLGroundTraceState
+		bool bPendingTrace = false;
+		float PendingGroundDistance = 0;
+		double PendingTraceZ = 0;
+		double PendingTraceTime = 0;
+		float GroundDistance = 0;
+		double GroundDistanceZ = 0;
+		double GroundDistanceTime = 0;
+
+		double NextEventTime = 1.0;
+		int32_t Event = 0;
+
+		for (double Now = 0; Now < Duration;)
+		{
+			const float DeltaTime = NextDeltaTime();
+			Now += DeltaTime;
+
+			// Character movement, alternating a jump, a high jump and walking off a ledge
+			if (bWalking && Now >= NextEventTime)
+			{
+				switch (Event++ % 3)
+				{
+				case 0:
+					VerticalSpeed = 500.0f;
+					break;
+				case 1:
+					VerticalSpeed = 2000.0f;
+					break;
+				default:
+					FloorZ -= 3000.0;
+					break;
+				}
+				bWalking = false;
+			}
+			if (!bWalking)
+			{
+				VerticalSpeed += GravityZ * DeltaTime;
+				ActorZ += VerticalSpeed * DeltaTime;
+				if (ActorZ <= FloorZ)
+				{
+					ActorZ = FloorZ;
+					VerticalSpeed = 0;
+					bWalking = true;
+					NextEventTime = Now + 1.0;
+				}
+			}
+
+			// UpdateGroundTraces, last frame's async trace arrives stamped with the time it was issued at
+			if (bPendingTrace)
+			{
+				GroundDistance = PendingGroundDistance;
+				GroundDistanceZ = PendingTraceZ;
+				GroundDistanceTime = PendingTraceTime;
+				bPendingTrace = false;
+			}
+
+			if (bWalking)
+			{
+				GroundDistance = 0;
+				GroundDistanceZ = ActorZ;
+				GroundDistanceTime = Now;
+				continue;
+			}
+
+			++Counters.AirborneFrames;
+			const float Extrapolated = std::max(GroundDistance + static_cast<float>(ActorZ - GroundDistanceZ), 0.0f);
+			const float TraceInterval = LLLocomotionMath::GroundTraceInterval(
+				VerticalSpeed, GravityZ, Extrapolated, DeltaTime, LatencyTolerance, ApexTimeThreshold, TimeToGroundRatio);
+			if (Now - GroundDistanceTime >= TraceInterval)
+			{
+				++Counters.AsyncTraces;
+				bPendingTrace = true;
+				PendingGroundDistance = static_cast<float>(ActorZ - FloorZ);
+				PendingTraceZ = ActorZ;
+				PendingTraceTime = Now;
+			}
+
+			// GetAsyncGroundDistance, then the synchronous trace of GetGroundDistance
+			const bool bTraceInFlight = bPendingTrace && Now - PendingTraceTime <= LatencyTolerance;
+			if (Now - GroundDistanceTime <= LatencyTolerance)
+			{
+				continue;
+			}
+			if (bTraceInFlight)
+			{
+				++Counters.InFlightExtrapolations;
+				continue;
+			}
+
+			++Counters.SyncTraces;
+			GroundDistance = static_cast<float>(ActorZ - FloorZ);
+			GroundDistanceZ = ActorZ;
+			GroundDistanceTime = Now;
+		}
+
+		return Counters;
+	}
+}
+
+// At a steady frame rate the interval alone keeps every extrapolated distance within the tolerance,
+// so the anim update of a full fidelity airborne character never traces on the game thread.
+TEST(LLGroundTraceInterval, SteadyFrameRateNeverTracesSynchronously)
+{
+	for (const float DeltaTime : { 1.0f / 30.0f, 1.0f / 60.0f, 1.0f / 144.0f })
+	{
+		const FGroundTraceCounters Counters = SimulateGroundTraces(60.0, [DeltaTime] { return DeltaTime; });
+
+		EXPECT_GT(Counters.AirborneFrames, 0);
+		EXPECT_EQ(Counters.SyncTraces, 0) << "DeltaTime " << DeltaTime;
+		EXPECT_EQ(Counters.InFlightExtrapolations, 0) << "DeltaTime " << DeltaTime;
+		// Long falls and high jumps trace less than every frame
+		EXPECT_LT(Counters.AsyncTraces, Counters.AirborneFrames) << "DeltaTime " << DeltaTime;
+	}
+}
+
+// A frame longer than the one before can age the last result past the tolerance,
+// the trace issued that frame to replace it stands in until it arrives.
+TEST(LLGroundTraceInterval, HitchesNeverTraceSynchronously)
+{
+	std::mt19937 Random(1);
+	std::uniform_real_distribution<float> DeltaTimeDistribution(1.0f / 144.0f, 1.0f / 15.0f);
+	std::bernoulli_distribution Hitch(0.02);
+
+	const FGroundTraceCounters Counters = SimulateGroundTraces(300.0, [&]
+	{
+		return Hitch(Random) ? 0.15f : DeltaTimeDistribution(Random);
+	});
+
+	EXPECT_GT(Counters.AirborneFrames, 0);
+	EXPECT_EQ(Counters.SyncTraces, 0);
+	EXPECT_LT(Counters.AsyncTraces, Counters.AirborneFrames);
+}
+
+// Never waits past the tolerance less the frame the trace takes to arrive
+TEST(LLGroundTraceInterval, IntervalStaysWithinTolerance)
+{
+	for (const float DeltaTime : { 0.0f, 1.0f / 60.0f, 0.1f, 0.5f })
+	{
+		for (const float VerticalSpeed : { 2000.0f, 100.0f, 0.0f, -100.0f, -3000.0f })
+		{
+			for (const float Extrapolated : { 0.0f, 50.0f, 100000.0f })
+			{
+				const float Interval = LLLocomotionMath::GroundTraceInterval(
+					VerticalSpeed, GravityZ, Extrapolated, DeltaTime, LatencyTolerance, ApexTimeThreshold, TimeToGroundRatio);
+				EXPECT_GE(Interval, 0.0f);
+				EXPECT_LE(Interval, std::max(LatencyTolerance - DeltaTime, 0.0f));
+			}
+		}
+	}
+
+	// Close to the apex and close to the ground trace every frame
+	EXPECT_EQ(LLLocomotionMath::GroundTraceInterval(100.0f, GravityZ, 500.0f, 0.016f, LatencyTolerance, ApexTimeThreshold, TimeToGroundRatio), 0.0f);
+	EXPECT_EQ(LLLocomotionMath::GroundTraceInterval(-1000.0f, GravityZ, 0.0f, 0.016f, LatencyTolerance, ApexTimeThreshold, TimeToGroundRatio), 0.0f);
+}
@@ -0,0 +1,148 @@
+// Copyright 2024 jeonghun
+
+#include "LLLocomotionMath.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	enum class ECardinalDirection : uint8_t
+	{
+		Forward,
+		Backward,
+		Left,
+		Right,
+	};
+
+	enum class ERootYawOffsetMode : uint8_t
+	{
+		BlendOut,
+		Hold,
+		Accumulate,
+	};
+
+	using FKinematics = LLLocomotionMath::TLLKinematics<ECardinalDirection, ERootYawOffsetMode>;
+
+	constexpr float Speed = 400.0f;
+	constexpr float YawSpeed = 90.0f;
+
+	struct FAnimUpdateTotals
+	{
+		int32_t Frames = 0;
+		int32_t Updates = 0;
+		double Travelled = 0;
+		double Displacement = 0;
+		float MaxSpeedError = 0;
+		float MaxLeanError = 0;
+	};
+
+	// Lean from the yaw speed of the character, to the float precision of its yaw
+	constexpr float LeanTolerance = YawSpeed * LLLocomotionMath::LeanAnglePerYawSpeed * 1e-3f;
+
+	// A character running and turning at constant speeds, whose mesh updates on the frames ShouldUpdate picks with the
+	// delta time accumulated since its last update, as ULLLocomotionSubsystem::UpdateRates hands it to the mesh.
+	// With bComputeEveryFrame the kinematics batch computes every frame instead, as UpdateEveryFrame does, which is what a
+	// mesh skipping frames on its own (update rate optimizations) would read.
+	template <typename DeltaTimeFuncType, typename ShouldUpdateFuncType>
+	FAnimUpdateTotals SimulateAnimUpdates(int32_t NumFrames, bool bComputeEveryFrame, DeltaTimeFuncType&& NextDeltaTime, ShouldUpdateFuncType&& ShouldUpdate)
+	{
+		const LLLocomotionMath::FLLKinematicsTuning Tuning;
+		const float ExpectedLean = YawSpeed * LLLocomotionMath::LeanAnglePerYawSpeed;
+
+		FAnimUpdateTotals Totals;
+		FKinematics Kinematics;
+		LLLocomotionMath::FLLKinematicsInputs Inputs;
+
+		double Yaw = 0;
+		float AccumulatedDeltaTime = 0;
+		double TravelledSinceUpdate = 0;
+		for (int32_t Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const float DeltaTime = NextDeltaTime();
+			Yaw += YawSpeed * DeltaTime;
+			Inputs.LocationX += Speed * DeltaTime;
+			Inputs.SetRotation(0, static_cast<float>(Yaw), 0);
+			Inputs.VelocityX = Speed;
+			++Totals.Frames;
+
+			AccumulatedDeltaTime += DeltaTime;
+			TravelledSinceUpdate += Speed * DeltaTime;
+			const bool bUpdate = Frame == 0 || ShouldUpdate(Frame);
+			if (bComputeEveryFrame)
+			{
+				LLLocomotionMath::ComputeKinematics(Inputs, Tuning, DeltaTime, Kinematics);
+			}
+			else if (bUpdate)
+			{
+				LLLocomotionMath::ComputeKinematics(Inputs, Tuning, AccumulatedDeltaTime, Kinematics);
+			}
+			if (!bUpdate)
+			{
+				continue;
+			}
+
+			// The anim update, past the first one which has nothing to compare with
+			if (Frame > 0)
+			{
+				++Totals.Updates;
+				Totals.Travelled += TravelledSinceUpdate;
+				Totals.Displacement += Kinematics.DisplacementSinceLastUpdate;
+				const float AnimSpeed = Kinematics.DisplacementSinceLastUpdate / AccumulatedDeltaTime;
+				Totals.MaxSpeedError = std::fmax(Totals.MaxSpeedError, std::fabs(AnimSpeed - Speed));
+				Totals.MaxSpeedError = std::fmax(Totals.MaxSpeedError, std::fabs(Kinematics.DisplacementSpeed - Speed));
+				const float AnimLean = Kinematics.YawDeltaSinceLastUpdate / AccumulatedDeltaTime * LLLocomotionMath::LeanAnglePerYawSpeed;
+				Totals.MaxLeanError = std::fmax(Totals.MaxLeanError, std::fabs(AnimLean - ExpectedLean));
+			}
+			AccumulatedDeltaTime = 0;
+			TravelledSinceUpdate = 0;
+		}
+		return Totals;
+	}
+}
+
+// Meshes updating every N frames get displacements and yaw deltas over all the frames since their last update
+TEST(LLKinematicsUpdateRate, SkippedFramesAddUpToTheAnimUpdate)
+{
+	for (const int32_t FramesPerUpdate : { 1, 2, 3, 4, 16 })
+	{
+		const FAnimUpdateTotals Totals = SimulateAnimUpdates(960, false,
+			[] { return 1.0f / 60.0f; },
+			[FramesPerUpdate](int32_t Frame) { return Frame % FramesPerUpdate == 0; });
+
+		EXPECT_EQ(Totals.Updates, (Totals.Frames - 1) / FramesPerUpdate) << "FramesPerUpdate " << FramesPerUpdate;
+		EXPECT_NEAR(Totals.Displacement, Totals.Travelled, Totals.Travelled * 1e-4) << "FramesPerUpdate " << FramesPerUpdate;
+		EXPECT_LT(Totals.MaxSpeedError, Speed * 1e-3f) << "FramesPerUpdate " << FramesPerUpdate;
+		EXPECT_LT(Totals.MaxLeanError, LeanTolerance) << "FramesPerUpdate " << FramesPerUpdate;
+	}
+}
+
+// Frames skipped at random, with varying frame times, still add up
+TEST(LLKinematicsUpdateRate, IrregularSkipsAddUpToTheAnimUpdate)
+{
+	std::mt19937 Random(1);
+	std::uniform_real_distribution<float> DeltaTimeDistribution(1.0f / 144.0f, 1.0f / 20.0f);
+	std::bernoulli_distribution Skip(0.6);
+
+	const FAnimUpdateTotals Totals = SimulateAnimUpdates(4000, false,
+		[&] { return DeltaTimeDistribution(Random); },
+		[&](int32_t) { return !Skip(Random); });
+
+	EXPECT_GT(Totals.Updates, 0);
+	EXPECT_LT(Totals.Updates, Totals.Frames / 2);
+	EXPECT_NEAR(Totals.Displacement, Totals.Travelled, Totals.Travelled * 1e-4);
+	EXPECT_LT(Totals.MaxSpeedError, Speed * 1e-3f);
+	EXPECT_LT(Totals.MaxLeanError, LeanTolerance);
+}
+
+// Why ULLLocomotionSubsystem turns update rate optimizations off on its meshes: a batch computing every frame under a mesh
+// that skips frames hands each anim update one frame of displacement for the delta time of all of them.
+TEST(LLKinematicsUpdateRate, EveryFrameBatchLosesSkippedFrames)
+{
+	const FAnimUpdateTotals Totals = SimulateAnimUpdates(960, true,
+		[] { return 1.0f / 60.0f; },
+		[](int32_t Frame) { return Frame % 4 == 0; });
+
+	EXPECT_NEAR(Totals.Displacement, Totals.Travelled / 4, Totals.Travelled * 1e-4);
+	EXPECT_GT(Totals.MaxSpeedError, Speed * 0.5f);
+}
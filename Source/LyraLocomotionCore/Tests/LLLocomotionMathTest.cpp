@@ -0,0 +1,419 @@
+// Copyright 2024 jeonghun
+
+#include "LLLocomotionMath.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	enum class ECardinalDirection : uint8_t
+	{
+		Forward,
+		Backward,
+		Left,
+		Right
+	};
+
+	constexpr ECardinalDirection CardinalDirections[] =
+	{
+		ECardinalDirection::Forward, ECardinalDirection::Backward, ECardinalDirection::Left, ECardinalDirection::Right
+	};
+
+	// ULLAnimInstance::SelectCardinalDirectionFromAngle before it moved onto the direction tables
+	ECardinalDirection ReferenceSelectCardinalDirection(float Angle, float DeadZone, ECardinalDirection CurrentDirection, bool bUseCurrentDirection)
+	{
+		const float AbsAngle = std::fabs(Angle);
+		float FwdDeadZone = DeadZone;
+		float BwdDeadZone = DeadZone;
+
+		if (bUseCurrentDirection)
+		{
+			switch (CurrentDirection)
+			{
+			case ECardinalDirection::Forward:
+				FwdDeadZone *= 2;
+				break;
+			case ECardinalDirection::Backward:
+				BwdDeadZone *= 2;
+				break;
+			default:
+				break;
+			}
+		}
+
+		if (AbsAngle <= FwdDeadZone + 45)
+		{
+			return ECardinalDirection::Forward;
+		}
+		if (AbsAngle >= 135 - BwdDeadZone)
+		{
+			return ECardinalDirection::Backward;
+		}
+		return Angle > 0 ? ECardinalDirection::Right : ECardinalDirection::Left;
+	}
+
+	struct FReferenceSpringState
+	{
+		double Velocity = 0;
+		double PrevTarget = 0;
+		bool bPrevTargetValid = false;
+	};
+
+	// UKismetMathLibrary::FloatSpringInterp without clamping. FMath::SpringDamper steps implicitly, the next position
+	// and velocity solve x' = x + dt v' and v' = v + dt (w^2 (target - x') + 2 zeta w (target velocity - v')),
+	// written here as the 2x2 system solved by Cramer's rule.
+	double ReferenceFloatSpringInterp(double Current, double Target, FReferenceSpringState& State, double Stiffness,
+		double CriticalDampingFactor, double DeltaTime, double Mass, double TargetVelocityAmount)
+	{
+		if (DeltaTime <= 1.e-8 || Mass <= 0)
+		{
+			return Current;
+		}
+
+		const double TargetVelocity = State.bPrevTargetValid ? (Target - State.PrevTarget) / DeltaTime * TargetVelocityAmount : 0;
+		State.PrevTarget = Target;
+		State.bPrevTargetValid = true;
+
+		const double Pi = 3.14159265358979323846;
+		const double UndampedFrequency = std::sqrt(Stiffness / Mass) / (2 * Pi);
+		const double Omega = 2 * Pi * UndampedFrequency;
+		const double ZetaOmega = CriticalDampingFactor * Omega;
+		const double OmegaSquared = Omega * Omega;
+		const double DeltaTimeSquared = DeltaTime * DeltaTime;
+
+		const double Det = 1 + 2 * DeltaTime * ZetaOmega + OmegaSquared * DeltaTimeSquared;
+		const double DetX = (1 + 2 * DeltaTime * ZetaOmega) * Current + DeltaTime * State.Velocity +
+			DeltaTimeSquared * (OmegaSquared * Target + 2 * ZetaOmega * TargetVelocity);
+		const double DetV = State.Velocity + DeltaTime * (OmegaSquared * (Target - Current) + 2 * ZetaOmega * TargetVelocity);
+
+		State.Velocity = DetV / Det;
+		return DetX / Det;
+	}
+
+	// UAnimCharacterMovementLibrary::PredictGroundMovementStopLocation as vector math
+	double ReferenceStopDistance(double VelocityX, double VelocityY,
+		bool bUseSeparateBrakingFriction, double BrakingFriction, double GroundFriction, double BrakingFrictionFactor, double BrakingDecelerationWalking)
+	{
+		const double ActualBrakingFriction = std::fmax(0.0, (bUseSeparateBrakingFriction ? BrakingFriction : GroundFriction) * BrakingFrictionFactor);
+		const double BrakingDeceleration = std::fmax(0.0, BrakingDecelerationWalking);
+
+		const double Speed2D = std::hypot(VelocityX, VelocityY);
+		const double DirectionX = Speed2D > 1.e-8 ? VelocityX / Speed2D : 0;
+		const double DirectionY = Speed2D > 1.e-8 ? VelocityY / Speed2D : 0;
+
+		const double Divisor = ActualBrakingFriction * Speed2D + BrakingDeceleration;
+		if (Divisor <= 0)
+		{
+			return 0;
+		}
+
+		const double TimeToStop = Speed2D / Divisor;
+		const double HalfTimeSquared = 0.5 * TimeToStop * TimeToStop;
+		const double StopX = VelocityX * TimeToStop + (-ActualBrakingFriction * VelocityX - BrakingDeceleration * DirectionX) * HalfTimeSquared;
+		const double StopY = VelocityY * TimeToStop + (-ActualBrakingFriction * VelocityY - BrakingDeceleration * DirectionY) * HalfTimeSquared;
+		return std::hypot(StopX, StopY);
+	}
+
+	// UAnimCharacterMovementLibrary::PredictGroundMovementPivotLocation as vector math
+	double ReferencePivotDistance(double AccelerationX, double AccelerationY, double VelocityX, double VelocityY, double GroundFriction)
+	{
+		const double AccelerationSize2D = std::hypot(AccelerationX, AccelerationY);
+		const double DirectionX = AccelerationSize2D > 1.e-8 ? AccelerationX / AccelerationSize2D : 0;
+		const double DirectionY = AccelerationSize2D > 1.e-8 ? AccelerationY / AccelerationSize2D : 0;
+
+		const double VelocityAlongAcceleration = VelocityX * DirectionX + VelocityY * DirectionY;
+		if (VelocityAlongAcceleration >= 0)
+		{
+			return 0;
+		}
+
+		const double SpeedAlongAcceleration = -VelocityAlongAcceleration;
+		const double TimeToDirectionChange = SpeedAlongAcceleration / (AccelerationSize2D + 2 * SpeedAlongAcceleration * GroundFriction);
+
+		const double Speed2D = std::hypot(VelocityX, VelocityY);
+		const double ForceX = AccelerationX - (VelocityX - DirectionX * Speed2D) * GroundFriction;
+		const double ForceY = AccelerationY - (VelocityY - DirectionY * Speed2D) * GroundFriction;
+
+		const double HalfTimeSquared = 0.5 * TimeToDirectionChange * TimeToDirectionChange;
+		return std::hypot(VelocityX * TimeToDirectionChange + ForceX * HalfTimeSquared, VelocityY * TimeToDirectionChange + ForceY * HalfTimeSquared);
+	}
+}
+
+TEST(LLLocomotionMath, CardinalDirectionMatchesBranchyReference)
+{
+	for (const float DeadZone : { 0.0f, 5.0f, 10.0f, 14.0f })
+	{
+		for (const ECardinalDirection Current : CardinalDirections)
+		{
+			for (const bool bUseCurrentDirection : { false, true })
+			{
+				// Quarter degree steps offset by an eighth never land on an edge, where the two only differ in rounding
+				for (float Angle = -179.875f; Angle < 180.0f; Angle += 0.25f)
+				{
+					EXPECT_EQ(LLLocomotionMath::SelectCardinalDirectionFromAngle(Angle, DeadZone, Current, bUseCurrentDirection),
+						ReferenceSelectCardinalDirection(Angle, DeadZone, Current, bUseCurrentDirection))
+						<< "Angle " << Angle << " dead zone " << DeadZone << " current " << int(Current) << " use current " << bUseCurrentDirection;
+				}
+			}
+		}
+	}
+}
+
+TEST(LLLocomotionMath, CardinalDirectionHysteresis)
+{
+	using LLLocomotionMath::SelectCardinalDirectionFromAngle;
+
+	// Forward reaches 45 + dead zone, twice the dead zone while already forward
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(56.0f, 10.0f, ECardinalDirection::Forward, false), ECardinalDirection::Right);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(56.0f, 10.0f, ECardinalDirection::Forward, true), ECardinalDirection::Forward);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(56.0f, 10.0f, ECardinalDirection::Right, true), ECardinalDirection::Right);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(-64.0f, 10.0f, ECardinalDirection::Forward, true), ECardinalDirection::Forward);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(-66.0f, 10.0f, ECardinalDirection::Forward, true), ECardinalDirection::Left);
+
+	// Backward reaches 135 - dead zone, twice the dead zone while already backward
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(130.0f, 10.0f, ECardinalDirection::Right, true), ECardinalDirection::Backward);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(120.0f, 10.0f, ECardinalDirection::Right, true), ECardinalDirection::Right);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(120.0f, 10.0f, ECardinalDirection::Backward, true), ECardinalDirection::Backward);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(-120.0f, 10.0f, ECardinalDirection::Backward, false), ECardinalDirection::Left);
+	EXPECT_EQ(SelectCardinalDirectionFromAngle(180.0f, 10.0f, ECardinalDirection::Forward, true), ECardinalDirection::Backward);
+
+	// Sweeping back and forth only switches once past the widened edge
+	ECardinalDirection Direction = ECardinalDirection::Forward;
+	for (float Angle = 0; Angle <= 64.0f; Angle += 1.0f)
+	{
+		Direction = SelectCardinalDirectionFromAngle(Angle, 10.0f, Direction, true);
+		EXPECT_EQ(Direction, ECardinalDirection::Forward) << "Angle " << Angle;
+	}
+	Direction = SelectCardinalDirectionFromAngle(66.0f, 10.0f, Direction, true);
+	EXPECT_EQ(Direction, ECardinalDirection::Right);
+	for (float Angle = 66.0f; Angle >= 56.0f; Angle -= 1.0f)
+	{
+		Direction = SelectCardinalDirectionFromAngle(Angle, 10.0f, Direction, true);
+		EXPECT_EQ(Direction, ECardinalDirection::Right) << "Angle " << Angle;
+	}
+}
+
+TEST(LLLocomotionMath, OppositeCardinalDirection)
+{
+	using LLLocomotionMath::GetOppositeCardinalDirection;
+
+	EXPECT_EQ(GetOppositeCardinalDirection(ECardinalDirection::Forward), ECardinalDirection::Backward);
+	EXPECT_EQ(GetOppositeCardinalDirection(ECardinalDirection::Backward), ECardinalDirection::Forward);
+	EXPECT_EQ(GetOppositeCardinalDirection(ECardinalDirection::Left), ECardinalDirection::Right);
+	EXPECT_EQ(GetOppositeCardinalDirection(ECardinalDirection::Right), ECardinalDirection::Left);
+}
+
+TEST(LLLocomotionMath, ClampRootYawOffset)
+{
+	using LLLocomotionMath::ClampRootYawOffset;
+
+	// Inside the clamp, after normalizing
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(30.0f, -120.0f, 100.0f), 30.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(400.0f, -120.0f, 100.0f), 40.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(-390.0f, -120.0f, 100.0f), -30.0f);
+
+	// Outside, to the nearer end around the circle
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(-150.0f, -120.0f, 100.0f), -120.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(150.0f, -120.0f, 100.0f), 100.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(169.0f, -120.0f, 100.0f), 100.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(-171.0f, -120.0f, 100.0f), -120.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(500.0f, -120.0f, 100.0f), 100.0f);
+
+	// Equal ends turn the clamp off
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(170.0f, 0.0f, 0.0f), 170.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(190.0f, 0.0f, 0.0f), -170.0f);
+	EXPECT_FLOAT_EQ(ClampRootYawOffset(180.0f, 0.0f, 0.0f), 180.0f);
+
+	for (float Offset = -720.0f; Offset <= 720.0f; Offset += 7.5f)
+	{
+		const float Clamped = ClampRootYawOffset(Offset, -120.0f, 100.0f);
+		EXPECT_GE(Clamped, -120.0f) << "Offset " << Offset;
+		EXPECT_LE(Clamped, 100.0f) << "Offset " << Offset;
+	}
+}
+
+TEST(LLLocomotionMath, SpringMatchesFloatSpringInterp)
+{
+	struct FCase
+	{
+		float Start;
+		float Target;
+		float Stiffness;
+		float CriticalDampingFactor;
+		float Mass;
+		float TargetVelocityAmount;
+	};
+
+	const FCase Cases[] =
+	{
+		{ 90.0f, 0.0f, 80.0f, 1.0f, 1.0f, 0.5f },
+		{ -120.0f, 0.0f, 80.0f, 1.0f, 1.0f, 0.5f },
+		{ 10.0f, 50.0f, 200.0f, 0.3f, 2.0f, 1.0f },
+		{ 0.0f, -30.0f, 20.0f, 2.0f, 0.5f, 0.0f },
+	};
+
+	std::mt19937 Random(1);
+	std::uniform_real_distribution<float> DeltaTimes(1.0f / 240.0f, 1.0f / 10.0f);
+	std::uniform_real_distribution<float> TargetSteps(-2.0f, 2.0f);
+
+	for (const FCase& Case : Cases)
+	{
+		LLLocomotionMath::FLLSpringState State;
+		FReferenceSpringState ReferenceState;
+		float Value = Case.Start;
+		double ReferenceValue = Case.Start;
+		float Target = Case.Target;
+
+		for (int32_t Step = 0; Step < 300; ++Step)
+		{
+			const float DeltaTime = DeltaTimes(Random);
+			Target += TargetSteps(Random);
+
+			Value = LLLocomotionMath::SpringInterp(Value, Target, State, Case.Stiffness, Case.CriticalDampingFactor, DeltaTime, Case.Mass, Case.TargetVelocityAmount);
+			ReferenceValue = ReferenceFloatSpringInterp(ReferenceValue, Target, ReferenceState, Case.Stiffness, Case.CriticalDampingFactor, DeltaTime, Case.Mass, Case.TargetVelocityAmount);
+
+			ASSERT_NEAR(Value, ReferenceValue, 1.e-3 * (1.0 + std::fabs(ReferenceValue))) << "Step " << Step;
+			ASSERT_NEAR(State.Velocity, ReferenceState.Velocity, 1.e-2 * (1.0 + std::fabs(ReferenceState.Velocity))) << "Step " << Step;
+		}
+	}
+}
+
+TEST(LLLocomotionMath, BlendOutRootYawOffsetGoldenValues)
+{
+	// FloatSpringInterp(Offset, 0, State, 80, 1, 1 / 60, 1, 0.5) from 90 degrees
+	const float Expected[] = { 88.4853f, 85.8488f, 82.4072f, 78.4137f, 74.0694f, 69.5326f, 64.9263f, 60.3449f, 55.8594f, 51.5222f };
+
+	LLLocomotionMath::FLLSpringState State;
+	float Offset = 90.0f;
+	for (const float ExpectedOffset : Expected)
+	{
+		Offset = LLLocomotionMath::BlendOutRootYawOffset(Offset, State, 1.0f / 60.0f);
+		EXPECT_NEAR(Offset, ExpectedOffset, 1.e-3f);
+	}
+}
+
+TEST(LLLocomotionMath, BlendOutRootYawOffsetSettlesWithoutOvershoot)
+{
+	for (const float DeltaTime : { 1.0f / 120.0f, 1.0f / 30.0f, 0.25f, 1.0f })
+	{
+		LLLocomotionMath::FLLSpringState State;
+		float Offset = 100.0f;
+		for (int32_t Step = 0; Step < 600; ++Step)
+		{
+			const float NextOffset = LLLocomotionMath::BlendOutRootYawOffset(Offset, State, DeltaTime);
+			ASSERT_GE(NextOffset, 0.0f) << "Delta time " << DeltaTime << " step " << Step;
+			ASSERT_LE(NextOffset, Offset) << "Delta time " << DeltaTime << " step " << Step;
+			Offset = NextOffset;
+		}
+		EXPECT_NEAR(Offset, 0.0f, 0.1f) << "Delta time " << DeltaTime;
+	}
+
+	// No time passed, no change
+	LLLocomotionMath::FLLSpringState State;
+	EXPECT_FLOAT_EQ(LLLocomotionMath::BlendOutRootYawOffset(45.0f, State, 0.0f), 45.0f);
+}
+
+TEST(LLLocomotionMath, LoopingTimeDistance)
+{
+	using LLLocomotionMath::LoopingTimeDistance;
+
+	EXPECT_FLOAT_EQ(LoopingTimeDistance(0.2f, 0.5f, 1.0f), 0.3f);
+	EXPECT_FLOAT_EQ(LoopingTimeDistance(0.5f, 0.2f, 1.0f), 0.3f);
+
+	// Around the end of the loop
+	EXPECT_NEAR(LoopingTimeDistance(0.95f, 0.02f, 1.0f), 0.07f, 1.e-6f);
+	EXPECT_NEAR(LoopingTimeDistance(0.02f, 0.95f, 1.0f), 0.07f, 1.e-6f);
+	EXPECT_NEAR(LoopingTimeDistance(0.1f, 2.15f, 1.0f), 0.05f, 1.e-5f);
+
+	// Never more than half a loop apart
+	for (float Time = 0; Time < 1.2f; Time += 0.01f)
+	{
+		EXPECT_LE(LoopingTimeDistance(0.0f, Time, 1.2f), 0.6f + 1.e-6f);
+	}
+
+	// Without a length there's no loop to wrap around
+	EXPECT_FLOAT_EQ(LoopingTimeDistance(0.2f, 3.2f, 0.0f), 3.0f);
+}
+
+TEST(LLLocomotionMath, IdleBreakDelayTime)
+{
+	std::mt19937 Random(2);
+	std::uniform_real_distribution<double> Locations(-2.0e6, 2.0e6);
+
+	for (int32_t Sample = 0; Sample < 10000; ++Sample)
+	{
+		const double X = Locations(Random);
+		const double Y = Locations(Random);
+
+		// FMath::TruncToInt(FMath::Abs(WorldLocation.X + WorldLocation.Y)) % 10 + 6
+		const float Expected = static_cast<float>(static_cast<int64_t>(std::trunc(std::fabs(X + Y))) % 10 + 6);
+		const float Delay = LLLocomotionMath::IdleBreakDelayTime(X, Y);
+		ASSERT_EQ(Delay, Expected) << "Location " << X << ", " << Y;
+		ASSERT_GE(Delay, 6.0f);
+		ASSERT_LE(Delay, 15.0f);
+	}
+
+	EXPECT_EQ(LLLocomotionMath::IdleBreakDelayTime(0, 0), 6.0f);
+	EXPECT_EQ(LLLocomotionMath::IdleBreakDelayTime(12.9, 0), 8.0f);
+	EXPECT_EQ(LLLocomotionMath::IdleBreakDelayTime(-12.9, 0), 8.0f);
+	EXPECT_EQ(LLLocomotionMath::IdleBreakDelayTime(100.5, -91.0), 15.0f);
+}
+
+TEST(LLLocomotionMath, StopDistanceMatchesEnginePrediction)
+{
+	std::mt19937 Random(3);
+	std::uniform_real_distribution<float> Velocities(-800.0f, 800.0f);
+	std::uniform_real_distribution<float> Frictions(0.0f, 12.0f);
+	std::uniform_real_distribution<float> Decelerations(-100.0f, 4096.0f);
+
+	for (int32_t Sample = 0; Sample < 10000; ++Sample)
+	{
+		const float VelocityX = Velocities(Random);
+		const float VelocityY = Velocities(Random);
+		const bool bUseSeparateBrakingFriction = Sample % 2 == 0;
+		const float BrakingFriction = Frictions(Random);
+		const float GroundFriction = Frictions(Random);
+		const float BrakingFrictionFactor = Sample % 3 == 0 ? 1.0f : 2.0f;
+		const float BrakingDeceleration = Decelerations(Random);
+
+		const double Expected = ReferenceStopDistance(VelocityX, VelocityY,
+			bUseSeparateBrakingFriction, BrakingFriction, GroundFriction, BrakingFrictionFactor, BrakingDeceleration);
+		const float Distance = LLLocomotionMath::PredictGroundMovementStopDistance(VelocityX, VelocityY,
+			bUseSeparateBrakingFriction, BrakingFriction, GroundFriction, BrakingFrictionFactor, BrakingDeceleration);
+		ASSERT_NEAR(Distance, Expected, 1.e-4 * (1.0 + Expected)) << "Sample " << Sample;
+	}
+
+	// Lyra's walking defaults, 8 ground friction doubled by the braking friction factor and 2048 deceleration
+	EXPECT_NEAR(LLLocomotionMath::PredictGroundMovementStopDistance(600.0f, 0.0f, false, 0.0f, 8.0f, 2.0f, 2048.0f), 15.4533f, 1.e-3f);
+	EXPECT_EQ(LLLocomotionMath::PredictGroundMovementStopDistance(0.0f, 0.0f, false, 0.0f, 8.0f, 2.0f, 2048.0f), 0.0f);
+	EXPECT_EQ(LLLocomotionMath::PredictGroundMovementStopDistance(300.0f, 0.0f, false, 0.0f, 0.0f, 2.0f, 0.0f), 0.0f);
+	EXPECT_EQ(LLLocomotionMath::PredictGroundMovementStopDistance(300.0f, 0.0f, false, 0.0f, 0.0f, 2.0f, -10.0f), 0.0f);
+}
+
+TEST(LLLocomotionMath, PivotDistanceMatchesEnginePrediction)
+{
+	std::mt19937 Random(4);
+	std::uniform_real_distribution<float> Velocities(-800.0f, 800.0f);
+	std::uniform_real_distribution<float> Accelerations(-2400.0f, 2400.0f);
+	std::uniform_real_distribution<float> Frictions(0.0f, 12.0f);
+
+	for (int32_t Sample = 0; Sample < 10000; ++Sample)
+	{
+		const float AccelerationX = Accelerations(Random);
+		const float AccelerationY = Accelerations(Random);
+		const float VelocityX = Velocities(Random);
+		const float VelocityY = Velocities(Random);
+		const float GroundFriction = Frictions(Random);
+
+		const double Expected = ReferencePivotDistance(AccelerationX, AccelerationY, VelocityX, VelocityY, GroundFriction);
+		const float Distance = LLLocomotionMath::PredictGroundMovementPivotDistance(AccelerationX, AccelerationY, VelocityX, VelocityY, GroundFriction);
+		ASSERT_NEAR(Distance, Expected, 1.e-4 * (1.0 + Expected)) << "Sample " << Sample;
+	}
+
+	// Only accelerating against the velocity pivots
+	EXPECT_EQ(LLLocomotionMath::PredictGroundMovementPivotDistance(2400.0f, 0.0f, 600.0f, 0.0f, 8.0f), 0.0f);
+	EXPECT_EQ(LLLocomotionMath::PredictGroundMovementPivotDistance(0.0f, 2400.0f, 600.0f, 0.0f, 8.0f), 0.0f);
+	EXPECT_EQ(LLLocomotionMath::PredictGroundMovementPivotDistance(0.0f, 0.0f, 600.0f, 0.0f, 8.0f), 0.0f);
+	EXPECT_GT(LLLocomotionMath::PredictGroundMovementPivotDistance(-2400.0f, 0.0f, 600.0f, 0.0f, 8.0f), 0.0f);
+}
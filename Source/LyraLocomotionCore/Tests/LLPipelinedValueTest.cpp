@@ -0,0 +1,169 @@
+// Copyright 2024 jeonghun
+
+#include "LLPipelinedValue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr int32_t NumFields = 32;
+	constexpr int32_t NumCharacters = 16;
+	constexpr int64_t NumFrames = 20000;
+
+	// Stand-in for FLLLocomotionSnapshot, every field derived from the frame that wrote it so a mix of two frames shows
+	struct FStampedSnapshot
+	{
+		int64_t Frame = -1;
+		int64_t Fields[NumFields] = {};
+
+		void Write(int64_t InFrame)
+		{
+			// Field by field like FLLLocomotionSnapshot::Capture, so an unsynchronized reader could catch it half written
+			for (int32_t Field = 0; Field < NumFields; ++Field)
+			{
+				Fields[Field] = InFrame * NumFields + Field;
+			}
+			Frame = InFrame;
+		}
+
+		bool IsConsistent() const
+		{
+			for (int32_t Field = 0; Field < NumFields; ++Field)
+			{
+				if (Fields[Field] != Frame * NumFields + Field)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	struct FCharacter
+	{
+		// ULLCharacterMovementComponent's snapshot and the copy in FLLLocomotionHotState
+		TLLPipelinedValue<FStampedSnapshot> Movement;
+		FStampedSnapshot AnimInstanceCopy;
+	};
+}
+
+// The game thread runs the frames, an anim worker runs the thread safe updates of each frame while the game thread
+// ticks the movement of the same characters, in a random order against their meshes like without the mesh prerequisite.
+TEST(LLPipelinedValue, WorkerReadsPreviousFrameWhileMovementWrites)
+{
+	// Spawned and moved into place the frame before the first one
+	std::vector<FCharacter> Characters(NumCharacters);
+	for (FCharacter& Character : Characters)
+	{
+		Character.Movement.GetPending().Write(-1);
+	}
+
+	std::atomic<int64_t> KickedFrame { -1 };
+	std::atomic<int64_t> CompletedFrame { -1 };
+	std::atomic<int64_t> TornReads { 0 };
+	std::atomic<int64_t> WrongFrameReads { 0 };
+
+	std::thread AnimWorker([&]
+	{
+		for (int64_t Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			while (KickedFrame.load(std::memory_order_acquire) < Frame)
+			{
+				std::this_thread::yield();
+			}
+
+			// Reads the copy a few times over, so the reads spread across the movement writes of the game thread
+			for (int32_t Pass = 0; Pass < 4; ++Pass)
+			{
+				for (const FCharacter& Character : Characters)
+				{
+					const FStampedSnapshot& Snapshot = Character.AnimInstanceCopy;
+					if (!Snapshot.IsConsistent())
+					{
+						TornReads.fetch_add(1, std::memory_order_relaxed);
+					}
+					if (Snapshot.Frame != Frame - 1)
+					{
+						WrongFrameReads.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+			}
+
+			CompletedFrame.store(Frame, std::memory_order_release);
+		}
+	});
+
+	std::mt19937 Random(1);
+	std::bernoulli_distribution MeshTicksFirst(0.5);
+
+	for (int64_t Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		// FWorldDelegates::OnWorldTickStart, last frame's anim tasks completed
+		for (FCharacter& Character : Characters)
+		{
+			Character.Movement.Publish();
+		}
+
+		// Half of the meshes tick before their movement, which then writes the pending snapshot after the worker got kicked
+		std::vector<uint8_t> bMovedBeforeMesh(NumCharacters);
+		for (int32_t Index = 0; Index < NumCharacters; ++Index)
+		{
+			bMovedBeforeMesh[Index] = !MeshTicksFirst(Random);
+			if (bMovedBeforeMesh[Index])
+			{
+				Characters[Index].Movement.GetPending().Write(Frame);
+			}
+		}
+
+		// NativeUpdateAnimation copies the published snapshot on the game thread
+		for (FCharacter& Character : Characters)
+		{
+			Character.AnimInstanceCopy = Character.Movement.GetPublished();
+		}
+		KickedFrame.store(Frame, std::memory_order_release);
+
+		// Movement ticks overlap the worker
+		for (int32_t Index = 0; Index < NumCharacters; ++Index)
+		{
+			if (!bMovedBeforeMesh[Index])
+			{
+				Characters[Index].Movement.GetPending().Write(Frame);
+			}
+		}
+
+		while (CompletedFrame.load(std::memory_order_acquire) < Frame)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	AnimWorker.join();
+
+	EXPECT_EQ(TornReads.load(), 0);
+	EXPECT_EQ(WrongFrameReads.load(), 0);
+}
+
+// Without a new movement update the published snapshot stays what it was instead of going back to an older one
+TEST(LLPipelinedValue, PublishWithoutWriteKeepsLastValue)
+{
+	TLLPipelinedValue<FStampedSnapshot> Movement;
+	EXPECT_EQ(Movement.GetPublished().Frame, -1);
+
+	Movement.GetPending().Write(1);
+	EXPECT_EQ(Movement.GetPublished().Frame, -1);
+
+	Movement.Publish();
+	EXPECT_EQ(Movement.GetPublished().Frame, 1);
+
+	Movement.Publish();
+	Movement.Publish();
+	EXPECT_EQ(Movement.GetPublished().Frame, 1);
+	EXPECT_TRUE(Movement.GetPublished().IsConsistent());
+
+	Movement.GetPending().Write(2);
+	Movement.Publish();
+	EXPECT_EQ(Movement.GetPublished().Frame, 2);
+}
@@ -10,6 +10,6 @@ public class LyraLocomotionEditorTarget : TargetRules
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
-		ExtraModuleNames.Add("LyraLocomotion");
+		ExtraModuleNames.AddRange(new string[] { "LyraLocomotion", "LyraLocomotionEditor" });
 	}
 }
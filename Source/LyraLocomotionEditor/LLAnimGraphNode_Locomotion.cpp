@@ -0,0 +1,66 @@
+// Copyright 2024 jeonghun
+
+
+#include "LLAnimGraphNode_Locomotion.h"
+
+#define LOCTEXT_NAMESPACE "LLAnimGraphNode_Locomotion"
+
+ULLAnimGraphNode_LocomotionSequencePlayer::ULLAnimGraphNode_LocomotionSequencePlayer()
+{
+	// ULLAnimInstance sets them on the node at runtime, which fails on properties the compiler folded into constants
+	AlwaysDynamicProperties.Add(TEXT("Sequence"));
+	AlwaysDynamicProperties.Add(TEXT("PlayRate"));
+}
+
+FText ULLAnimGraphNode_LocomotionSequencePlayer::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return FText::Format(LOCTEXT("SequencePlayerTitle", "Locomotion Sequence Player ({0})"), UEnum::GetDisplayValueAsText(Node.Role));
+}
+
+FText ULLAnimGraphNode_LocomotionSequencePlayer::GetTooltipText() const
+{
+	return LOCTEXT("SequencePlayerTooltip", "Sequence player whose sequence and play rate are selected natively by ULLAnimInstance for its role");
+}
+
+FString ULLAnimGraphNode_LocomotionSequencePlayer::GetNodeCategory() const
+{
+	return TEXT("Lyra Locomotion");
+}
+
+ULLAnimGraphNode_LocomotionSequenceEvaluator::ULLAnimGraphNode_LocomotionSequenceEvaluator()
+{
+	AlwaysDynamicProperties.Add(TEXT("Sequence"));
+	AlwaysDynamicProperties.Add(TEXT("ExplicitTime"));
+}
+
+FText ULLAnimGraphNode_LocomotionSequenceEvaluator::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return FText::Format(LOCTEXT("SequenceEvaluatorTitle", "Locomotion Sequence Evaluator ({0})"), UEnum::GetDisplayValueAsText(Node.Role));
+}
+
+FText ULLAnimGraphNode_LocomotionSequenceEvaluator::GetTooltipText() const
+{
+	return LOCTEXT("SequenceEvaluatorTooltip", "Sequence evaluator whose sequence and time are selected and distance matched natively by ULLAnimInstance for its role");
+}
+
+FString ULLAnimGraphNode_LocomotionSequenceEvaluator::GetNodeCategory() const
+{
+	return TEXT("Lyra Locomotion");
+}
+
+FText ULLAnimGraphNode_SharedLocomotionPose::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return LOCTEXT("SharedPoseTitle", "Shared Locomotion Pose");
+}
+
+FText ULLAnimGraphNode_SharedLocomotionPose::GetTooltipText() const
+{
+	return LOCTEXT("SharedPoseTooltip", "Copies the pose of another character in the same idle or cycle instead of evaluating Source, when pose sharing is enabled");
+}
+
+FString ULLAnimGraphNode_SharedLocomotionPose::GetNodeCategory() const
+{
+	return TEXT("Lyra Locomotion");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,54 @@
+// Copyright 2024 jeonghun
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimGraphNode_Base.h"
+#include "LyraLocomotion/LLAnimNode_Locomotion.h"
+#include "LLAnimGraphNode_Locomotion.generated.h"
+
+UCLASS()
+class LYRALOCOMOTIONEDITOR_API ULLAnimGraphNode_LocomotionSequencePlayer : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FLLAnimNode_LocomotionSequencePlayer Node;
+
+public:
+	ULLAnimGraphNode_LocomotionSequencePlayer();
+
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FString GetNodeCategory() const override;
+};
+
+UCLASS()
+class LYRALOCOMOTIONEDITOR_API ULLAnimGraphNode_LocomotionSequenceEvaluator : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FLLAnimNode_LocomotionSequenceEvaluator Node;
+
+public:
+	ULLAnimGraphNode_LocomotionSequenceEvaluator();
+
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FString GetNodeCategory() const override;
+};
+
+UCLASS()
+class LYRALOCOMOTIONEDITOR_API ULLAnimGraphNode_SharedLocomotionPose : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FLLAnimNode_SharedLocomotionPose Node;
+
+public:
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FString GetNodeCategory() const override;
+};
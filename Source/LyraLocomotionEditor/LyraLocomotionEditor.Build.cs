@@ -0,0 +1,15 @@
+// Copyright 2024 jeonghun
+
+using UnrealBuildTool;
+
+public class LyraLocomotionEditor : ModuleRules
+{
+	public LyraLocomotionEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "AnimGraph", "LyraLocomotion" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "AnimGraphRuntime", "BlueprintGraph", "UnrealEd" });
+	}
+}
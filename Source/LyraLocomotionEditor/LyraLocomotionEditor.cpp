@@ -0,0 +1,5 @@
+// Copyright 2024 jeonghun
+
+#include "Modules/ModuleManager.h"
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, LyraLocomotionEditor);